@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+
+import os, re, sys, struct
+
+ANIMATION_MAGIC: int = 0x4D4E414C
+ANIMATION_VERSION: int = 1
+ANIMATION_EXTENSION: str = '.anm'
+SOURCE_EXTENSION: str = '.cfg'
+# Matches what std::isspace accepts in the default locale.
+WHITESPACE: str = ' \t\n\v\f\r'
+REAL_PATTERN = re.compile(r'[+-]?(\d+\.?\d*|\.\d+)([eE][+-]?\d+)?')
+SINT_PATTERN = re.compile(r'[+-]?\d+')
+
+# Mirrors setup_file_t::parse, returning ('!', title) for titles and (key, value) otherwise.
+def parse_line(line: str) -> tuple:
+	if not line:
+		return ('', '')
+	if line[0] not in '#;[\r\n':
+		index: int = 0
+		while index < len(line) and line[index] in WHITESPACE:
+			index += 1
+		begin: int = index
+		while index < len(line) and line[index] not in WHITESPACE and line[index] != '=':
+			index += 1
+		key: str = line[begin:index]
+		while index < len(line) and (line[index] in WHITESPACE or line[index] == '='):
+			index += 1
+		return (key, line[index:])
+	elif line[0] == '[':
+		index: int = 1
+		while index < len(line) and line[index] not in WHITESPACE and line[index] != ']':
+			index += 1
+		return ('!', line[1:index])
+	return ('', '')
+
+# Mirrors setup_file_t::read, returning a list of (title, keys) chunks.
+def parse_setup(source: str) -> list:
+	chunks: list = []
+	firsts: dict = {}
+	current: int = -1
+	for line in source.split('\n'):
+		key, value = parse_line(line)
+		if not key:
+			continue
+		if key[0] != '!':
+			if current >= 0:
+				chunks[current][1][key] = value
+				first: int = firsts[chunks[current][0]]
+				if first != current:
+					chunks[first][1][key] = value
+		else:
+			current = len(chunks)
+			chunks.append((value, {}))
+			firsts.setdefault(value, current)
+	return chunks
+
+# Like streaming a token into a number: leading whitespace is skipped and a bad token reads as zero.
+def to_real(token: str) -> float:
+	match = REAL_PATTERN.match(token.lstrip(WHITESPACE))
+	return float(match.group(0)) if match else 0.0
+
+def to_sint(token: str) -> int:
+	match = SINT_PATTERN.match(token.lstrip(WHITESPACE))
+	return int(match.group(0)) if match else 0
+
+# Comma separated values are split like std::getline, which never yields an empty final token.
+def split_list(value: str) -> list:
+	tokens: list = value.split(',')
+	if tokens and not tokens[-1]:
+		tokens.pop()
+	return tokens
+
+def get_vector(keys: dict, key: str, default: list) -> list:
+	result: list = list(default)
+	value: str = keys.get(key, '')
+	if value:
+		for index, token in enumerate(split_list(value)[:len(result)]):
+			result[index] = to_real(token)
+	return result
+
+def get_real(keys: dict, key: str, default: float) -> float:
+	value: str = keys.get(key, '')
+	return to_real(value) if value else default
+
+def get_sint(keys: dict, key: str, default: int) -> int:
+	value: str = keys.get(key, '')
+	return to_sint(value) if value else default
+
+class StringTable:
+	def __init__(self):
+		self.offsets: dict = {}
+		self.payload: bytearray = bytearray()
+	def push(self, string: str) -> bytes:
+		encoded: bytes = string.encode('latin-1')
+		if encoded not in self.offsets:
+			self.offsets[encoded] = len(self.payload)
+			self.payload += encoded
+		return struct.pack('<II', self.offsets[encoded], len(encoded))
+
+def cook_animation(source_path: str, cooked_path: str) -> bool:
+	try:
+		with open(source_path, 'rb') as file:
+			chunks: list = parse_setup(file.read().decode('latin-1'))
+	except OSError:
+		print(f'Error! Couldn\'t read \"{source_path}\"!')
+		return False
+	main: dict = next((keys for title, keys in chunks if title == 'Main'), {})
+	materials: list = split_list(main.get('Material', ''))
+	palette: str = main.get('Palettes', '')
+	inverter: list = get_vector(main, 'Inverter', [1.0, 1.0])
+	strings: StringTable = StringTable()
+	records: list = []
+	for title, keys in chunks[1:]:
+		frames: int = get_sint(keys, 'frames', 0)
+		variations: int = get_sint(keys, 'hvtype', 0)
+		if frames < 0 or variations < 0:
+			print(f'Error! Sequence \"{title}\" in \"{source_path}\" has negative counts!')
+			return False
+		record: bytearray = bytearray(struct.pack(
+			'<ffffdIIII',
+			*get_vector(keys, 'starts', [0.0, 0.0]),
+			*get_vector(keys, 'vksize', [0.0, 0.0]),
+			get_real(keys, 'tdelay', 0.0),
+			frames, variations,
+			get_sint(keys, 'repeat', 1) & 0xFFFFFFFF,
+			get_sint(keys, 'reflect', 0) & 0xFFFFFFFF
+		))
+		for variation in range(variations):
+			record += struct.pack('<ff', *get_vector(keys, f'{variation}-X', [0.0, 0.0]))
+			for frame in range(frames):
+				record += struct.pack('<ffff', *get_vector(keys, f'{variation}-{frame}', [0.0, 0.0, 0.0, 0.0]))
+		records.append(bytes(record))
+	material_strings: bytes = b''.join(strings.push(material) for material in materials)
+	palette_string: bytes = strings.push(palette)
+	with open(cooked_path, 'wb') as file:
+		file.write(struct.pack('<IIIIff', ANIMATION_MAGIC, ANIMATION_VERSION, len(records), len(materials), *inverter))
+		file.write(palette_string)
+		file.write(struct.pack('<II', len(strings.payload), 0))
+		file.write(material_strings)
+		for record in records:
+			file.write(record)
+		file.write(strings.payload)
+	return True
+
+def cook_animations(data_path: str, force: bool) -> bool:
+	sprite_path: str = os.path.join(data_path, 'sprite')
+	if not os.path.isdir(sprite_path):
+		print(f'Error! \"{sprite_path}\" isn\'t a directory!')
+		return False
+	count: int = 0
+	for name in sorted(os.listdir(sprite_path)):
+		if not name.endswith(SOURCE_EXTENSION):
+			continue
+		source_path: str = os.path.join(sprite_path, name)
+		cooked_path: str = os.path.splitext(source_path)[0] + ANIMATION_EXTENSION
+		if not force and os.path.isfile(cooked_path) and os.path.getmtime(cooked_path) >= os.path.getmtime(source_path):
+			continue
+		if cook_animation(source_path, cooked_path):
+			count += 1
+	print(f'Cooked {count} animations in \"{data_path}\".')
+	return True
+
+def main():
+	arguments: list = [argument for argument in sys.argv[1:] if argument != '--force']
+	force: bool = len(arguments) != len(sys.argv) - 1
+	if len(arguments) == 1:
+		if not cook_animations(arguments[0], force):
+			print('Error! Animations weren\'t cooked!')
+	else:
+		print('Error! Usage: cook_animations.py [--force] <data directory>')
+
+if __name__ == '__main__':
+	main()
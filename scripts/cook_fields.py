@@ -0,0 +1,259 @@
+#!/usr/bin/env python3
+
+import os, sys, zlib, gzip, base64, struct
+import xml.etree.ElementTree as ElementTree
+
+FIELD_MAGIC: int = 0x444C464C
+FIELD_VERSION: int = 1
+FIELD_EXTENSION: str = '.fld'
+SOURCE_EXTENSION: str = '.tmx'
+# Matches the constants in source/field/field_file.cpp and source/utility/enums.hpp.
+SCREEN_WIDTH: int = 21
+SCREEN_HEIGHT: int = 12
+TILE_SIZE: int = 16
+INVALID_TILES: int = -1
+LAYER_TILE_BACK: float = -1.0
+LAYER_TILE_FRONT: float = 1.0
+DIRECTION_RIGHT: int = 0
+PARALLAX_RECT_X: int = 1 << 0
+PARALLAX_RECT_Y: int = 1 << 1
+PARALLAX_RECT_W: int = 1 << 2
+PARALLAX_RECT_H: int = 1 << 3
+PARALLAX_PROPERTIES: dict = {
+	'rect.x': PARALLAX_RECT_X,
+	'rect.y': PARALLAX_RECT_Y,
+	'rect.w': PARALLAX_RECT_W,
+	'rect.h': PARALLAX_RECT_H
+}
+GID_MASK: int = 0x1FFFFFFF
+HASH_BASIS: int = 0xCBF29CE484222325
+HASH_PRIME: int = 0x00000100000001B3
+
+def hash_name(name: str) -> int:
+	result: int = HASH_BASIS
+	for byte in name.encode('utf-8'):
+		result ^= byte
+		result = (result * HASH_PRIME) & 0xFFFFFFFFFFFFFFFF
+	return result
+
+def path_to_name(path: str) -> str:
+	return os.path.splitext(path.replace('\\', '/').split('/')[-1])[0]
+
+# Properties are (name, type, value) tuples in document order, since tmx_convert::prop_to_stats reads them by position.
+def get_properties(element: ElementTree.Element) -> list:
+	properties: list = []
+	group: ElementTree.Element = element.find('properties')
+	if group is not None:
+		for property in group.findall('property'):
+			value: str = property.get('value')
+			if value is None:
+				value = property.text or ''
+			properties.append((property.get('name', ''), property.get('type', 'string'), value))
+	return properties
+
+def prop_to_bool(property: tuple) -> bool:
+	return property[1] == 'bool' and property[2] == 'true'
+
+def prop_to_sint(property: tuple) -> int:
+	if property[1] == 'int':
+		return int(property[2])
+	elif property[1] == 'string':
+		return int(property[2], 0)
+	return 0
+
+def prop_to_real(property: tuple) -> float:
+	if property[1] == 'float':
+		return float(property[2])
+	elif property[1] == 'string':
+		return float(property[2])
+	return 0.0
+
+def prop_to_string(property: tuple) -> str:
+	return property[2] if property[1] == 'string' else ''
+
+def prop_to_stats(properties: list) -> tuple:
+	if len(properties) >= 5:
+		direction: int = int(properties[0][2]) if properties[0][1] == 'int' else DIRECTION_RIGHT
+		return (
+			direction,
+			prop_to_string(properties[1]),
+			prop_to_sint(properties[2]),
+			prop_to_sint(properties[3]),
+			prop_to_sint(properties[4])
+		)
+	return (DIRECTION_RIGHT, '', 0, 0, 0)
+
+def get_tiles(layer: ElementTree.Element) -> list:
+	data: ElementTree.Element = layer.find('data')
+	if data is None:
+		return []
+	encoding: str = data.get('encoding', '')
+	compression: str = data.get('compression', '')
+	if encoding == 'csv':
+		return [int(gid) & GID_MASK for gid in data.text.replace('\n', '').split(',') if gid.strip()]
+	elif encoding == 'base64':
+		payload: bytes = base64.b64decode(data.text.strip())
+		if compression == 'zlib':
+			payload = zlib.decompress(payload)
+		elif compression == 'gzip':
+			payload = gzip.decompress(payload)
+		elif compression:
+			raise ValueError(f'Unsupported tile compression \"{compression}\"')
+		return [gid & GID_MASK for gid in struct.unpack(f'<{len(payload) // 4}I', payload[:len(payload) // 4 * 4])]
+	return [int(tile.get('gid', '0')) & GID_MASK for tile in data.findall('tile')]
+
+def get_tileset(field: ElementTree.Element, field_directory: str) -> ElementTree.Element:
+	tileset: ElementTree.Element = field.find('tileset')
+	if tileset is not None and tileset.get('source') is not None:
+		return ElementTree.parse(os.path.join(field_directory, tileset.get('source'))).getroot()
+	return tileset
+
+class StringTable:
+	def __init__(self):
+		self.offsets: dict = {}
+		self.payload: bytearray = bytearray()
+	def push(self, string: str) -> bytes:
+		encoded: bytes = string.encode('utf-8')
+		if encoded not in self.offsets:
+			self.offsets[encoded] = len(self.payload)
+			self.payload += encoded
+		return struct.pack('<II', self.offsets[encoded], len(encoded))
+
+def cook_field(source_path: str, cooked_path: str, tilekey_path: str) -> bool:
+	try:
+		field: ElementTree.Element = ElementTree.parse(source_path).getroot()
+		tileset: ElementTree.Element = get_tileset(field, os.path.dirname(source_path))
+	except (OSError, ElementTree.ParseError):
+		print(f'Error! Couldn\'t read \"{source_path}\"!')
+		return False
+	bounds: tuple = (
+		0.0, 0.0,
+		float(int(field.get('width')) * int(field.get('tilewidth'))),
+		float(int(field.get('height')) * int(field.get('tileheight')))
+	)
+	dimensions: tuple = (
+		max(int(bounds[2]) // TILE_SIZE, SCREEN_WIDTH),
+		max(int(bounds[3]) // TILE_SIZE, SCREEN_HEIGHT)
+	)
+	area: int = dimensions[0] * dimensions[1]
+	strings: StringTable = StringTable()
+	attributes: list = [0] * area
+	attribute_key: list = []
+	tileset_name: str = ''
+	palette_name: str = ''
+	if tileset is not None:
+		if any(property[0] == 'indexed' for property in get_properties(tileset)):
+			palette_name = tileset.get('name', '')
+		image: ElementTree.Element = tileset.find('image')
+		tileset_name = path_to_name(image.get('source', '')) if image is not None else ''
+		atr_path: str = os.path.join(tilekey_path, tileset_name + '.atr')
+		if os.path.isfile(atr_path):
+			with open(atr_path, 'rb') as file:
+				payload: bytes = file.read()
+			attribute_key = list(struct.unpack(f'<{len(payload) // 4}i', payload[:len(payload) // 4 * 4]))
+	tile_layers: list = []
+	backgrounds: list = []
+	actors: list = []
+	liquids: list = []
+	for layer in field:
+		if layer.tag == 'layer':
+			if not attribute_key:
+				continue
+			priority: float = LAYER_TILE_BACK
+			colliding: bool = False
+			for property in get_properties(layer):
+				if property[0] == 'collide':
+					colliding = prop_to_bool(property)
+					priority = LAYER_TILE_BACK
+				elif property[0] == 'priority' and prop_to_bool(property):
+					priority = LAYER_TILE_FRONT
+			tiles: list = [(0, 0)] * area
+			for index, gid in enumerate(get_tiles(layer)[:area]):
+				kind: int = gid - 1
+				tiles[index] = (kind % TILE_SIZE, kind // TILE_SIZE) if kind >= 0 else (INVALID_TILES, INVALID_TILES)
+				if colliding and 0 <= kind < len(attribute_key):
+					attributes[index] = attribute_key[kind]
+			tile_layers.append(struct.pack('<fI', priority, area) + b''.join(struct.pack('<ii', *tile) for tile in tiles))
+		elif layer.tag == 'objectgroup':
+			for element in layer.findall('object'):
+				kind: str = element.get('type', element.get('class', ''))
+				x: float = float(element.get('x', '0'))
+				y: float = float(element.get('y', '0'))
+				if kind == 'actor':
+					name: str = element.get('name', '')
+					direction, symbol, flags, identity, deterrent = prop_to_stats(get_properties(element))
+					actors.append(struct.pack(
+						'<Q8s8sffIIiI',
+						hash_name(name), strings.push(name), strings.push(symbol), x, y,
+						direction & 0xFFFFFFFF, flags & 0xFFFFFFFF, identity, deterrent & 0xFFFFFFFF
+					))
+				elif kind == 'water':
+					liquids.append(struct.pack('<ffff', x, y, float(element.get('width', '0')), float(element.get('height', '0'))))
+		elif layer.tag == 'imagelayer':
+			image: ElementTree.Element = layer.find('image')
+			texture: str = path_to_name(image.get('source', '')) if image is not None else ''
+			specified: int = 0
+			rect: list = [0.0, 0.0, 0.0, 0.0]
+			scrolling: list = [0.0, 0.0]
+			for property in get_properties(layer):
+				if property[0] in PARALLAX_PROPERTIES:
+					mask: int = PARALLAX_PROPERTIES[property[0]]
+					rect[mask.bit_length() - 1] = prop_to_real(property)
+					specified |= mask
+				elif property[0] == 'scroll.x':
+					scrolling[0] = prop_to_real(property)
+				elif property[0] == 'scroll.y':
+					scrolling[1] = prop_to_real(property)
+			backgrounds.append(struct.pack('<8sIffffff', strings.push(texture), specified, *rect, *scrolling))
+	tileset_string: bytes = strings.push(tileset_name)
+	palette_string: bytes = strings.push(palette_name)
+	with open(cooked_path, 'wb') as file:
+		file.write(struct.pack(
+			'<II4f2i5I', FIELD_MAGIC, FIELD_VERSION, *bounds, *dimensions,
+			len(tile_layers), len(backgrounds), len(actors), len(liquids), len(strings.payload)
+		))
+		file.write(tileset_string + palette_string)
+		file.write(struct.pack(f'<{area}i', *attributes))
+		for record in tile_layers + backgrounds + actors + liquids:
+			file.write(record)
+		file.write(strings.payload)
+	return True
+
+def cook_fields(data_path: str, force: bool) -> bool:
+	field_path: str = os.path.join(data_path, 'field')
+	tilekey_path: str = os.path.join(data_path, 'tilekey')
+	if not os.path.isdir(field_path):
+		print(f'Error! \"{field_path}\" isn\'t a directory!')
+		return False
+	count: int = 0
+	for name in sorted(os.listdir(field_path)):
+		if not name.endswith(SOURCE_EXTENSION):
+			continue
+		source_path: str = os.path.join(field_path, name)
+		cooked_path: str = os.path.splitext(source_path)[0] + FIELD_EXTENSION
+		# Attribute keys are baked in too, so a newer tilekey also makes the blob stale.
+		newest: float = os.path.getmtime(source_path)
+		if os.path.isdir(tilekey_path):
+			for key in os.listdir(tilekey_path):
+				newest = max(newest, os.path.getmtime(os.path.join(tilekey_path, key)))
+		if not force and os.path.isfile(cooked_path) and os.path.getmtime(cooked_path) >= newest:
+			continue
+		try:
+			if cook_field(source_path, cooked_path, tilekey_path):
+				count += 1
+		except ValueError as error:
+			print(f'Error! Couldn\'t cook \"{source_path}\": {error}!')
+	print(f'Cooked {count} fields in \"{data_path}\".')
+	return True
+
+def main():
+	arguments: list = [argument for argument in sys.argv[1:] if argument != '--force']
+	force: bool = len(arguments) != len(sys.argv) - 1
+	if len(arguments) == 1:
+		if not cook_fields(arguments[0], force):
+			print('Error! Fields weren\'t cooked!')
+	else:
+		print('Error! Usage: cook_fields.py [--force] <data directory>')
+
+if __name__ == '__main__':
+	main()
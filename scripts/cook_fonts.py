@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+
+import os, sys, json, struct
+
+FONT_MAGIC: int = 0x594C474C
+FONT_VERSION: int = 1
+FONT_EXTENSION: str = '.gly'
+SOURCE_EXTENSION: str = '.fnt'
+
+class StringTable:
+	def __init__(self):
+		self.offsets: dict = {}
+		self.payload: bytearray = bytearray()
+	def push(self, string: str) -> bytes:
+		encoded: bytes = string.encode('utf-8')
+		if encoded not in self.offsets:
+			self.offsets[encoded] = len(self.payload)
+			self.payload += encoded
+		return struct.pack('<II', self.offsets[encoded], len(encoded))
+
+# BMFont's json export turns a lone element into an object instead of a list.
+def as_list(value) -> list:
+	if isinstance(value, list):
+		return value
+	return [value] if isinstance(value, dict) else []
+
+def cook_font(source_path: str, cooked_path: str) -> bool:
+	try:
+		with open(source_path, 'r', encoding='utf-8') as file:
+			font: dict = json.load(file)['font']
+		common: dict = font['common']
+		page: dict = font['pages']['page']
+		dimensions: tuple = (float(common['-base']), float(common['-lineHeight']))
+		glyphs: list = [
+			struct.pack(
+				'<I7f', int(glyph['-id']),
+				float(glyph['-x']), float(glyph['-y']),
+				float(glyph['-width']), float(glyph['-height']),
+				float(glyph['-xoffset']), float(glyph['-yoffset']),
+				float(glyph['-xadvance'])
+			) for glyph in as_list(font['chars']['char'])
+		]
+		# Sorted by pair so font_t::kerning can binary search them in place.
+		kernings: list = sorted(
+			(
+				(int(kerning['-first']), int(kerning['-second']), float(kerning['-amount']))
+				for kerning in as_list(font.get('kernings', {}).get('kerning'))
+			),
+			key=lambda kerning: (kerning[0], kerning[1])
+		)
+		texture: str = page['-file']
+		palette: str = page['-pllt']
+	except (OSError, ValueError, KeyError, TypeError):
+		print(f'Error! Couldn\'t read \"{source_path}\"!')
+		return False
+	strings: StringTable = StringTable()
+	texture_string: bytes = strings.push(texture)
+	palette_string: bytes = strings.push(palette)
+	with open(cooked_path, 'wb') as file:
+		file.write(struct.pack('<II2fII', FONT_MAGIC, FONT_VERSION, *dimensions, len(glyphs), len(kernings)))
+		file.write(texture_string + palette_string)
+		file.write(struct.pack('<II', len(strings.payload), 0))
+		for glyph in glyphs:
+			file.write(glyph)
+		for kerning in kernings:
+			file.write(struct.pack('<IIf', *kerning))
+		file.write(strings.payload)
+	return True
+
+def cook_fonts(data_path: str, force: bool) -> bool:
+	font_path: str = os.path.join(data_path, 'font')
+	if not os.path.isdir(font_path):
+		print(f'Error! \"{font_path}\" isn\'t a directory!')
+		return False
+	count: int = 0
+	for name in sorted(os.listdir(font_path)):
+		if not name.endswith(SOURCE_EXTENSION):
+			continue
+		source_path: str = os.path.join(font_path, name)
+		cooked_path: str = os.path.splitext(source_path)[0] + FONT_EXTENSION
+		if not force and os.path.isfile(cooked_path) and os.path.getmtime(cooked_path) >= os.path.getmtime(source_path):
+			continue
+		if cook_font(source_path, cooked_path):
+			count += 1
+	print(f'Cooked {count} fonts in \"{data_path}\".')
+	return True
+
+def main():
+	arguments: list = [argument for argument in sys.argv[1:] if argument != '--force']
+	force: bool = len(arguments) != len(sys.argv) - 1
+	if len(arguments) == 1:
+		if not cook_fonts(arguments[0], force):
+			print('Error! Fonts weren\'t cooked!')
+	else:
+		print('Error! Usage: cook_fonts.py [--force] <data directory>')
+
+if __name__ == '__main__':
+	main()
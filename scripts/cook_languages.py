@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+
+import os, sys, json, struct
+
+LANGUAGE_MAGIC: int = 0x474E4C4C
+LANGUAGE_VERSION: int = 1
+LANGUAGE_EXTENSION: str = '.lng'
+SOURCE_EXTENSION: str = '.json'
+HASH_BASIS: int = 0xCBF29CE484222325
+HASH_PRIME: int = 0x00000100000001B3
+
+def hash_segment(segment: str) -> int:
+	result: int = HASH_BASIS
+	for byte in segment.encode('utf-8'):
+		result ^= byte
+		result = (result * HASH_PRIME) & 0xFFFFFFFFFFFFFFFF
+	return result
+
+# Segments are visited in key order like nlohmann::json does, so this matches what
+# i18n_table_t::parse builds byte for byte. Each segment's strings stay back to back.
+def cook_language(source_path: str, cooked_path: str) -> bool:
+	try:
+		with open(source_path, 'r', encoding='utf-8') as file:
+			source: dict = json.load(file)
+	except (OSError, ValueError):
+		print(f'Error! Couldn\'t read \"{source_path}\"!')
+		return False
+	if not isinstance(source, dict):
+		print(f'Error! \"{source_path}\" isn\'t a json object!')
+		return False
+	segments: list = []
+	entries: bytearray = bytearray()
+	text: bytearray = bytearray()
+	count: int = 0
+	for segment in sorted(source.keys()):
+		strings: list = source[segment]
+		if not isinstance(strings, list) or not all(isinstance(string, str) for string in strings):
+			print(f'Error! Segment \"{segment}\" in \"{source_path}\" isn\'t a list of strings!')
+			return False
+		segments.append((hash_segment(segment), count, len(strings)))
+		for string in strings:
+			encoded: bytes = string.encode('utf-8')
+			entries += struct.pack('<II', len(text), len(encoded))
+			text += encoded
+		count += len(strings)
+	segments.sort(key=lambda segment: segment[0])
+	for index in range(1, len(segments)):
+		if segments[index - 1][0] == segments[index][0]:
+			print(f'Error! Two segments in \"{source_path}\" share a hash!')
+			return False
+	with open(cooked_path, 'wb') as file:
+		file.write(struct.pack('<IIIIII', LANGUAGE_MAGIC, LANGUAGE_VERSION, len(segments), count, len(text), 0))
+		for segment in segments:
+			file.write(struct.pack('<QII', *segment))
+		file.write(entries)
+		file.write(text)
+	return True
+
+def cook_languages(data_path: str, force: bool) -> bool:
+	i18n_path: str = os.path.join(data_path, 'i18n')
+	if not os.path.isdir(i18n_path):
+		print(f'Error! \"{i18n_path}\" isn\'t a directory!')
+		return False
+	count: int = 0
+	for name in sorted(os.listdir(i18n_path)):
+		if not name.endswith(SOURCE_EXTENSION):
+			continue
+		source_path: str = os.path.join(i18n_path, name)
+		cooked_path: str = os.path.splitext(source_path)[0] + LANGUAGE_EXTENSION
+		if not force and os.path.isfile(cooked_path) and os.path.getmtime(cooked_path) >= os.path.getmtime(source_path):
+			continue
+		if cook_language(source_path, cooked_path):
+			count += 1
+	print(f'Cooked {count} languages in \"{data_path}\".')
+	return True
+
+def main():
+	arguments: list = [argument for argument in sys.argv[1:] if argument != '--force']
+	force: bool = len(arguments) != len(sys.argv) - 1
+	if len(arguments) == 1:
+		if not cook_languages(arguments[0], force):
+			print('Error! Languages weren\'t cooked!')
+	else:
+		print('Error! Usage: cook_languages.py [--force] <data directory>')
+
+if __name__ == '__main__':
+	main()
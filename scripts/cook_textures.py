@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+
+from PIL import Image
+import os, sys, json, struct
+
+IMAGE_MAGIC: int = 0x5854564C
+IMAGE_VERSION: int = 1
+IMAGE_EXTENSION: str = '.tex'
+# Matches the texture storage that texture_t allocates.
+MAXIMUM_LEVELS: int = 4
+# Values of pixel_format_t in source/video/gfx.hpp.
+FORMAT_R2G2B2A2: int = 3
+FORMAT_R8G8B8A8: int = 5
+TEXTURE_DIRECTORIES: tuple = ('image', 'font')
+PALETTE_DIRECTORIES: tuple = ('palette',)
+
+def get_level_count(size: tuple) -> int:
+	result: int = 1
+	largest: int = max(size)
+	while largest > 1 and result < MAXIMUM_LEVELS:
+		largest >>= 1
+		result += 1
+	return result
+
+def get_font_palettes(font_path: str) -> set:
+	palettes: set = set()
+	for name in os.listdir(font_path):
+		if name.endswith('.fnt'):
+			with open(os.path.join(font_path, name), 'r', encoding='utf-8') as file:
+				page: dict = json.load(file)['font']['pages']['page']
+			if '-pllt' in page:
+				palettes.add(page['-pllt'] + '.png')
+	return palettes
+
+def cook_image(source_path: str, cooked_path: str, levels: int, format: int) -> bool:
+	try:
+		image: Image = Image.open(source_path).convert('RGBA')
+	except OSError:
+		print(f'Error! Couldn\'t read \"{source_path}\"!')
+		return False
+	levels = min(levels, get_level_count(image.size))
+	width, height = image.size
+	chain: list = [image.tobytes()]
+	for level in range(1, levels):
+		extent: tuple = (max(width >> level, 1), max(height >> level, 1))
+		chain.append(image.resize(extent, Image.BOX).tobytes())
+	with open(cooked_path, 'wb') as file:
+		file.write(struct.pack('<IIIIIIII', IMAGE_MAGIC, IMAGE_VERSION, width, height, 1, levels, format, 0))
+		for pixels in chain:
+			file.write(pixels)
+	return True
+
+def cook_directory(directory_path: str, palettes: set, force: bool) -> int:
+	count: int = 0
+	for name in sorted(os.listdir(directory_path)):
+		if not name.endswith('.png'):
+			continue
+		source_path: str = os.path.join(directory_path, name)
+		cooked_path: str = os.path.splitext(source_path)[0] + IMAGE_EXTENSION
+		if not force and os.path.isfile(cooked_path) and os.path.getmtime(cooked_path) >= os.path.getmtime(source_path):
+			continue
+		if name in palettes:
+			cooked: bool = cook_image(source_path, cooked_path, 1, FORMAT_R2G2B2A2)
+		else:
+			cooked: bool = cook_image(source_path, cooked_path, MAXIMUM_LEVELS, FORMAT_R8G8B8A8)
+		if cooked:
+			count += 1
+	return count
+
+def cook_textures(data_path: str, force: bool) -> bool:
+	count: int = 0
+	for directory in TEXTURE_DIRECTORIES + PALETTE_DIRECTORIES:
+		directory_path: str = os.path.join(data_path, directory)
+		if not os.path.isdir(directory_path):
+			print(f'Error! \"{directory_path}\" isn\'t a directory!')
+			return False
+		palettes: set = set()
+		if directory in PALETTE_DIRECTORIES:
+			palettes = set(name for name in os.listdir(directory_path) if name.endswith('.png'))
+		elif directory == 'font':
+			palettes = get_font_palettes(directory_path)
+		count += cook_directory(directory_path, palettes, force)
+	print(f'Cooked {count} images in \"{data_path}\".')
+	return True
+
+def main():
+	arguments: list = [argument for argument in sys.argv[1:] if argument != '--force']
+	force: bool = len(arguments) != len(sys.argv) - 1
+	if len(arguments) == 1:
+		if not cook_textures(arguments[0], force):
+			print('Error! Textures weren\'t cooked!')
+	else:
+		print('Error! Usage: cook_textures.py [--force] <data directory>')
+
+if __name__ == '__main__':
+	main()
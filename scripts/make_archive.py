@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+
+import os, sys, struct
+
+ARCHIVE_MAGIC: int = 0x4B50564C
+ARCHIVE_VERSION: int = 1
+ARCHIVE_ALIGNMENT: int = 4096
+ARCHIVE_COMPRESSED: int = 1 << 0
+HASH_BASIS: int = 0xCBF29CE484222325
+HASH_PRIME: int = 0x00000100000001B3
+# These directories are written at runtime, so they stay loose on disk.
+SKIPPED_DIRECTORIES: tuple = ('init', 'save')
+# Sources that the cook_*.py scripts already turned into blobs are never read at runtime.
+# Pngs stay packed, since image_t falls back to them whenever a .tex can't be used.
+COOKED_EXTENSIONS: dict = {
+	'.tmx': '.fld',
+	'.cfg': '.anm',
+	'.json': '.lng',
+	'.fnt': '.gly'
+}
+
+def hash_path(path: str) -> int:
+	result: int = HASH_BASIS
+	for byte in path.encode('utf-8'):
+		result ^= byte
+		result = (result * HASH_PRIME) & 0xFFFFFFFFFFFFFFFF
+	return result
+
+def align_offset(offset: int) -> int:
+	return (offset + ARCHIVE_ALIGNMENT - 1) // ARCHIVE_ALIGNMENT * ARCHIVE_ALIGNMENT
+
+def collect_files(data_path: str) -> list:
+	files: list = []
+	root_path: str = os.path.dirname(os.path.abspath(data_path))
+	for directory, subdirectories, names in os.walk(data_path):
+		subdirectories[:] = sorted(s for s in subdirectories if s not in SKIPPED_DIRECTORIES)
+		for name in sorted(names):
+			stem, extension = os.path.splitext(name)
+			if extension in COOKED_EXTENSIONS and stem + COOKED_EXTENSIONS[extension] in names:
+				continue
+			full_path: str = os.path.join(directory, name)
+			relative_path: str = os.path.relpath(full_path, root_path).replace(os.sep, '/')
+			files.append((relative_path, full_path))
+	return files
+
+def compress_block(payload: bytes) -> bytes:
+	import lz4.block
+	return lz4.block.compress(payload, mode='high_compression', store_size=False)
+
+def make_archive(data_path: str, archive_path: str, compress: bool) -> bool:
+	entries: dict = {}
+	blobs: list = []
+	for relative_path, full_path in collect_files(data_path):
+		key: int = hash_path(relative_path)
+		if key in entries:
+			print(f'Error! Hash collision between \"{relative_path}\" and \"{entries[key]}\"!')
+			return False
+		entries[key] = relative_path
+		with open(full_path, 'rb') as file:
+			payload: bytes = file.read()
+		flags: int = 0
+		stored: bytes = payload
+		if compress and len(payload) > 0:
+			packed: bytes = compress_block(payload)
+			if len(packed) < len(payload):
+				stored = packed
+				flags |= ARCHIVE_COMPRESSED
+		blobs.append((key, len(payload), stored, flags))
+	blobs.sort(key=lambda blob: blob[0])
+	offset: int = ARCHIVE_ALIGNMENT
+	index: list = []
+	with open(archive_path, 'wb') as file:
+		file.write(b'\0' * ARCHIVE_ALIGNMENT)
+		for key, length, stored, flags in blobs:
+			file.seek(offset)
+			file.write(stored)
+			index.append(struct.pack('<QQIIII', key, offset, length, len(stored), flags, 0))
+			offset = align_offset(offset + len(stored))
+		file.seek(offset)
+		file.write(b''.join(index))
+		file.seek(0)
+		file.write(struct.pack('<IIIIQQ', ARCHIVE_MAGIC, ARCHIVE_VERSION, len(index), ARCHIVE_ALIGNMENT, offset, 0))
+	print(f'Packed {len(index)} files into \"{archive_path}\".')
+	return True
+
+def main():
+	arguments: list = [argument for argument in sys.argv[1:] if argument != '--lz4']
+	compress: bool = len(arguments) != len(sys.argv) - 1
+	if len(arguments) == 2:
+		if not os.path.isdir(arguments[0]):
+			print(f'Error! \"{arguments[0]}\" isn\'t a directory!')
+		elif not make_archive(arguments[0], arguments[1], compress):
+			print('Error! Archive wasn\'t written!')
+	else:
+		print('Error! Usage: make_archive.py [--lz4] <data directory> <archive path>')
+
+if __name__ == '__main__':
+	main()
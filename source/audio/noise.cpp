@@ -2,15 +2,18 @@
 #include "./alcheck.hpp"
 #include "./channel.hpp"
 #include "../utility/logger.hpp"
-#include "../utility/thread_pool.hpp"
+#include "../utility/vfs.hpp"
 
 #include <cstring>
 #include <SDL2/SDL_audio.h>
+#include <SDL2/SDL_rwops.h>
 
 noise_t::noise_t() :
 	ready(false),
-	future(),
+	counter(),
+	path(),
 	handle(0),
+	length(0),
 	binder()
 {
 
@@ -22,8 +25,10 @@ noise_t::noise_t(noise_t&& that) noexcept : noise_t() {
 		ready.store(that.ready.load());
 		that.ready.store(temp.load());
 
-		std::swap(future, that.future);
+		std::swap(counter, that.counter);
+		std::swap(path, that.path);
 		std::swap(handle, that.handle);
+		std::swap(length, that.length);
 		std::swap(binder, that.binder);
 	}
 }
@@ -34,8 +39,10 @@ noise_t& noise_t::operator=(noise_t&& that) noexcept {
 		ready.store(that.ready.load());
 		that.ready.store(temp.load());
 
-		std::swap(future, that.future);
+		std::swap(counter, that.counter);
+		std::swap(path, that.path);
 		std::swap(handle, that.handle);
+		std::swap(length, that.length);
 		std::swap(binder, that.binder);
 	}
 	return *this;
@@ -69,8 +76,10 @@ void noise_t::load(const std::string& full_path) {
 		uint8_t* data = nullptr;
 		uint_t length = 0;
 		SDL_AudioSpec aospec;
-		if (!SDL_LoadWAV(full_path.c_str(), &aospec, &data, &length)) {
-			synao_log("Failed to load noise from %s!\nSDL Error: %s\n", full_path.c_str(), SDL_GetError());
+		const archive_blob_t blob = vfs::memory(full_path);
+		SDL_RWops* stream = SDL_RWFromConstMem(blob.data(), static_cast<sint_t>(blob.size()));
+		if (stream == nullptr or !SDL_LoadWAV_RW(stream, 1, &aospec, &data, &length)) {
+			synao_warn(Audio, "Failed to load noise from %s!\nSDL Error: %s\n", full_path.c_str(), SDL_GetError());
 			return;
 		}
 		alCheck(alBufferData(
@@ -81,15 +90,18 @@ void noise_t::load(const std::string& full_path) {
 			aospec.freq
 		));
 		SDL_FreeWAV(data);
+		this->length = length;
 		ready = true;
 	}
 }
 
-void noise_t::load(const std::string& full_path, thread_pool_t& thread_pool) {
+void noise_t::load(const std::string& full_path, job_system_t& job_system) {
 	assert(!ready);
-	this->future = thread_pool.push([this](const std::string& full_path) -> void {
-		this->load(full_path);
-	}, full_path);
+	path = full_path;
+	job_system.push(job_priority_t::Normal, &counter, [this] {
+		this->load(this->path);
+		this->path.clear();
+	});
 }
 
 bool noise_t::create() {
@@ -102,9 +114,7 @@ bool noise_t::create() {
 }
 
 void noise_t::destroy() {
-	if (future.valid()) {
-		future.wait();
-	}
+	counter.reset();
 	ready = false;
 	if (binder.size() > 0) {
 		std::set<channel_t*> channels;
@@ -117,10 +127,15 @@ void noise_t::destroy() {
 		alCheck(alDeleteBuffers(1, &handle));
 		handle = 0;
 	}
+	length = 0;
 }
 
 void noise_t::assure() const {
-	if (!ready and future.valid()) {
-		future.wait();
+	if (!ready and counter.valid()) {
+		counter.wait();
 	}
 }
+
+arch_t noise_t::get_footprint() const {
+	return ready.load(std::memory_order_acquire) ? length : 0;
+}
@@ -3,12 +3,10 @@
 
 #include <string>
 #include <atomic>
-#include <future>
 #include <set>
 
-#include "../types.hpp"
+#include "../utility/job_system.hpp"
 
-struct thread_pool_t;
 struct channel_t;
 
 struct noise_t : public not_copyable_t {
@@ -19,15 +17,18 @@ public:
 	~noise_t();
 public:
 	void load(const std::string& full_path);
-	void load(const std::string& full_path, thread_pool_t& thread_pool);
+	void load(const std::string& full_path, job_system_t& job_system);
 	bool create();
 	void destroy();
 	void assure() const;
+	arch_t get_footprint() const;
 private:
 	friend struct channel_t;
 	std::atomic<bool> ready;
-	std::future<void> future;
+	job_counter_t counter;
+	std::string path;
 	uint_t handle;
+	arch_t length;
 	mutable std::set<channel_t*> binder;
 };
 
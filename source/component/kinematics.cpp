@@ -3,6 +3,7 @@
 #include "./kontext.hpp"
 
 #include "../field/collision.hpp"
+#include "../utility/profiler.hpp"
 
 static constexpr real_t kLongFactor  = 2.0f;
 static constexpr real_t kShortFactor = 3.0f;
@@ -76,6 +77,7 @@ bool kinematics_t::any_side() const {
 }
 
 void kinematics_t::handle(kontext_t& kontext, const tilemap_t& tilemap) {
+	synao_zone("kinematics_t::handle");
 	kontext.slice<kinematics_t, location_t>().each([&tilemap](entt::entity, kinematics_t& kinematics, location_t& location) {
 		if (kinematics.velocity.x != 0.0f) {
 			kinematics_t::do_x(location, kinematics, kinematics.velocity.x, tilemap);
@@ -9,16 +9,16 @@
 
 #include <cinttypes>
 #include <angelscript.h>
-#include <tmxlite/ObjectGroup.hpp>
 
 #include "../actor/particles.hpp"
+#include "../field/field_file.hpp"
 #include "../system/kernel.hpp"
 #include "../event/receiver.hpp"
 #include "../overlay/draw_headsup.hpp"
 #include "../utility/debug.hpp"
 #include "../utility/hash.hpp"
 #include "../utility/logger.hpp"
-#include "../utility/tmx_convert.hpp"
+#include "../utility/profiler.hpp"
 
 kontext_t::kontext_t() :
 	panic_draw(false),
@@ -43,14 +43,22 @@ bool kontext_t::init(receiver_t& receiver, draw_headsup_t& headsup) {
 	push_meter = [&headsup](sint_t current, sint_t maximum) {
 		headsup.set_fight_values(current, maximum);
 	};
-	if (!routine_generator_t::init(ctor_table)) {
-		synao_log("Actor constructor table generation failed!\n");
+	if (!this->generate()) {
 		return false;
 	}
 	synao_log("Kontext system is ready.\n");
 	return true;
 }
 
+// Doesn't touch anything else, so startup can build the table on a job thread.
+bool kontext_t::generate() {
+	if (ctor_table.empty() and !routine_generator_t::init(ctor_table)) {
+		synao_log("Actor constructor table generation failed!\n");
+		return false;
+	}
+	return true;
+}
+
 void kontext_t::reset() {
 	panic_draw = true;
 	liquid_flag = false;
@@ -62,6 +70,7 @@ void kontext_t::reset() {
 }
 
 void kontext_t::handle(audio_t& audio, receiver_t& receiver, camera_t& camera, naomi_state_t& naomi_state, tilemap_t& tilemap) {
+	synao_zone("kontext_t::handle");
 	kinematics_t::handle(*this, tilemap);
 	routine_t::handle(audio, camera, naomi_state, *this, tilemap);
 	health_t::handle(audio, receiver, naomi_state, *this);
@@ -135,11 +144,11 @@ void kontext_t::kill_id(sint_t identity) {
 	}
 }
 
-static const byte_t kMapActor[] = "actor";
-static const byte_t kMapWater[] = "water";
-
 bool kontext_t::create(const std::string& name, glm::vec2 position, direction_t direction, sint_t identity, arch_t flags) {
-	arch_t type = synao_hash(name.c_str());
+	return this->create(synao_hash(name.c_str()), name, position, direction, identity, flags);
+}
+
+bool kontext_t::create(arch_t type, const std::string& name, glm::vec2 position, direction_t direction, sint_t identity, arch_t flags) {
 	auto iter = ctor_table.find(type);
 	if (iter != ctor_table.end()) {
 		entt::entity actor = registry.create();
@@ -151,7 +160,7 @@ bool kontext_t::create(const std::string& name, glm::vec2 position, direction_t
 		iter->second(actor, *this);
 		return true;
 	}
-	synao_log("Couldn't create %s!\n", name.c_str());
+	synao_warn(Field, "Couldn't create %s!\n", name.c_str());
 	return false;
 }
 
@@ -171,9 +180,9 @@ bool kontext_t::create(const actor_spawn_t& spawn) {
 		return true;
 	}
 	if constexpr (sizeof(arch_t) == 8) {
-		synao_log("Couldn't spawn actor %" PRIu64 "!\n", spawn.type);
+		synao_warn(Field, "Couldn't spawn actor %" PRIu64 "!\n", spawn.type);
 	} else {
-		synao_log("Couldn't spawn actor %d!\n", static_cast<uint_t>(spawn.type));
+		synao_warn(Field, "Couldn't spawn actor %d!\n", static_cast<uint_t>(spawn.type));
 	}
 	return false;
 }
@@ -188,39 +197,23 @@ bool kontext_t::create_minimally(const std::string& name, real_t x, real_t y, si
 	return false;
 }
 
-void kontext_t::setup_layer(const std::unique_ptr<tmx::Layer>& layer, const kernel_t& kernel, receiver_t& receiver) {
-	auto& objects = dynamic_cast<tmx::ObjectGroup*>(layer.get())->getObjects();
-	for (auto&& object : objects) {
-		const std::string& name = object.getName();
-		const std::string& type = object.getType();
-		if (type == kMapActor) {
-			direction_t direction = direction_t::Right;
-			std::string symbol;
-			arch_t flags = 0;
-			sint_t identity = 0;
-			arch_t deterrent = 0;
-			tmx_convert::prop_to_stats(
-				object.getProperties(),
-				direction, symbol,
-				flags, identity, deterrent
-			);
-			if (kernel.get_flag(deterrent) == (flags & (1 << trigger_flags_t::Deterred))) {
-				glm::vec2 position = tmx_convert::vec_to_vec(object.getPosition());
-				if (this->create(name, position, direction, identity, flags)) {
-					if (identity != 0) {
-						const std::string& field = kernel.get_field();
-						receiver.push_from_symbol(identity, field, symbol);
-					}
+void kontext_t::setup_field(const field_file_t& field, const kernel_t& kernel, receiver_t& receiver) {
+	for (auto&& spawn : field.actors) {
+		if (kernel.get_flag(spawn.deterrent) == (spawn.flags & (1 << trigger_flags_t::Deterred))) {
+			if (this->create(spawn.type, spawn.name, spawn.position, spawn.direction, spawn.identity, spawn.flags)) {
+				if (spawn.identity != 0) {
+					const std::string& name = kernel.get_field();
+					receiver.push_from_symbol(spawn.identity, name, spawn.symbol);
 				}
 			}
-		} else if (type == kMapWater) {
-			liquid_flag = true;
-			rect_t hitbox = tmx_convert::rect_to_rect(object.getAABB());
-			entt::entity actor = registry.create();
-			registry.emplace<actor_header_t>(actor);
-			registry.emplace<liquid_body_t>(actor, hitbox);
 		}
 	}
+	for (auto&& hitbox : field.liquids) {
+		liquid_flag = true;
+		entt::entity actor = registry.create();
+		registry.emplace<actor_header_t>(actor);
+		registry.emplace<liquid_body_t>(actor, hitbox);
+	}
 }
 
 void kontext_t::smoke(glm::vec2 position, arch_t count) {
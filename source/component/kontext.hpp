@@ -6,7 +6,6 @@
 #include <memory>
 #include <functional>
 #include <entt/entity/entity.hpp>
-#include <tmxlite/Layer.hpp>
 
 #include "./common.hpp"
 #include "./routine.hpp"
@@ -23,6 +22,7 @@ struct camera_t;
 struct naomi_state_t;
 struct tilemap_t;
 struct draw_headsup_t;
+struct field_file_t;
 
 struct kontext_t : public not_copyable_t {
 public:
@@ -32,6 +32,7 @@ public:
 	~kontext_t() = default;
 public:
 	bool init(receiver_t& receiver, draw_headsup_t& headsup);
+	bool generate();
 	void reset();
 	void handle(audio_t& audio, receiver_t& receiver, camera_t& camera, naomi_state_t& naomi_state, tilemap_t& tilemap);
 	void update(real64_t delta);
@@ -43,7 +44,7 @@ public:
 	bool create(const actor_spawn_t& spawn);
 	bool create(const std::string& name, glm::vec2 position, direction_t direction, sint_t identity, arch_t flags);
 	bool create_minimally(const std::string& name, real_t x, real_t y, sint_t identity);
-	void setup_layer(const std::unique_ptr<tmx::Layer>& layer, const kernel_t& kernel, receiver_t& receiver);
+	void setup_field(const field_file_t& field, const kernel_t& kernel, receiver_t& receiver);
 	void smoke(glm::vec2 position, arch_t count);
 	void smoke(real_t x, real_t y, arch_t count);
 	void shrapnel(glm::vec2 position, arch_t count);
@@ -82,6 +83,8 @@ public:
 	decltype(auto) assign_if(entt::entity actor, Args&& ...args);
 	template<typename Component, typename Compare, typename... Args>
 	void sort(Compare compare, Args&& ...args);
+private:
+	bool create(arch_t type, const std::string& name, glm::vec2 position, direction_t direction, sint_t identity, arch_t flags);
 private:
 	mutable bool_t panic_draw;
 	bool_t liquid_flag;
@@ -2,6 +2,7 @@
 #include "./kontext.hpp"
 
 #include "../utility/logger.hpp"
+#include "../utility/profiler.hpp"
 
 static std::vector<void(*)(std::unordered_map<arch_t, routine_ctor_fn>&)>& get_callback_list() {
 	static std::vector<void(*)(std::unordered_map<arch_t, routine_ctor_fn>&)> callback_list;
@@ -50,6 +51,7 @@ routine_t::routine_t() :
 }
 
 void routine_t::handle(audio_t& audio, camera_t& camera, naomi_state_t& naomi_state, kontext_t& kontext, tilemap_t& tilemap) {
+	synao_zone("routine_t::handle");
 	auto view = kontext.slice<routine_t>();
 	if (!view.empty()) {
 		routine_tuple_t rtp(
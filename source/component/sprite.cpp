@@ -22,7 +22,7 @@ sprite_t::sprite_t(const tbl_entry_t& entry) :
 	angle(0.0f),
 	shake(0.0f)
 {
-	file = vfs::animation(entry);
+	file = vfs::acquire_animation(entry);
 }
 
 sprite_t::sprite_t() :
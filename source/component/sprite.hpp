@@ -3,6 +3,7 @@
 
 #include "../utility/rect.hpp"
 #include "../utility/enums.hpp"
+#include "../utility/vfs_cache.hpp"
 
 struct tbl_entry_t;
 struct animation_t;
@@ -30,7 +31,7 @@ public:
 		return lhv.layer < rhv.layer;
 	}
 private:
-	const animation_t* file;
+	vfs_handle_t<animation_t> file;
 public:
 	static constexpr arch_t NonState = (arch_t)-1;
 	mutable bool_t amend;
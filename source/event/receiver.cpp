@@ -11,6 +11,7 @@
 
 #include "../utility/constants.hpp"
 #include "../utility/logger.hpp"
+#include "../utility/profiler.hpp"
 #include "../utility/vfs.hpp"
 
 #include "../overlay/draw_headsup.hpp"
@@ -30,6 +31,19 @@ static const byte_t kInvenDecl[] = "void inventory(arch_t type, arch_t cursor)";
 
 static constexpr uint_t kMaxCalls = 128;
 
+// Scripts keep their own copies, since views into the language table don't outlive a language switch.
+static std::string locale_string(const std::string& segment, arch_t index) {
+	return std::string(vfs::i18n_find(segment, index));
+}
+
+static std::string locale_string(const std::string& segment, arch_t first, arch_t last) {
+	return std::string(vfs::i18n_find(segment, first, last));
+}
+
+static arch_t locale_size(const std::string& segment) {
+	return vfs::i18n_size(segment);
+}
+
 receiver_t::receiver_t() :
 	bitmask(0),
 	timer(0.0f),
@@ -122,6 +136,7 @@ void receiver_t::reset() {
 }
 
 void receiver_t::handle(const input_t& input, kernel_t& kernel, const stack_gui_t& stack_gui, dialogue_gui_t& dialogue_gui, const inventory_gui_t& inventory_gui, draw_headsup_t& headsup) {
+	synao_zone("receiver_t::handle");
 	if (bitmask[rec_bits_t::Running]) {
 		if (!headsup.is_fade_moving() and !dialogue_gui.get_flag(dialogue_flag_t::Question)) {
 			if (bitmask[rec_bits_t::Stalled]) {
@@ -152,7 +167,8 @@ void receiver_t::handle(const input_t& input, kernel_t& kernel, const stack_gui_
 					bitmask.reset();
 					timer = 0.0f;
 					calls = 0;
-					synao_log(
+					synao_error(
+						Script,
 						"Running script threw an exception!\n%s\n%s at line %d!\n",
 						state->GetExceptionString(),
 						state->GetExceptionFunction()->GetName(),
@@ -209,16 +225,21 @@ bool receiver_t::load(const std::string& name, rec_loading_t flags) {
 		synao_log("Couldn't allocate script module during loading process!\n");
 		return false;
 	}
-	const std::string buffer = vfs::string_buffer(vfs::event_path(name, flags));
-	arch_t length = buffer.length();
-	if (module->AddScriptSection(name.c_str(), buffer.c_str(), length) != 0) {
+	const std::string full_path = vfs::event_path(name, flags);
+	const archive_blob_t blob = vfs::memory(full_path);
+	if (blob.empty()) {
+		current = nullptr;
+		synao_error(Script, "Failed to open script file: %s!\n", full_path.c_str());
+		return false;
+	}
+	if (module->AddScriptSection(name.c_str(), blob.data(), blob.size()) != 0) {
 		current = nullptr;
-		synao_log("Adding script section %s failed!\n", name.c_str());
+		synao_error(Script, "Adding script section %s failed!\n", name.c_str());
 		return false;
 	}
 	if (module->Build() != 0) {
 		current = nullptr;
-		synao_log("Building module %s failed!\n", name.c_str());
+		synao_error(Script, "Building module %s failed!\n", name.c_str());
 		return false;
 	}
 	this->link_imported_functions(module);
@@ -313,26 +334,26 @@ void receiver_t::print_message(const std::string& message) {
 }
 
 void receiver_t::error_callback(const asSMessageInfo* msg, optr_t) {
-	const byte_t* type = nullptr;
+	log_level_t level = log_level_t::Debug;
 	switch (msg->type) {
 	case asMSGTYPE_ERROR:
-		type = "ERROR";
+		level = log_level_t::Error;
 		break;
 	case asMSGTYPE_WARNING:
-		type = "WARN";
+		level = log_level_t::Warning;
 		break;
 	case asMSGTYPE_INFORMATION:
-		type = "INFO";
+		level = log_level_t::Info;
 		break;
 	default:
-		type = "OKAY";
 		break;
 	}
-	synao_log(
-		"%s (%d, %d) : %s : %s\n",
+	logger::push(
+		level, log_category_t::Script,
+		"%s (%d, %d) : %s\n",
 		msg->section,
 		msg->row, msg->col,
-		type, msg->message
+		msg->message
 	);
 }
 
@@ -404,7 +425,7 @@ void receiver_t::execute_function(asIScriptFunction* function) {
 		timer = 0.0f;
 		calls = 0;
 	} else {
-		synao_log("Couldn't execute function!\n");
+		synao_error(Script, "Couldn't execute function!\n");
 	}
 }
 
@@ -427,7 +448,7 @@ void receiver_t::execute_function(asIScriptFunction* function, std::vector<arch_
 			}
 		}
 	} else {
-		synao_log("Couldn't execute function!\n");
+		synao_error(Script, "Couldn't execute function!\n");
 	}
 }
 
@@ -479,7 +500,7 @@ void receiver_t::link_imported_functions(asIScriptModule* module) {
 		const byte_t* declaration = module->GetImportedFunctionDeclaration(it);
 		asIScriptFunction* function = module->GetFunctionByDecl(declaration);
 		if (function == nullptr or module->BindImportedFunction(it, function) < 0) {
-			synao_log("Linking for declaration %s failed!\n", declaration);
+			synao_error(Script, "Linking for declaration %s failed!\n", declaration);
 		}
 	}
 }
@@ -689,13 +710,13 @@ void receiver_t::generate_functions(input_t& input, audio_t& audio, music_t& mus
 	r = engine->RegisterGlobalFunction("bool get_key_held(arch_t action)", WRAP_MFN(std::bitset<btn_t::Total>, test), asCALL_THISCALL_ASGLOBAL, &input.holding);
 	assert(r >= 0);
 	// Get Locale String
-	r = engine->RegisterGlobalFunction("std::string locale(const std::string &in key, arch_t index)", WRAP_FN_PR(vfs::i18n_find, (const std::string&, arch_t), std::string), asCALL_CDECL);
+	r = engine->RegisterGlobalFunction("std::string locale(const std::string &in key, arch_t index)", WRAP_FN_PR(locale_string, (const std::string&, arch_t), std::string), asCALL_CDECL);
 	assert(r >= 0);
 	// Get Locale String
-	r = engine->RegisterGlobalFunction("std::string locale(const std::string &in key, arch_t first, arch_t last)", WRAP_FN_PR(vfs::i18n_find, (const std::string&, arch_t, arch_t), std::string), asCALL_CDECL);
+	r = engine->RegisterGlobalFunction("std::string locale(const std::string &in key, arch_t first, arch_t last)", WRAP_FN_PR(locale_string, (const std::string&, arch_t, arch_t), std::string), asCALL_CDECL);
 	assert(r >= 0);
 	// Get Locale Size
-	r = engine->RegisterGlobalFunction("arch_t locale(const std::string &in key)", WRAP_FN_PR(vfs::i18n_size, (const std::string&), arch_t), asCALL_CDECL);
+	r = engine->RegisterGlobalFunction("arch_t locale(const std::string &in key)", WRAP_FN_PR(locale_size, (const std::string&), arch_t), asCALL_CDECL);
 	assert(r >= 0);
 	// Push Menu
 	r = engine->RegisterGlobalFunction("void push_widget(arch_t type, arch_t flags)", WRAP_MFN(stack_gui_t, push), asCALL_THISCALL_ASGLOBAL, &stack_gui);
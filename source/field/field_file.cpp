@@ -0,0 +1,345 @@
+#include "./field_file.hpp"
+
+#include "../utility/archive.hpp"
+#include "../utility/constants.hpp"
+#include "../utility/hash.hpp"
+#include "../utility/logger.hpp"
+#include "../utility/profiler.hpp"
+#include "../utility/tmx_convert.hpp"
+#include "../utility/vfs.hpp"
+
+#include <tmxlite/Map.hpp>
+#include <tmxlite/TileLayer.hpp>
+#include <tmxlite/ImageLayer.hpp>
+#include <tmxlite/ObjectGroup.hpp>
+
+static const byte_t kCookedExtension[] 	= ".fld";
+static const byte_t kSourceExtension[] 	= ".tmx";
+static const byte_t kPaletteProperty[] 	= "indexed";
+static const byte_t kCollideLayer[] 	= "collide";
+static const byte_t kPriorityType[] 	= "priority";
+static const byte_t kBoundsXProp[] 		= "rect.x";
+static const byte_t kBoundsYProp[] 		= "rect.y";
+static const byte_t kBoundsWProp[] 		= "rect.w";
+static const byte_t kBoundsHProp[] 		= "rect.h";
+static const byte_t kScrollXProp[] 		= "scroll.x";
+static const byte_t kScrollYProp[] 		= "scroll.y";
+static const byte_t kMapActor[] 		= "actor";
+static const byte_t kMapWater[] 		= "water";
+
+static constexpr sint_t kScreenWidth  	= 21;
+static constexpr sint_t kScreenHeight 	= 12;
+static constexpr sint_t kInvalidTiles 	= -1;
+
+// Layout written by scripts/cook_fields.py. Sections follow the header in the order
+// of its counts: attributes, tile layers, backgrounds, actors, liquids, then strings.
+struct field_header_t {
+	uint32_t magic;
+	uint32_t version;
+	real_t bounds[4];
+	sint_t dimensions[2];
+	uint32_t tile_layers;
+	uint32_t backgrounds;
+	uint32_t actors;
+	uint32_t liquids;
+	uint32_t strings;
+	archive_string_t tileset;
+	archive_string_t palette;
+};
+
+struct field_layer_record_t {
+	real_t priority;
+	uint32_t count;
+};
+
+struct field_parallax_record_t {
+	archive_string_t texture;
+	uint32_t specified;
+	real_t bounds[4];
+	real_t scrolling[2];
+};
+
+struct field_actor_record_t {
+	uint64_t type;
+	archive_string_t name;
+	archive_string_t symbol;
+	real_t position[2];
+	uint32_t direction;
+	uint32_t flags;
+	sint_t identity;
+	uint32_t deterrent;
+};
+
+static_assert(sizeof(field_header_t) == 68, "Cooked field header must stay 68 bytes!");
+static_assert(sizeof(field_parallax_record_t) == 36, "Cooked parallax records must stay 36 bytes!");
+static_assert(sizeof(field_actor_record_t) == 48, "Cooked actor records must stay 48 bytes!");
+
+static glm::ivec2 get_dimensions(const rect_t& bounds) {
+	return glm::ivec2(
+		glm::max(static_cast<sint_t>(bounds.w) / constants::TileSize<sint_t>(), kScreenWidth),
+		glm::max(static_cast<sint_t>(bounds.h) / constants::TileSize<sint_t>(), kScreenHeight)
+	);
+}
+
+field_file_t::field_file_t() :
+	bounds(),
+	dimensions(0),
+	tileset(),
+	palette(),
+	attributes(),
+	tile_layers(),
+	backgrounds(),
+	actors(),
+	liquids()
+{
+
+}
+
+field_file_t::field_file_t(field_file_t&& that) noexcept : field_file_t() {
+	if (this != &that) {
+		std::swap(bounds, that.bounds);
+		std::swap(dimensions, that.dimensions);
+		std::swap(tileset, that.tileset);
+		std::swap(palette, that.palette);
+		std::swap(attributes, that.attributes);
+		std::swap(tile_layers, that.tile_layers);
+		std::swap(backgrounds, that.backgrounds);
+		std::swap(actors, that.actors);
+		std::swap(liquids, that.liquids);
+	}
+}
+
+field_file_t& field_file_t::operator=(field_file_t&& that) noexcept {
+	if (this != &that) {
+		std::swap(bounds, that.bounds);
+		std::swap(dimensions, that.dimensions);
+		std::swap(tileset, that.tileset);
+		std::swap(palette, that.palette);
+		std::swap(attributes, that.attributes);
+		std::swap(tile_layers, that.tile_layers);
+		std::swap(backgrounds, that.backgrounds);
+		std::swap(actors, that.actors);
+		std::swap(liquids, that.liquids);
+	}
+	return *this;
+}
+
+bool field_file_t::load(const std::string& name) {
+	synao_zone("field_file_t::load");
+	this->clear();
+	const std::string path = vfs::resource_path(vfs_resource_path_t::Field) + name;
+	if (vfs::contains(path + kCookedExtension)) {
+		const archive_blob_t blob = vfs::memory(path + kCookedExtension);
+		if (this->read(blob)) {
+			return true;
+		}
+		synao_warn(Field, "Cooked field %s is invalid! Falling back to its tmx file.\n", name.c_str());
+		this->clear();
+	}
+	const archive_blob_t blob = vfs::memory(path + kSourceExtension);
+	if (blob.empty() or !this->parse(blob)) {
+		this->clear();
+		return false;
+	}
+	return true;
+}
+
+void field_file_t::clear() {
+	bounds = rect_t();
+	dimensions = glm::zero<glm::ivec2>();
+	tileset.clear();
+	palette.clear();
+	attributes.clear();
+	tile_layers.clear();
+	backgrounds.clear();
+	actors.clear();
+	liquids.clear();
+}
+
+bool field_file_t::exists(const std::string& name) {
+	const std::string path = vfs::resource_path(vfs_resource_path_t::Field) + name;
+	return vfs::contains(path + kCookedExtension) or vfs::contains(path + kSourceExtension);
+}
+
+bool field_file_t::read(const archive_blob_t& blob) {
+	field_header_t header;
+	archive_reader_t reader{ blob };
+	if (!reader.take(header) or header.magic != field_file_t::Magic or header.version != field_file_t::Version) {
+		return false;
+	}
+	bounds = rect_t(header.bounds[0], header.bounds[1], header.bounds[2], header.bounds[3]);
+	dimensions = glm::ivec2(header.dimensions[0], header.dimensions[1]);
+	if (!reader.strings(header.strings) or dimensions != get_dimensions(bounds)) {
+		return false;
+	}
+	if (!reader.resolve(header.tileset, tileset) or !reader.resolve(header.palette, palette)) {
+		return false;
+	}
+	const arch_t area = static_cast<arch_t>(dimensions.x) * static_cast<arch_t>(dimensions.y);
+	if (area > blob.size() / sizeof(sint_t)) {
+		return false;
+	}
+	attributes.resize(area);
+	if (!reader.take(attributes.data(), area * sizeof(sint_t))) {
+		return false;
+	}
+	// Counts aren't trusted for allocation, so every record is read before it's kept.
+	for (uint32_t it = 0; it < header.tile_layers; ++it) {
+		field_layer_record_t record;
+		if (!reader.take(record) or record.count != area) {
+			return false;
+		}
+		auto& recent = tile_layers.emplace_back();
+		recent.priority = record.priority;
+		recent.tiles.resize(area);
+		for (auto&& tile : recent.tiles) {
+			sint_t indices[2];
+			if (!reader.take(indices)) {
+				return false;
+			}
+			tile = glm::ivec2(indices[0], indices[1]);
+		}
+	}
+	for (uint32_t it = 0; it < header.backgrounds; ++it) {
+		field_parallax_record_t record;
+		auto& recent = backgrounds.emplace_back();
+		if (!reader.take(record) or !reader.resolve(record.texture, recent.texture)) {
+			return false;
+		}
+		recent.specified = record.specified;
+		recent.bounds = rect_t(record.bounds[0], record.bounds[1], record.bounds[2], record.bounds[3]);
+		recent.scrolling = glm::vec2(record.scrolling[0], record.scrolling[1]);
+	}
+	for (uint32_t it = 0; it < header.actors; ++it) {
+		field_actor_record_t record;
+		auto& recent = actors.emplace_back();
+		if (!reader.take(record) or !reader.resolve(record.name, recent.name) or !reader.resolve(record.symbol, recent.symbol)) {
+			return false;
+		}
+		// Types are hashed ahead of time with the 64-bit hash, which narrower builds don't use.
+		if constexpr (sizeof(arch_t) == sizeof(uint64_t)) {
+			recent.type = static_cast<arch_t>(record.type);
+		} else {
+			recent.type = synao_hash(recent.name.c_str());
+		}
+		recent.position = glm::vec2(record.position[0], record.position[1]);
+		recent.direction = static_cast<direction_t>(record.direction);
+		recent.flags = static_cast<arch_t>(record.flags);
+		recent.identity = record.identity;
+		recent.deterrent = static_cast<arch_t>(record.deterrent);
+	}
+	for (uint32_t it = 0; it < header.liquids; ++it) {
+		real_t record[4];
+		if (!reader.take(record)) {
+			return false;
+		}
+		liquids.emplace_back(record[0], record[1], record[2], record[3]);
+	}
+	return true;
+}
+
+bool field_file_t::parse(const archive_blob_t& blob) {
+	synao_zone("field_file_t::parse");
+	tmx::Map tmxmap;
+	if (!tmxmap.loadFromString(std::string(blob.data(), blob.size()), vfs::resource_path(vfs_resource_path_t::Field))) {
+		return false;
+	}
+	bounds = tmx_convert::rect_to_rect(tmxmap.getBounds());
+	dimensions = get_dimensions(bounds);
+	const arch_t area = static_cast<arch_t>(dimensions.x) * static_cast<arch_t>(dimensions.y);
+	attributes.resize(area);
+	std::vector<sint_t> attribute_key;
+	auto& tilesets = tmxmap.getTilesets();
+	if (!tilesets.empty()) {
+		auto& first = tilesets[0];
+		for (auto&& property : first.getProperties()) {
+			if (property.getName() == kPaletteProperty) {
+				palette = first.getName();
+			}
+		}
+		tileset = tmx_convert::path_to_name(first.getImagePath());
+		const std::string tilekey_path = vfs::resource_path(vfs_resource_path_t::TileKey);
+		attribute_key = vfs::sint_buffer(tilekey_path + tileset + ".atr");
+	}
+	for (auto&& layer : tmxmap.getLayers()) {
+		switch (layer->getType()) {
+		case tmx::Layer::Type::Tile: {
+			if (attribute_key.empty()) {
+				break;
+			}
+			auto& recent = tile_layers.emplace_back();
+			recent.tiles.resize(area);
+			bool colliding = false;
+			for (auto&& property : layer->getProperties()) {
+				auto& name = property.getName();
+				if (name == kCollideLayer) {
+					colliding = tmx_convert::prop_to_bool(property);
+					recent.priority = layer_value::TileBack;
+				} else if (name == kPriorityType) {
+					if (tmx_convert::prop_to_bool(property)) {
+						recent.priority = layer_value::TileFront;
+					}
+				}
+			}
+			auto& array = dynamic_cast<const tmx::TileLayer*>(layer.get())->getTiles();
+			for (arch_t it = 0; it < array.size() and it < area; ++it) {
+				sint_t type = static_cast<sint_t>(array[it].ID) - 1;
+				recent.tiles[it] = type >= 0 ?
+					glm::ivec2(type % constants::TileSize<sint_t>(), type / constants::TileSize<sint_t>()) :
+					glm::ivec2(kInvalidTiles);
+				if (colliding and type >= 0 and static_cast<arch_t>(type) < attribute_key.size()) {
+					attributes[it] = attribute_key[static_cast<arch_t>(type)];
+				}
+			}
+			break;
+		}
+		case tmx::Layer::Type::Object: {
+			for (auto&& object : dynamic_cast<const tmx::ObjectGroup*>(layer.get())->getObjects()) {
+				const std::string& type = object.getType();
+				if (type == kMapActor) {
+					auto& recent = actors.emplace_back();
+					recent.name = object.getName();
+					recent.type = synao_hash(recent.name.c_str());
+					recent.position = tmx_convert::vec_to_vec(object.getPosition());
+					tmx_convert::prop_to_stats(
+						object.getProperties(),
+						recent.direction, recent.symbol,
+						recent.flags, recent.identity, recent.deterrent
+					);
+				} else if (type == kMapWater) {
+					liquids.push_back(tmx_convert::rect_to_rect(object.getAABB()));
+				}
+			}
+			break;
+		}
+		case tmx::Layer::Type::Image: {
+			auto& recent = backgrounds.emplace_back();
+			recent.texture = tmx_convert::path_to_name(dynamic_cast<const tmx::ImageLayer*>(layer.get())->getImagePath());
+			for (auto&& property : layer->getProperties()) {
+				auto& name = property.getName();
+				if (name == kBoundsXProp) {
+					recent.bounds.x = tmx_convert::prop_to_real(property);
+					recent.specified |= field_parallax_t::RectX;
+				} else if (name == kBoundsYProp) {
+					recent.bounds.y = tmx_convert::prop_to_real(property);
+					recent.specified |= field_parallax_t::RectY;
+				} else if (name == kBoundsWProp) {
+					recent.bounds.w = tmx_convert::prop_to_real(property);
+					recent.specified |= field_parallax_t::RectW;
+				} else if (name == kBoundsHProp) {
+					recent.bounds.h = tmx_convert::prop_to_real(property);
+					recent.specified |= field_parallax_t::RectH;
+				} else if (name == kScrollXProp) {
+					recent.scrolling.x = tmx_convert::prop_to_real(property);
+				} else if (name == kScrollYProp) {
+					recent.scrolling.y = tmx_convert::prop_to_real(property);
+				}
+			}
+			break;
+		}
+		default:
+			break;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,106 @@
+#ifndef LEVIATHAN_INCLUDED_FIELD_FIELD_FILE_HPP
+#define LEVIATHAN_INCLUDED_FIELD_FIELD_FILE_HPP
+
+#include <string>
+#include <vector>
+
+#include "../utility/rect.hpp"
+#include "../utility/enums.hpp"
+
+struct archive_blob_t;
+
+struct field_tiles_t {
+public:
+	field_tiles_t() :
+		priority(layer_value::TileBack),
+		tiles() {}
+	field_tiles_t(const field_tiles_t&) = default;
+	field_tiles_t& operator=(const field_tiles_t&) = default;
+	field_tiles_t(field_tiles_t&&) noexcept = default;
+	field_tiles_t& operator=(field_tiles_t&&) noexcept = default;
+	~field_tiles_t() = default;
+public:
+	layer_t priority;
+	std::vector<glm::ivec2> tiles;
+};
+
+struct field_parallax_t {
+public:
+	static constexpr arch_t RectX = 1 << 0;
+	static constexpr arch_t RectY = 1 << 1;
+	static constexpr arch_t RectW = 1 << 2;
+	static constexpr arch_t RectH = 1 << 3;
+public:
+	field_parallax_t() :
+		texture(),
+		specified(0),
+		bounds(),
+		scrolling(0.0f) {}
+	field_parallax_t(const field_parallax_t&) = default;
+	field_parallax_t& operator=(const field_parallax_t&) = default;
+	field_parallax_t(field_parallax_t&&) noexcept = default;
+	field_parallax_t& operator=(field_parallax_t&&) noexcept = default;
+	~field_parallax_t() = default;
+public:
+	std::string texture;
+	arch_t specified;
+	rect_t bounds;
+	glm::vec2 scrolling;
+};
+
+struct field_actor_t {
+public:
+	field_actor_t() :
+		type(0),
+		name(),
+		symbol(),
+		position(0.0f),
+		direction(direction_t::Right),
+		flags(0),
+		identity(0),
+		deterrent(0) {}
+	field_actor_t(const field_actor_t&) = default;
+	field_actor_t& operator=(const field_actor_t&) = default;
+	field_actor_t(field_actor_t&&) noexcept = default;
+	field_actor_t& operator=(field_actor_t&&) noexcept = default;
+	~field_actor_t() = default;
+public:
+	arch_t type;
+	std::string name, symbol;
+	glm::vec2 position;
+	direction_t direction;
+	arch_t flags;
+	sint_t identity;
+	arch_t deterrent;
+};
+
+// Everything setup_field needs from a map. It's read from the blob that
+// scripts/cook_fields.py writes when there is one, or else parsed out of the tmx file.
+struct field_file_t : public not_copyable_t {
+public:
+	field_file_t();
+	field_file_t(field_file_t&& that) noexcept;
+	field_file_t& operator=(field_file_t&& that) noexcept;
+	~field_file_t() = default;
+public:
+	bool load(const std::string& name);
+	void clear();
+	static bool exists(const std::string& name);
+public:
+	static constexpr uint32_t Magic = 0x444C464C;
+	static constexpr uint32_t Version = 1;
+private:
+	bool read(const archive_blob_t& blob);
+	bool parse(const archive_blob_t& blob);
+public:
+	rect_t bounds;
+	glm::ivec2 dimensions;
+	std::string tileset, palette;
+	std::vector<sint_t> attributes;
+	std::vector<field_tiles_t> tile_layers;
+	std::vector<field_parallax_t> backgrounds;
+	std::vector<field_actor_t> actors;
+	std::vector<rect_t> liquids;
+};
+
+#endif // LEVIATHAN_INCLUDED_FIELD_FIELD_FILE_HPP
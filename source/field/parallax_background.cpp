@@ -1,15 +1,8 @@
 #include "./parallax_background.hpp"
+#include "./field_file.hpp"
 
-#include "../utility/tmx_convert.hpp"
 #include "../system/renderer.hpp"
 
-static const byte_t kBoundsXProp[] = "rect.x";
-static const byte_t kBoundsYProp[] = "rect.y";
-static const byte_t kBoundsWProp[] = "rect.w";
-static const byte_t kBoundsHProp[] = "rect.h";
-static const byte_t kScrollXProp[] = "scroll.x";
-static const byte_t kScrollYProp[] = "scroll.y";
-
 parallax_background_t::parallax_background_t() :
 	indices(0),
 	position(0.0f),
@@ -41,30 +34,27 @@ parallax_background_t& parallax_background_t::operator=(parallax_background_t&&
 	return *this;
 }
 
-void parallax_background_t::init(const std::unique_ptr<tmx::Layer>& layer, glm::vec2 dimensions) {
+void parallax_background_t::init(const field_parallax_t& field_parallax, glm::vec2 dimensions) {
 	if (dimensions.x == 0.0f or dimensions.y == 0.0f) {
 		dimensions = glm::one<glm::vec2>();
 	}
 	this->dimensions = dimensions;
 	this->bounding = rect_t(0.0f, 0.0f, 1.0f, 1.0f);
+	this->scrolling = field_parallax.scrolling;
 	glm::vec2 inv = 1.0f / this->dimensions;
-	for (auto&& property : layer->getProperties()) {
-		auto& name = property.getName();
-		if (name == kBoundsXProp) {
-			this->bounding.x = tmx_convert::prop_to_real(property) * inv.x;
-		} else if (name == kBoundsYProp) {
-			this->bounding.y = tmx_convert::prop_to_real(property) * inv.y;
-		} else if (name == kBoundsWProp) {
-			this->dimensions.x = tmx_convert::prop_to_real(property);
-			this->bounding.w = this->dimensions.x * inv.x;
-		} else if (name == kBoundsHProp) {
-			this->dimensions.y = tmx_convert::prop_to_real(property);
-			this->bounding.h = this->dimensions.y * inv.y;
-		} else if (name == kScrollXProp) {
-			this->scrolling.x = tmx_convert::prop_to_real(property);
-		} else if (name == kScrollYProp) {
-			this->scrolling.y = tmx_convert::prop_to_real(property);
-		}
+	if (field_parallax.specified & field_parallax_t::RectX) {
+		this->bounding.x = field_parallax.bounds.x * inv.x;
+	}
+	if (field_parallax.specified & field_parallax_t::RectY) {
+		this->bounding.y = field_parallax.bounds.y * inv.y;
+	}
+	if (field_parallax.specified & field_parallax_t::RectW) {
+		this->dimensions.x = field_parallax.bounds.w;
+		this->bounding.w = this->dimensions.x * inv.x;
+	}
+	if (field_parallax.specified & field_parallax_t::RectH) {
+		this->dimensions.y = field_parallax.bounds.h;
+		this->bounding.h = this->dimensions.y * inv.y;
 	}
 }
 
@@ -0,0 +1,119 @@
+#include "./prefetch.hpp"
+#include "./field_file.hpp"
+
+#include "../event/receiver.hpp"
+#include "../utility/logger.hpp"
+#include "../utility/profiler.hpp"
+#include "../utility/vfs.hpp"
+
+#include <set>
+#include <cctype>
+#include <string_view>
+
+static const byte_t kSetFieldCall[] 	= "set_field(";
+static const byte_t kPlayCall[] 		= "play(";
+
+// Collects the string literal passed first to every call of the given function,
+// skipping calls whose name only ends with it, like display( for play(.
+static void scan_calls(std::string_view source, std::string_view call, std::set<std::string>& names) {
+	arch_t position = source.find(call);
+	while (position != std::string_view::npos) {
+		const byte_t prior = position > 0 ? source[position - 1] : ' ';
+		if (prior != '_' and !std::isalnum(static_cast<uint8_t>(prior))) {
+			arch_t first = source.find_first_not_of(" \t", position + call.size());
+			if (first != std::string_view::npos and source[first] == '"') {
+				arch_t last = source.find('"', first + 1);
+				if (last != std::string_view::npos) {
+					names.emplace(source.substr(first + 1, last - first - 1));
+				}
+			}
+		}
+		position = source.find(call, position + call.size());
+	}
+}
+
+// Every set_field call in a module is reachable from some door or event,
+// so collecting their first arguments is enough to find the neighbours.
+static void scan_script(const std::string& field, std::set<std::string>& names) {
+	const archive_blob_t blob = vfs::memory(vfs::event_path(field, rec_loading_t::None));
+	scan_calls(std::string_view{ blob.data(), blob.size() }, kSetFieldCall, names);
+}
+
+// Only noises the field's own events play by name can be found this way.
+// Actors play theirs through constants in code, which are shared by every field.
+static void scan_noises(const std::string& field, std::set<std::string>& names) {
+	const archive_blob_t blob = vfs::memory(vfs::event_path(field, rec_loading_t::None));
+	scan_calls(std::string_view{ blob.data(), blob.size() }, kPlayCall, names);
+}
+
+// Jobs only get a pointer to their field's name, and nothing is ever erased,
+// so the name outlives the job however long it waits in the background.
+static const std::string* keep_name(const std::string& name) {
+	static std::set<std::string> kept;
+	return &*kept.insert(name).first;
+}
+
+static void scan_actors(const field_file_t& field, std::set<std::string>& names) {
+	for (auto&& actor : field.actors) {
+		if (!actor.symbol.empty() and names.find(actor.symbol) == names.end() and field_file_t::exists(actor.symbol)) {
+			names.insert(actor.symbol);
+		}
+	}
+}
+
+void prefetch::neighbours(const std::string& name, const field_file_t& field) {
+	synao_zone("prefetch::neighbours");
+	job_system_t* jobs = vfs::jobs();
+	if (jobs == nullptr) {
+		return;
+	}
+	std::set<std::string> names;
+	scan_script(name, names);
+	scan_actors(field, names);
+	names.erase(name);
+	for (auto&& neighbour : names) {
+		synao_log("Prefetching neighbouring field \"%s\".\n", neighbour.c_str());
+		const std::string* kept = keep_name(neighbour);
+		jobs->push(job_priority_t::Background, nullptr, [kept] {
+			prefetch::field(*kept);
+		});
+	}
+}
+
+// Requests the same resources setup_field and tilemap_t would, but from a background
+// job, so everything they spawn is decoded at background priority ahead of time.
+// Actor sprites are only matched by name since routines pick their own animations.
+// Noises are the ones the field's events play by name.
+// Handles are dropped right away, so anything the next field doesn't claim stays evictable.
+void prefetch::field(const std::string& name) {
+	synao_zone("prefetch::field");
+	vfs::warm(vfs::event_path(name, rec_loading_t::None));
+	field_file_t field;
+	if (!field.load(name)) {
+		synao_warn(Field, "Couldn't prefetch field %s!\n", name.c_str());
+		return;
+	}
+	if (!field.palette.empty()) {
+		vfs::acquire_palette(field.palette);
+	}
+	if (!field.tileset.empty()) {
+		vfs::acquire_texture(field.tileset);
+	}
+	for (auto&& background : field.backgrounds) {
+		vfs::acquire_texture(background.texture);
+	}
+	const std::string sprite_path = vfs::resource_path(vfs_resource_path_t::Sprite);
+	for (auto&& actor : field.actors) {
+		if (vfs::contains(sprite_path + actor.name + ".anm") or vfs::contains(sprite_path + actor.name + ".cfg")) {
+			vfs::acquire_animation(actor.name);
+		}
+	}
+	std::set<std::string> noises;
+	scan_noises(name, noises);
+	const std::string noise_path = vfs::resource_path(vfs_resource_path_t::Noise);
+	for (auto&& noise : noises) {
+		if (vfs::contains(noise_path + noise + ".wav")) {
+			vfs::acquire_noise(noise);
+		}
+	}
+}
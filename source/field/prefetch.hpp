@@ -0,0 +1,15 @@
+#ifndef LEVIATHAN_INCLUDED_FIELD_PREFETCH_HPP
+#define LEVIATHAN_INCLUDED_FIELD_PREFETCH_HPP
+
+#include <string>
+
+#include "../types.hpp"
+
+struct field_file_t;
+
+namespace prefetch {
+	void neighbours(const std::string& name, const field_file_t& field);
+	void field(const std::string& name);
+}
+
+#endif // LEVIATHAN_INCLUDED_FIELD_PREFETCH_HPP
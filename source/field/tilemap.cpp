@@ -1,23 +1,17 @@
 #include "./tilemap.hpp"
 #include "./tileflag.hpp"
 #include "./camera.hpp"
+#include "./field_file.hpp"
 
 #include "../system/renderer.hpp"
 #include "../utility/vfs.hpp"
 #include "../utility/constants.hpp"
-#include "../utility/tmx_convert.hpp"
-
-#include <tmxlite/Map.hpp>
-#include <tmxlite/ImageLayer.hpp>
-
-static constexpr sint_t kScreenWidth  = 21;
-static constexpr sint_t kScreenHeight = 12;
+#include "../utility/profiler.hpp"
 
 tilemap_t::tilemap_t() :
 	amend(false),
 	dimensions(0),
 	attributes(),
-	attribute_key(),
 	previous_viewport(glm::zero<glm::vec2>(), constants::NormalDimensions<real_t>()),
 	tilemap_layer_texture(nullptr),
 	tilemap_layer_palette(nullptr),
@@ -44,6 +38,7 @@ void tilemap_t::reset() {
 }
 
 void tilemap_t::handle(const camera_t& camera) {
+	synao_zone("tilemap_t::handle");
 	rect_t viewport = camera.get_viewport();
 	for (auto&& background : backgrounds) {
 		background.handle(viewport);
@@ -85,59 +80,31 @@ void tilemap_t::render(renderer_t& renderer, rect_t viewport) const {
 	amend = false;
 }
 
-static const byte_t kPaletteProperty[] = "indexed";
-
-void tilemap_t::push_properties(const tmx::Map& tmxmap) {
-	const tmx::FloatRect bounds = tmxmap.getBounds();
-	dimensions = glm::ivec2(
-		glm::max(static_cast<sint_t>(bounds.width) / constants::TileSize<sint_t>(), kScreenWidth),
-		glm::max(static_cast<sint_t>(bounds.height) / constants::TileSize<sint_t>(), kScreenHeight)
-	);
-	attributes.resize(
-		static_cast<arch_t>(dimensions.x) *
-		static_cast<arch_t>(dimensions.y)
-	);
-	auto& tilesets = tmxmap.getTilesets();
-	if (!tilesets.empty()) {
-		auto& tileset = tilesets[0];
-		for (auto&& property : tileset.getProperties()) {
-			auto& name = property.getName();
-			if (name == kPaletteProperty) {
-				tilemap_layer_palette = vfs::palette(tileset.getName());
-			}
-		}
-		const std::string& name = tmx_convert::path_to_name(tileset.getImagePath());
-		tilemap_layer_texture = vfs::texture(name);
-		const std::string tilekey_path = vfs::resource_path(vfs_resource_path_t::TileKey);
-		attribute_key = vfs::sint_buffer(tilekey_path + name + ".atr");
-	}
-}
-
-void tilemap_t::push_tile_layer(const std::unique_ptr<tmx::Layer>& layer) {
+void tilemap_t::setup(const field_file_t& field) {
 	amend = true;
-	if (!attribute_key.empty()) {
-		glm::vec2 inverse = tilemap_layer_texture != nullptr ?
-			tilemap_layer_texture->get_inverse_dimensions() :
-			glm::zero<glm::vec2>();
-		auto& recent = tilemap_layers.emplace_back(dimensions);
-		recent.init(
-			layer,
-			inverse,
-			attributes,
-			attribute_key
-		);
+	dimensions = field.dimensions;
+	attributes = field.attributes;
+	if (!field.palette.empty()) {
+		tilemap_layer_palette = vfs::acquire_palette(field.palette);
 	}
-}
-
-void tilemap_t::push_parallax_background(const std::unique_ptr<tmx::Layer>& layer) {
-	amend = true;
-	const std::string& path = dynamic_cast<tmx::ImageLayer*>(layer.get())->getImagePath();
-	parallax_texture = vfs::texture(tmx_convert::path_to_name(path));
-	glm::vec2 parallax_dimensions = parallax_texture != nullptr ?
-		parallax_texture->get_dimensions() :
+	if (!field.tileset.empty()) {
+		tilemap_layer_texture = vfs::acquire_texture(field.tileset);
+	}
+	glm::vec2 inverse = tilemap_layer_texture != nullptr ?
+		tilemap_layer_texture->get_inverse_dimensions() :
 		glm::zero<glm::vec2>();
-	auto& recent = backgrounds.emplace_back();
-	recent.init(layer, parallax_dimensions);
+	for (auto&& tiles : field.tile_layers) {
+		auto& recent = tilemap_layers.emplace_back(dimensions);
+		recent.init(tiles, inverse);
+	}
+	for (auto&& background : field.backgrounds) {
+		parallax_texture = vfs::acquire_texture(background.texture);
+		glm::vec2 parallax_dimensions = parallax_texture != nullptr ?
+			parallax_texture->get_dimensions() :
+			glm::zero<glm::vec2>();
+		auto& recent = backgrounds.emplace_back();
+		recent.init(background, parallax_dimensions);
+	}
 }
 
 sint_t tilemap_t::get_attribute(sint_t x, sint_t y) const {
@@ -3,8 +3,10 @@
 
 #include "./parallax_background.hpp"
 #include "./tilemap_layer.hpp"
+#include "../utility/vfs_cache.hpp"
 
 struct camera_t;
+struct field_file_t;
 
 struct tilemap_t : public not_copyable_t {
 public:
@@ -16,9 +18,7 @@ public:
 	void reset();
 	void handle(const camera_t& camera);
 	void render(renderer_t& renderer, rect_t viewport) const;
-	void push_properties(const tmx::Map& tmxmap);
-	void push_tile_layer(const std::unique_ptr<tmx::Layer>& layer);
-	void push_parallax_background(const std::unique_ptr<tmx::Layer>& layer);
+	void setup(const field_file_t& field);
 	sint_t get_attribute(sint_t x, sint_t y) const;
 	sint_t get_attribute(glm::ivec2 index) const;
 public:
@@ -29,11 +29,11 @@ public:
 private:
 	mutable bool_t amend;
 	glm::ivec2 dimensions;
-	std::vector<sint_t> attributes, attribute_key;
+	std::vector<sint_t> attributes;
 	rect_t previous_viewport;
-	const texture_t* tilemap_layer_texture;
-	const palette_t* tilemap_layer_palette;
-	const texture_t* parallax_texture;
+	vfs_handle_t<texture_t> tilemap_layer_texture;
+	vfs_handle_t<palette_t> tilemap_layer_palette;
+	vfs_handle_t<texture_t> parallax_texture;
 	std::vector<parallax_background_t> backgrounds;
 	std::vector<tilemap_layer_t> tilemap_layers;
 };
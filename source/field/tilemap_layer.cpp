@@ -1,15 +1,12 @@
 #include "./tilemap_layer.hpp"
+#include "./field_file.hpp"
 
 #include "../utility/constants.hpp"
-#include "../utility/tmx_convert.hpp"
 #include "../system/renderer.hpp"
 
-#include <tmxlite/TileLayer.hpp>
+#include <algorithm>
 
 static constexpr arch_t kMinimumVerts = 21 * 13 * display_list_t::SingleQuad;
-static constexpr sint_t kInvalidTiles = -1;
-static constexpr byte_t kCollideLayer[] = "collide";
-static constexpr byte_t kPriorityType[] = "priority";
 
 tilemap_layer_t::tilemap_layer_t(glm::ivec2 map_size) : tilemap_layer_t() {
 	tiles.resize(
@@ -51,33 +48,14 @@ tilemap_layer_t& tilemap_layer_t::operator=(tilemap_layer_t&& that) noexcept {
 	return *this;
 }
 
-void tilemap_layer_t::init(const std::unique_ptr<tmx::Layer>& layer, glm::vec2 inverse_dimensions, std::vector<sint_t>& attributes, const std::vector<sint_t>& attribute_key) {
+void tilemap_layer_t::init(const field_tiles_t& field_tiles, glm::vec2 inverse_dimensions) {
 	if (inverse_dimensions.x == 0.0f or inverse_dimensions.y == 0.0f) {
 		inverse_dimensions = glm::one<glm::vec2>();
 	}
 	this->inverse_dimensions = inverse_dimensions;
-	bool colliding = false;
-	for (auto&& property : layer->getProperties()) {
-		auto& name = property.getName();
-		if (name == kCollideLayer) {
-			colliding = tmx_convert::prop_to_bool(property);
-			priority = layer_value::TileBack;
-		} else if (name == kPriorityType) {
-			if (tmx_convert::prop_to_bool(property)) {
-				priority = layer_value::TileFront;
-			}
-		}
-	}
-	auto& array = dynamic_cast<tmx::TileLayer*>(layer.get())->getTiles();
-	for (arch_t it = 0; it < array.size(); ++it) {
-		sint_t type = static_cast<sint_t>(array[it].ID) - 1;
-		tiles[it] = type >= 0 ?
-			glm::ivec2(type % constants::TileSize<sint_t>(), type / constants::TileSize<sint_t>()) :
-			glm::ivec2(kInvalidTiles);
-		if (colliding and type >= 0) {
-			attributes[it] = attribute_key[type];
-		}
-	}
+	priority = field_tiles.priority;
+	const arch_t length = std::min(tiles.size(), field_tiles.tiles.size());
+	std::copy(field_tiles.tiles.begin(), field_tiles.tiles.begin() + length, tiles.begin());
 }
 
 void tilemap_layer_t::handle(arch_t range, glm::ivec2 first, glm::ivec2 last, glm::ivec2 map_size) {
@@ -1,15 +1,13 @@
 #ifndef LEVIATHAN_INCLUDED_FIELD_TILEMAP_LAYER_HPP
 #define LEVIATHAN_INCLUDED_FIELD_TILEMAP_LAYER_HPP
 
-#include <memory>
-#include <tmxlite/Layer.hpp>
-
 #include "../utility/enums.hpp"
 #include "../video/vertex_pool.hpp"
 
 struct texture_t;
 struct palette_t;
 struct renderer_t;
+struct field_tiles_t;
 
 struct tilemap_layer_t : public not_copyable_t {
 public:
@@ -19,7 +17,7 @@ public:
 	tilemap_layer_t& operator=(tilemap_layer_t&& that) noexcept/*= default */;
 	~tilemap_layer_t() = default;
 public:
-	void init(const std::unique_ptr<tmx::Layer>& layer, glm::vec2 inverse_dimensions, std::vector<sint_t>& attributes, const std::vector<sint_t>& attribute_key);
+	void init(const field_tiles_t& field_tiles, glm::vec2 inverse_dimensions);
 	void handle(arch_t range, glm::ivec2 first, glm::ivec2 last, glm::ivec2 map_size);
 	void render(renderer_t& renderer, bool_t amend, const texture_t* texture, const palette_t* palette) const;
 private:
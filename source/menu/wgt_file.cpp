@@ -30,10 +30,10 @@ void wgt_file_t::init(const input_t&, const video_t&, audio_t&, const music_t&,
 	text.set_font(vfs::font(0));
 	text.set_position(kDefaultPosition);
 	if (bitmask[0]) {
-		text.set_string(vfs::i18n_find("FileSys", 0));
-		text.append_string(vfs::i18n_find("FileSys", 2, 4));
+		text.set_string(vfs::i18n_utf32("FileSys", 0));
+		text.append_string(vfs::i18n_utf32("FileSys", 2, 4));
 	} else {
-		text.set_string(vfs::i18n_find("FileSys", 1, 4));
+		text.set_string(vfs::i18n_utf32("FileSys", 1, 4));
 	}
 	arrow.set_file(vfs::animation(res::anim::Heads));
 	arrow.set_state(1);
@@ -32,7 +32,7 @@ void wgt_input_t::init(const input_t& input, const video_t&, audio_t&, const mus
 	ready = true;
 	header.set_font(vfs::font(0));
 	header.set_position(kDefaultPosition);
-	header.set_string(vfs::i18n_find("Input", 0));
+	header.set_string(vfs::i18n_utf32("Input", 0));
 	left_text.set_font(vfs::font(4));
 	left_text.set_position(kDefaultPosition + kAddingPositions);
 	right_text.set_font(vfs::font(4));
@@ -114,7 +114,7 @@ void wgt_language_t::invalidate() const {
 }
 
 void wgt_language_t::setup_text() {
-	text.set_string(vfs::i18n_find("Language", 0));
+	text.set_string(vfs::i18n_utf32("Language", 0));
 	for (arch_t it = first; it < languages.size() and it != last; ++it) {
 		text.append_string("\t " + languages[it] + '\n');
 	}
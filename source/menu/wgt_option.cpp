@@ -27,7 +27,7 @@ void wgt_option_t::init(const input_t&, const video_t&, audio_t& audio, const mu
 	kernel.freeze();
 	text.set_font(vfs::font(0));
 	text.set_position(kDefaultPosition);
-	text.set_string(vfs::i18n_find("Options", 0, 7));
+	text.set_string(vfs::i18n_utf32("Options", 0, 7));
 	arrow.set_file(vfs::animation(res::anim::Heads));
 	arrow.set_state(1);
 	arrow.set_position(
@@ -17,7 +17,8 @@ draw_headsup_t::draw_headsup_t() :
 	oxygen_count(),
 	item_view(),
 	fight_meter(),
-	fade()
+	fade(),
+	perf()
 #ifdef LEVIATHAN_BUILD_DEBUG
 	,hidden()
 #endif
@@ -91,6 +92,7 @@ void draw_headsup_t::handle(const kernel_t& kernel) {
 void draw_headsup_t::update(real64_t delta) {
 	main_scheme.update(delta);
 	fight_meter.update(delta);
+	perf.update(delta);
 #ifdef LEVIATHAN_BUILD_DEBUG
 	hidden.update(delta);
 #endif
@@ -118,6 +120,7 @@ void draw_headsup_t::render(renderer_t& renderer, const kernel_t& kernel) const
 	if (fade.is_visible()) {
 		fade.render(renderer);
 	}
+	perf.render(renderer);
 #ifdef LEVIATHAN_BUILD_DEBUG
 	hidden.render(renderer);
 #endif
@@ -142,6 +145,29 @@ void draw_headsup_t::set_fight_values(sint_t current, sint_t maximum) {
 	}
 #endif
 
+// Debug font is only loaded once the panel is asked for, so release builds don't pay for it.
+void draw_headsup_t::set_perf_visible(bool_t visible) {
+	if (visible) {
+		const font_t* font = vfs::debug_font();
+		if (font == nullptr) {
+			synao_log("Could not load debug font!\n");
+			return;
+		}
+		perf.init(font);
+	}
+	perf.set_visible(visible);
+}
+
+bool draw_headsup_t::is_perf_visible() const {
+	return perf.is_visible();
+}
+
+void draw_headsup_t::push_frame_sample(const frame_sample_t& sample) {
+	if (perf.is_visible()) {
+		perf.push(sample);
+	}
+}
+
 void draw_headsup_t::fade_in() {
 	fade.fade_in();
 	std::invoke(suspender);
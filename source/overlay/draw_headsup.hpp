@@ -10,6 +10,7 @@
 #include "./draw_item_view.hpp"
 #include "./draw_meter.hpp"
 #include "./draw_hidden.hpp"
+#include "./draw_perf.hpp"
 
 struct input_t;
 struct audio_t;
@@ -55,6 +56,9 @@ public:
 #ifdef LEVIATHAN_BUILD_DEBUG
 	void set_hidden_state(draw_hidden_state_t state, std::function<sint_t()> radio);
 #endif
+	void set_perf_visible(bool_t visible);
+	bool is_perf_visible() const;
+	void push_frame_sample(const frame_sample_t& sample);
 	void fade_in();
 	void fade_out();
 	bool is_fade_done() const;
@@ -69,6 +73,7 @@ private:
 	draw_item_view_t item_view;
 	draw_meter_t fight_meter;
 	draw_fade_t fade;
+	draw_perf_t perf;
 #ifdef LEVIATHAN_BUILD_DEBUG
 	draw_hidden_t hidden;
 #endif
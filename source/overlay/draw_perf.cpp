@@ -0,0 +1,148 @@
+#include "./draw_perf.hpp"
+
+#include "../system/renderer.hpp"
+#include "../utility/vfs.hpp"
+
+#include <cstdio>
+
+static constexpr real64_t kTextDelay = 0.25;
+static constexpr real64_t kGraphCeiling = 1.0 / 20.0;
+static constexpr real64_t kFrameBudget = 1.0 / 60.0;
+static constexpr real_t kPanelX = 196.0f;
+static constexpr real_t kPanelY = 2.0f;
+static constexpr real_t kGraphHeight = 30.0f;
+static constexpr real_t kTextHeight = 50.0f;
+
+// Memory budgets are configured in megabytes, so residency is shown the same way.
+static real64_t resident_megabytes(vfs_budget_t budget) {
+	return static_cast<real64_t>(vfs::resident(budget)) / (1024.0 * 1024.0);
+}
+
+draw_perf_t::draw_perf_t() :
+	amend(true),
+	visible(false),
+	timer(0.0),
+	stats(),
+	text()
+{
+
+}
+
+void draw_perf_t::init(const font_t* font) {
+	text.set_font(font);
+	text.set_layer(layer_value::Invisible);
+	text.set_position(kPanelX + 2.0f, kPanelY + kGraphHeight + 2.0f);
+}
+
+void draw_perf_t::update(real64_t delta) {
+	if (visible) {
+		timer += delta;
+		if (timer >= kTextDelay) {
+			timer = glm::mod(timer, kTextDelay);
+			this->generate();
+		}
+	}
+}
+
+void draw_perf_t::render(renderer_t& renderer) const {
+	if (!visible) {
+		return;
+	}
+	auto& list = renderer.get_overlay_quads(
+		layer_value::Invisible,
+		blend_mode_t::Alpha,
+		buffer_usage_t::Dynamic,
+		pipeline_t::VtxBlankColors
+	);
+	if (amend) {
+		amend = false;
+		const rect_t backing = rect_t(
+			kPanelX, kPanelY,
+			static_cast<real_t>(frame_stats_t::HistoryLength),
+			kGraphHeight + kTextHeight
+		);
+		list.begin(display_list_t::SingleQuad)
+			.vtx_blank_write(backing, glm::vec4(0.0f, 0.0f, 0.0f, 0.5f))
+			.vtx_transform_write(backing.left_top())
+		.end();
+		// One bar per frame, oldest on the left. Bars over budget turn yellow, then red.
+		for (arch_t it = 0; it < frame_stats_t::HistoryLength; ++it) {
+			real64_t frame = stats.at(it);
+			real_t height = static_cast<real_t>(glm::min(frame / kGraphCeiling, 1.0)) * kGraphHeight;
+			glm::vec4 color = frame <= kFrameBudget * 1.05 ?
+				glm::vec4(0.0f, 1.0f, 0.0f, 1.0f) :
+				frame <= kFrameBudget * 2.0 ?
+				glm::vec4(1.0f, 1.0f, 0.0f, 1.0f) :
+				glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+			const rect_t bar = rect_t(
+				kPanelX + static_cast<real_t>(it),
+				kPanelY + kGraphHeight - height,
+				1.0f, height
+			);
+			list.begin(display_list_t::SingleQuad)
+				.vtx_blank_write(bar, color)
+				.vtx_transform_write(bar.left_top())
+			.end();
+		}
+	} else {
+		list.skip((frame_stats_t::HistoryLength + 1) * display_list_t::SingleQuad);
+	}
+	text.render(renderer);
+}
+
+void draw_perf_t::invalidate() const {
+	amend = true;
+	text.invalidate();
+}
+
+void draw_perf_t::push(const frame_sample_t& sample) {
+	stats.push(sample);
+	amend = true;
+}
+
+void draw_perf_t::set_visible(bool_t visible) {
+	this->visible = visible;
+	amend = true;
+	timer = 0.0;
+	stats.clear();
+	text.clear();
+}
+
+bool draw_perf_t::is_visible() const {
+	return visible;
+}
+
+void draw_perf_t::generate() {
+	if (stats.size() == 0) {
+		return;
+	}
+	const frame_sample_t& latest = stats.latest();
+	byte_t buffer[256];
+	std::snprintf(
+		buffer, sizeof(buffer),
+		"p50 %.1f p99 %.1f max %.1f\n"
+		"upd %.2f hnd %.2f rnd %.2f\n"
+		"steps %zu up %zuK st %zuK\n"
+		"ents %zu miss %zu dc %zu/%zu\n"
+		"mem t%.1fM p%.1fM a%.1fM n%.1fM f%.1fM",
+		stats.percentile(0.5) * 1000.0,
+		stats.percentile(0.99) * 1000.0,
+		stats.maximum() * 1000.0,
+		latest.stages[frame_stage_t::Update] * 1000.0,
+		latest.stages[frame_stage_t::Handle] * 1000.0,
+		latest.stages[frame_stage_t::Render] * 1000.0,
+		latest.iterations,
+		latest.uploads / 1024,
+		latest.streamed / 1024,
+		latest.entities,
+		latest.missed,
+		latest.calls,
+		latest.unbatched,
+		resident_megabytes(vfs_budget_t::Texture),
+		resident_megabytes(vfs_budget_t::Palette),
+		resident_megabytes(vfs_budget_t::Animation),
+		resident_megabytes(vfs_budget_t::Noise),
+		resident_megabytes(vfs_budget_t::Font)
+	);
+	text.set_string(buffer);
+}
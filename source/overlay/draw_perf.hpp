@@ -0,0 +1,32 @@
+#ifndef LEVIATHAN_INCLUDED_OVERLAY_DRAW_PERF_HPP
+#define LEVIATHAN_INCLUDED_OVERLAY_DRAW_PERF_HPP
+
+#include "./draw_text.hpp"
+
+#include "../utility/frame_stats.hpp"
+
+struct draw_perf_t : public not_copyable_t {
+public:
+	draw_perf_t();
+	draw_perf_t(draw_perf_t&&) = default;
+	draw_perf_t& operator=(draw_perf_t&&) = default;
+	~draw_perf_t() = default;
+public:
+	void init(const font_t* font);
+	void update(real64_t delta);
+	void render(renderer_t& renderer) const;
+	void invalidate() const;
+	void push(const frame_sample_t& sample);
+	void set_visible(bool_t visible);
+	bool is_visible() const;
+private:
+	void generate();
+private:
+	mutable bool_t amend;
+	bool_t visible;
+	real64_t timer;
+	frame_stats_t stats;
+	draw_text_t text;
+};
+
+#endif // LEVIATHAN_INCLUDED_OVERLAY_DRAW_PERF_HPP
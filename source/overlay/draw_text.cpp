@@ -62,25 +62,33 @@ void draw_text_t::set_font(const font_t* font) {
 	this->font = font;
 }
 
-void draw_text_t::set_string(std::string words, bool immediate) {
+void draw_text_t::set_string(std::string_view words, bool immediate) {
 	buffer.clear();
-	vfs::to_utf32(
-		words.begin(),
-		words.end(),
-		std::back_inserter(buffer)
-	);
+	vfs::to_utf32(words, std::back_inserter(buffer));
 	if (immediate or current > buffer.size()) {
 		current = buffer.size();
 	}
 	this->generate();
 }
 
-void draw_text_t::append_string(std::string words, bool immediate) {
-	vfs::to_utf32(
-		words.begin(),
-		words.end(),
-		std::back_inserter(buffer)
-	);
+void draw_text_t::set_string(std::u32string_view words, bool immediate) {
+	buffer.assign(words.begin(), words.end());
+	if (immediate or current > buffer.size()) {
+		current = buffer.size();
+	}
+	this->generate();
+}
+
+void draw_text_t::append_string(std::string_view words, bool immediate) {
+	vfs::to_utf32(words, std::back_inserter(buffer));
+	if (immediate or current > buffer.size()) {
+		current = buffer.size();
+	}
+	this->generate();
+}
+
+void draw_text_t::append_string(std::u32string_view words, bool immediate) {
+	buffer.append(words.begin(), words.end());
 	if (immediate or current > buffer.size()) {
 		current = buffer.size();
 	}
@@ -190,23 +198,28 @@ void draw_text_t::generate() {
 		glm::vec2 start_dim = font->get_dimensions();
 		glm::vec2 start_inv = font->get_inverse_dimensions();
 		real_t table = font->convert_table(params);
+		char32_t previous = 0;
 		for (arch_t it = 0, qindex = 0; it < current; ++it, ++qindex) {
 			char32_t& c = buffer[it];
 			switch (c) {
 			case U'\t': {
 				const font_glyph_t& glyph = font->glyph(U' ');
 				start_pos.x += glyph.w * 4.0f;
+				previous = 0;
 				--qindex;
 				break;
 			}
 			case U'\n': {
 				start_pos.x = (position - origin).x;
 				start_pos.y += start_dim.y;
+				previous = 0;
 				--qindex;
 				break;
 			}
 			default: {
 				const font_glyph_t& glyph = font->glyph(c);
+				start_pos.x += font->kerning(previous, c);
+				previous = c;
 				vtx_major_t* quad = quads.at<vtx_major_t>(qindex * display_list_t::SingleQuad);
 
 				quad[0].position = glm::vec2(start_pos.x + glyph.x_offset, start_pos.y + glyph.y_offset);
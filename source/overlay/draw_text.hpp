@@ -2,6 +2,7 @@
 #define LEVIATHAN_INCLUDED_OVERLAY_DRAW_TEXT_HPP
 
 #include <string>
+#include <string_view>
 
 #include "../utility/rect.hpp"
 #include "../utility/enums.hpp"
@@ -23,8 +24,10 @@ public:
 	void increment();
 	void render(renderer_t& renderer) const;
 	void set_font(const font_t* font);
-	void set_string(std::string words, bool immediate = true);
-	void append_string(std::string words, bool immediate = true);
+	void set_string(std::string_view words, bool immediate = true);
+	void set_string(std::u32string_view words, bool immediate = true);
+	void append_string(std::string_view words, bool immediate = true);
+	void append_string(std::u32string_view words, bool immediate = true);
 	void set_params(real_t params);
 	void set_position(glm::vec2 position);
 	void set_position(real_t x, real_t y);
@@ -151,6 +151,95 @@ std::string pipeline::major_vert(glm::ivec2 version) {
 	return kMajorVert330;
 }
 
+static constexpr byte_t kSpriteVert420[] = R"(
+#version 420 core
+layout(binding = 0, std140) uniform transforms {
+	mat4 viewport;
+	vec2 dimensions;
+	vec2 resolution;
+};
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 extent;
+layout(location = 2) in vec4 texcoords;
+layout(location = 3) in vec2 scale;
+layout(location = 4) in vec2 axis;
+layout(location = 5) in vec3 params;
+out STAGE {
+	layout(location = 0) vec3 uvcoords;
+	layout(location = 1) float alpha;
+} vs;
+void main() {
+	vec2 corner = vec2(float((gl_VertexID >> 1) & 1), float(gl_VertexID & 1));
+	vec2 offset = corner * extent * scale - axis;
+	float c = cos(params.x);
+	float s = sin(params.x);
+	vec2 turned = vec2(offset.x * c - offset.y * s, offset.x * s + offset.y * c);
+	gl_Position = viewport * vec4(position + axis + turned, 0.0f, 1.0f);
+	vs.uvcoords = vec3(mix(texcoords.xy, texcoords.zw, corner), params.y);
+	vs.alpha = params.z;
+})";
+
+static constexpr byte_t kSpriteVert330[] = R"(
+#version 330 core
+layout(std140) uniform transforms {
+	mat4 viewport;
+	vec2 dimensions;
+	vec2 resolution;
+};
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 extent;
+layout(location = 2) in vec4 texcoords;
+layout(location = 3) in vec2 scale;
+layout(location = 4) in vec2 axis;
+layout(location = 5) in vec3 params;
+out STAGE {
+	vec3 uvcoords;
+	float alpha;
+} vs;
+void main() {
+	vec2 corner = vec2(float((gl_VertexID >> 1) & 1), float(gl_VertexID & 1));
+	vec2 offset = corner * extent * scale - axis;
+	float c = cos(params.x);
+	float s = sin(params.x);
+	vec2 turned = vec2(offset.x * c - offset.y * s, offset.x * s + offset.y * c);
+	gl_Position = viewport * vec4(position + axis + turned, 0.0f, 1.0f);
+	vs.uvcoords = vec3(mix(texcoords.xy, texcoords.zw, corner), params.y);
+	vs.alpha = params.z;
+})";
+
+static constexpr byte_t kSpriteVertGLES[] = R"(
+#version 330 core
+layout(binding = 0, std140) uniform transforms {
+	mat4 viewport;
+	vec2 dimensions;
+	vec2 resolution;
+};
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 extent;
+layout(location = 2) in vec4 texcoords;
+layout(location = 3) in vec2 scale;
+layout(location = 4) in vec2 axis;
+layout(location = 5) in vec3 params;
+layout(location = 0) out vec3 vs_uvcoords;
+layout(location = 1) out float vs_alpha;
+void main() {
+	vec2 corner = vec2(float((gl_VertexID >> 1) & 1), float(gl_VertexID & 1));
+	vec2 offset = corner * extent * scale - axis;
+	float c = cos(params.x);
+	float s = sin(params.x);
+	vec2 turned = vec2(offset.x * c - offset.y * s, offset.x * s + offset.y * c);
+	gl_Position = viewport * vec4(position + axis + turned, 0.0f, 1.0f);
+	vs_uvcoords = vec3(mix(texcoords.xy, texcoords.zw, corner), params.y);
+	vs_alpha = params.z;
+})";
+
+std::string pipeline::sprite_vert(glm::ivec2 version) {
+	if (version[0] == 4 and version[1] >= 2) {
+		return kSpriteVert420;
+	}
+	return kSpriteVert330;
+}
+
 static constexpr byte_t kColorsFrag420[] = R"(
 #version 420 core
 in STAGE {
@@ -280,6 +369,50 @@ std::string pipeline::indexed_frag(glm::ivec2 version) {
 	return kIndexedFrag330;
 }
 
+static constexpr byte_t kAtlasFrag420[] = R"(
+#version 420 core
+layout(binding = 0) uniform sampler2DArray diffuse_map;
+in STAGE {
+	layout(location = 0) vec3 uvcoords;
+	layout(location = 1) float alpha;
+} fs;
+layout(location = 0) out vec4 fragment;
+void main() {
+	vec4 color = texture(diffuse_map, fs.uvcoords);
+	fragment = vec4(color.rgb, color.a * fs.alpha);
+})";
+
+static constexpr byte_t kAtlasFrag330[] = R"(
+#version 330 core
+uniform sampler2DArray diffuse_map;
+in STAGE {
+	vec3 uvcoords;
+	float alpha;
+} fs;
+layout(location = 0) out vec4 fragment;
+void main() {
+	vec4 color = texture(diffuse_map, fs.uvcoords);
+	fragment = vec4(color.rgb, color.a * fs.alpha);
+})";
+
+static constexpr byte_t kAtlasFragGLES[] = R"(
+#version 330 core
+layout(binding = 0) uniform sampler2DArray diffuse_map;
+layout(location = 0) in vec3 fs_uvcoords;
+layout(location = 1) in float fs_alpha;
+layout(location = 0) out vec4 fragment;
+void main() {
+	vec4 color = texture(diffuse_map, fs_uvcoords);
+	fragment = vec4(color.rgb, color.a * fs_alpha);
+})";
+
+std::string pipeline::atlas_frag(glm::ivec2 version) {
+	if (version[0] == 4 and version[1] >= 2) {
+		return kAtlasFrag420;
+	}
+	return kAtlasFrag330;
+}
+
 static constexpr byte_t kLightingFrag420[] = R"({
 #version 420 core
 struct Light {
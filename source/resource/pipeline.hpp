@@ -10,6 +10,10 @@ namespace __enum_pipeline {
 		VtxBlankColors,
 		VtxMajorSprites,
 		VtxMajorIndexed,
+		VtxMajorAtlas,
+		VtxSpriteSprites,
+		VtxSpriteIndexed,
+		VtxSpriteAtlas,
 		Total
 	};
 }
@@ -20,9 +24,11 @@ namespace pipeline {
 	std::string minor_vert(glm::ivec2 version);
 	std::string blank_vert(glm::ivec2 version);
 	std::string major_vert(glm::ivec2 version);
+	std::string sprite_vert(glm::ivec2 version);
 	std::string colors_frag(glm::ivec2 version);
 	std::string sprites_frag(glm::ivec2 version);
 	std::string indexed_frag(glm::ivec2 version);
+	std::string atlas_frag(glm::ivec2 version);
 	std::string lighting_frag(glm::ivec2 version);
 }
 
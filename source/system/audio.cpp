@@ -11,6 +11,7 @@ static constexpr arch_t kSoundChannels = 12;
 audio_t::audio_t() :
 	tasks(),
 	channels(kSoundChannels),
+	bound(kSoundChannels),
 	engine(nullptr),
 	context(nullptr)
 {
@@ -20,6 +21,7 @@ audio_t::audio_t() :
 audio_t::~audio_t() {
 	tasks.clear();
 	channels.clear();
+	bound.clear();
 	if (context != nullptr) {
 		alcMakeContextCurrent(nullptr);
 		alcDestroyContext(reinterpret_cast<ALCcontext*>(context));
@@ -68,12 +70,30 @@ bool audio_t::init(const setup_file_t& config) {
 	return true;
 }
 
+// Without channels every play request is dropped before it reaches OpenAL.
+bool audio_t::init_headless(const setup_file_t&) {
+	if (engine != nullptr) {
+		synao_log("OpenAL engine already exists!\n");
+		return false;
+	}
+	if (context != nullptr) {
+		synao_log("OpenAL context already exists!\n");
+		return false;
+	}
+	channels.clear();
+	bound.clear();
+	synao_log("Audio system initialized without a device.\n");
+	return true;
+}
+
+// Each channel holds on to the last noise attached to it, so only noises
+// no channel can play anymore are left for eviction.
 void audio_t::flush() {
 	if (!tasks.empty()) {
 		for (auto&& task : tasks) {
 			auto& channel = channels[task.first];
 			if (channel.attach(task.second)) {
-				task.second = nullptr;
+				bound[task.first] = std::move(task.second);
 				channel.play();
 			}
 		}
@@ -86,7 +106,7 @@ void audio_t::flush() {
 
 void audio_t::play(const tbl_entry_t& entry, arch_t index) {
 	if (index < channels.size()) {
-		tasks.emplace_back(index, vfs::noise(entry));
+		tasks.emplace_back(index, vfs::acquire_noise(entry));
 	}
 }
 
@@ -95,7 +115,7 @@ void audio_t::play(const tbl_entry_t& entry) {
 		if (!channel.playing()) {
 			tasks.emplace_back(
 				std::distance(&channels[0], &channel),
-				vfs::noise(entry)
+				vfs::acquire_noise(entry)
 			);
 			break;
 		}
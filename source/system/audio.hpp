@@ -5,11 +5,12 @@
 #include <vector>
 
 #include "../audio/channel.hpp"
+#include "../utility/vfs_cache.hpp"
 
 struct tbl_entry_t;
 struct setup_file_t;
 
-using audio_task_t = std::pair<arch_t, const noise_t*>;
+using audio_task_t = std::pair<arch_t, vfs_handle_t<noise_t> >;
 
 struct audio_t : public not_copyable_t {
 public:
@@ -19,6 +20,7 @@ public:
 	~audio_t();
 public:
 	bool init(const setup_file_t& config);
+	bool init_headless(const setup_file_t& config);
 	void flush();
 	void play(const tbl_entry_t& entry, arch_t index);
 	void play(const tbl_entry_t& entry);
@@ -31,6 +33,7 @@ public:
 private:
 	std::vector<audio_task_t> tasks;
 	std::vector<channel_t> channels;
+	std::vector<vfs_handle_t<noise_t> > bound;
 	optr_t engine, context;
 };
 
@@ -4,10 +4,15 @@
 #include "../utility/setup_file.hpp"
 
 #include <functional>
+#include <fstream>
 
 static constexpr sint_t kRecordNothings = -1;
 static constexpr sint_t kRecordKeyboard = -2;
 static constexpr sint_t kRecordJoystick = -3;
+static constexpr uint32_t kTraceMagic = 0x4352544C; // "LTRC"
+static constexpr uint32_t kTraceVersion = 1;
+
+static_assert(btn_t::Total * 2 <= 32, "Button states must fit inside one trace word!");
 
 input_t::input_t() :
 	pressed(0),
@@ -20,7 +25,12 @@ input_t::input_t() :
 	joy_bind(),
 	recorder(kRecordNothings),
 	position(0.0f),
-	joystick(nullptr)
+	joystick(nullptr),
+	trace_mode(trace_mode_t::None),
+	trace_path(),
+	trace_runs(),
+	trace_index(0),
+	trace_count(0)
 {
 
 }
@@ -386,6 +396,132 @@ btn_t input_t::set_joystick_binding(sint_t code, arch_t btn) {
 	return btn_t::Total;
 }
 
+// Trace files hold a small header followed by run-length encoded ticks.
+// Each run is a pair of words: the packed pressed/holding bits, then a tick count.
+bool input_t::record_trace(const std::string& path) {
+	if (trace_mode != trace_mode_t::None) {
+		synao_error(Input, "Input trace is already active!\n");
+		return false;
+	}
+	// Nothing is written until the trace ends, so check the path up front
+	// instead of losing a whole recording to it.
+	std::ofstream ofs(path, std::ofstream::binary);
+	if (!ofs.is_open()) {
+		synao_error(Input, "Failed to open input trace for recording: %s!\n", path.c_str());
+		return false;
+	}
+	trace_mode = trace_mode_t::Record;
+	trace_path = path;
+	trace_runs.clear();
+	trace_index = 0;
+	trace_count = 0;
+	synao_log("Recording input trace to \"%s\" with seed %llu.\n", path.c_str(), (unsigned long long)rng::get_seed());
+	return true;
+}
+
+bool input_t::replay_trace(const std::string& path) {
+	if (trace_mode != trace_mode_t::None) {
+		synao_error(Input, "Input trace is already active!\n");
+		return false;
+	}
+	std::ifstream ifs(path, std::ifstream::binary);
+	if (!ifs.is_open()) {
+		synao_error(Input, "Failed to open input trace: %s!\n", path.c_str());
+		return false;
+	}
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint64_t seed = 0;
+	ifs.read(reinterpret_cast<byte_t*>(&magic), sizeof(magic));
+	ifs.read(reinterpret_cast<byte_t*>(&version), sizeof(version));
+	ifs.read(reinterpret_cast<byte_t*>(&seed), sizeof(seed));
+	if (!ifs.good() or magic != kTraceMagic or version != kTraceVersion) {
+		synao_error(Input, "Input trace at %s is invalid!\n", path.c_str());
+		return false;
+	}
+	trace_runs.clear();
+	uint32_t word = 0;
+	while (ifs.read(reinterpret_cast<byte_t*>(&word), sizeof(word))) {
+		trace_runs.push_back(word);
+	}
+	if (trace_runs.size() % 2 != 0) {
+		trace_runs.pop_back();
+	}
+	rng::seed(seed);
+	trace_mode = trace_mode_t::Replay;
+	trace_path = path;
+	trace_index = 0;
+	trace_count = 0;
+	synao_log("Replaying input trace from \"%s\" with seed %llu.\n", path.c_str(), (unsigned long long)seed);
+	return true;
+}
+
+// Must be called once at the start of every simulation tick.
+void input_t::tick_trace() {
+	switch (trace_mode) {
+	case trace_mode_t::Record: {
+		uint32_t bits = static_cast<uint32_t>(
+			pressed.to_ulong() | (holding.to_ulong() << btn_t::Total)
+		);
+		if (!trace_runs.empty() and trace_runs[trace_runs.size() - 2] == bits) {
+			trace_runs.back()++;
+		} else {
+			trace_runs.push_back(bits);
+			trace_runs.push_back(1);
+		}
+		break;
+	}
+	case trace_mode_t::Replay: {
+		if (trace_index >= trace_runs.size()) {
+			pressed.reset();
+			holding.reset();
+			trace_mode = trace_mode_t::Finished;
+			synao_log("Input trace replay finished.\n");
+			break;
+		}
+		static constexpr uint32_t kMask = (1 << btn_t::Total) - 1;
+		uint32_t bits = trace_runs[trace_index];
+		pressed = std::bitset<btn_t::Total>(bits & kMask);
+		holding = std::bitset<btn_t::Total>((bits >> btn_t::Total) & kMask);
+		if (++trace_count >= trace_runs[trace_index + 1]) {
+			trace_index += 2;
+			trace_count = 0;
+		}
+		break;
+	}
+	default: {
+		break;
+	}
+	}
+}
+
+bool input_t::end_trace() {
+	if (trace_mode != trace_mode_t::Record) {
+		trace_mode = trace_mode_t::None;
+		return true;
+	}
+	trace_mode = trace_mode_t::None;
+	std::ofstream ofs(trace_path, std::ofstream::binary);
+	if (!ofs.is_open()) {
+		synao_error(Input, "Failed to save input trace to %s!\n", trace_path.c_str());
+		return false;
+	}
+	const uint64_t seed = rng::get_seed();
+	ofs.write(reinterpret_cast<const byte_t*>(&kTraceMagic), sizeof(kTraceMagic));
+	ofs.write(reinterpret_cast<const byte_t*>(&kTraceVersion), sizeof(kTraceVersion));
+	ofs.write(reinterpret_cast<const byte_t*>(&seed), sizeof(seed));
+	ofs.write(
+		reinterpret_cast<const byte_t*>(trace_runs.data()),
+		trace_runs.size() * sizeof(decltype(trace_runs)::value_type)
+	);
+	synao_log("Saved input trace with %zu runs.\n", trace_runs.size() / 2);
+	return true;
+}
+
+trace_mode_t input_t::get_trace_mode() const {
+	return trace_mode;
+}
+
 void input_t::all_key_bindings(const setup_file_t& config) {
 	sint_t jump		= SDL_SCANCODE_Z;
 	sint_t hammer	= SDL_SCANCODE_X;
@@ -3,6 +3,7 @@
 
 #include <bitset>
 #include <string>
+#include <vector>
 #include <map>
 
 #include <SDL2/SDL_scancode.h>
@@ -47,6 +48,17 @@ namespace __enum_btn {
 
 using btn_t = __enum_btn::type;
 
+namespace __enum_trace_mode {
+	enum type : arch_t {
+		None,
+		Record,
+		Replay,
+		Finished
+	};
+}
+
+using trace_mode_t = __enum_trace_mode::type;
+
 struct input_t : public not_copyable_t {
 public:
 	input_t();
@@ -70,6 +82,11 @@ public:
 	btn_t set_keyboard_binding(sint_t code, arch_t btn);
 	void set_joystick_recording();
 	btn_t set_joystick_binding(sint_t code, arch_t btn);
+	bool record_trace(const std::string& path);
+	bool replay_trace(const std::string& path);
+	void tick_trace();
+	bool end_trace();
+	trace_mode_t get_trace_mode() const;
 private:
 	void all_key_bindings(const setup_file_t& config);
 	void all_joy_bindings(const setup_file_t& config);
@@ -83,6 +100,11 @@ private:
 	sint_t recorder;
 	glm::vec2 position;
 	SDL_Joystick* joystick;
+	trace_mode_t trace_mode;
+	std::string trace_path;
+	std::vector<uint32_t> trace_runs;
+	arch_t trace_index;
+	uint32_t trace_count;
 };
 
 #endif // LEVIATHAN_INCLUDED_SYSTEM_INPUT_HPP
@@ -8,15 +8,47 @@
 
 #include "../utility/vfs.hpp"
 #include "../utility/constants.hpp"
+#include "../utility/frame_pacer.hpp"
+#include "../utility/frame_stats.hpp"
 #include "../utility/logger.hpp"
+#include "../utility/profiler.hpp"
+#include "../utility/rect.hpp"
 #include "../utility/setup_file.hpp"
+#include "../utility/startup_graph.hpp"
 
 #include <cstdlib>
 #include <cstring>
 #include <SDL2/SDL.h>
 
 static constexpr uint_t kStopDelay = 40;
-static constexpr uint_t kNormDelay = 10;
+static constexpr arch_t kStressFrames = 600;
+
+struct launch_params_t {
+public:
+	bool_t headless;
+	const byte_t* field;
+	arch_t tick_limit;
+	real64_t time_limit;
+	const byte_t* record_path;
+	const byte_t* replay_path;
+	const byte_t* seed;
+	const byte_t* profile_path;
+	arch_t stress_quads;
+public:
+	launch_params_t() :
+		headless(false),
+		field(nullptr),
+		tick_limit(0),
+		time_limit(0.0),
+		record_path(nullptr),
+		replay_path(nullptr),
+		seed(nullptr),
+		profile_path(nullptr),
+		stress_quads(0) {}
+	launch_params_t(const launch_params_t&) = default;
+	launch_params_t& operator=(const launch_params_t&) = default;
+	~launch_params_t() = default;
+};
 
 static std::string get_boot_path() {
 	const std::string init_path = vfs::resource_path(vfs_resource_path_t::Init);
@@ -26,11 +58,21 @@ static std::string get_boot_path() {
 static void write_default_config(setup_file_t& config, const std::string& boot_path) {
 	config.clear(boot_path);
 	config.set("Setup", "Language", std::string("english"));
+	config.set("Setup", "PerfPanel", 0);
+	config.set("Setup", "LogLevel", 0);
+	config.set("Setup", "LogFile", 0);
+	config.set("Setup", "SimulationThread", 1);
+	config.set("Setup", "JobThreads", 0);
 	config.set("Video", "VerticalSync", 0);
 	config.set("Video", "Fullscreen", 0);
 	config.set("Video", "ScaleFactor", 3);
 	config.set("Video", "FrameLimiter", 60);
 	config.set("Video", "UseOpenGL4", 1);
+	config.set("Video", "UploadBudget", 2048);
+	config.set("Video", "ProgramCache", 1);
+	config.set("Video", "AtlasPages", 4);
+	config.set("Video", "AtlasSize", 1024);
+	config.set("Video", "Instancing", 1);
 	config.set("Audio", "Volume", 1.0f);
 	config.set("Music", "Volume", 0.34f);
 	config.set("Music", "Channels", 2);
@@ -56,6 +98,12 @@ static void write_default_config(setup_file_t& config, const std::string& boot_p
 	config.set("Input", "JoyStrafe", 5);
 	config.set("Input", "JoyInventory",	6);
 	config.set("Input", "JoyOptions", 7);
+	config.set("Memory", "Texture", 64);
+	config.set("Memory", "Palette", 4);
+	config.set("Memory", "Animation", 4);
+	config.set("Memory", "Noise", 32);
+	config.set("Memory", "Staging", 16);
+	config.set("Memory", "Stream", 6);
 	const std::string init_path = vfs::resource_path(vfs_resource_path_t::Init);
 	if (!vfs::create_directory(init_path)) {
 		synao_log("Warning! Will not be able to save newly generated config file!\n");
@@ -71,79 +119,236 @@ static void load_config_file(setup_file_t& config) {
 	}
 }
 
-static bool run_naomi(setup_file_t& config, input_t& input, video_t& video, audio_t& audio, music_t& music, renderer_t& renderer) {
+// Seed has to be set before the runtime starts so the first field is reproducible.
+static bool start_input_trace(input_t& input, const launch_params_t& params) {
+	if (params.seed != nullptr) {
+		rng::seed(std::strtoull(params.seed, nullptr, 10));
+	}
+	if (params.replay_path != nullptr) {
+		return input.replay_trace(params.replay_path);
+	}
+	if (params.record_path != nullptr) {
+		return input.record_trace(params.record_path);
+	}
+	return true;
+}
+
+static bool run_naomi(setup_file_t& config, input_t& input, video_t& video, audio_t& audio, music_t& music, renderer_t& renderer, runtime_t& runtime, const watch_t& launch_watch) {
 	policy_t policy = policy_t::Run;
-	runtime_t runtime;
-	if (!runtime.init(input, audio, music, renderer)) {
-		synao_log("Runtime initialization failed!\n");
-		return false;
+	bool_t perf_panel = false;
+	config.get("Setup", "PerfPanel", perf_panel);
+	if (perf_panel) {
+		runtime.set_perf_visible(true);
 	}
+	bool_t simulation_thread = true;
+	config.get("Setup", "SimulationThread", simulation_thread);
 	synao_log("Entering main loop...\n");
-	watch_t sync_watch, head_watch;
+	frame_pacer_t pacer;
+	watch_t head_watch, stage_watch, frame_watch;
+	frame_sample_t sample;
+	bool_t first_frame = false;
 	while (policy != policy_t::Quit) {
 		policy = input.poll(policy);
 		if (policy != policy_t::Stop) {
+			stage_watch.restart();
 			runtime.update(head_watch.restart());
+			sample.stages[frame_stage_t::Update] = stage_watch.restart();
 			if (runtime.viable()) {
-				if (runtime.handle(config, input, video, audio, music, renderer)) {
+				bool running = true;
+				if (simulation_thread) {
+					// Submits the previous tick's snapshot while the next tick is simulated.
+					// The handle stage is only the time spent waiting for the simulation.
+					runtime.draw(renderer);
+					runtime.launch(config, input, video, audio, music, renderer);
+					runtime.present(video, renderer);
+					sample.stages[frame_stage_t::Render] = stage_watch.restart();
+					running = runtime.await();
+					video.apply_parameters();
+					sample.stages[frame_stage_t::Handle] = stage_watch.restart();
+				} else if (runtime.handle(config, input, video, audio, music, renderer)) {
+					sample.stages[frame_stage_t::Handle] = stage_watch.restart();
 					runtime.render(video, renderer);
+					sample.stages[frame_stage_t::Render] = stage_watch.restart();
+				} else {
+					running = false;
+				}
+				if (running) {
+					// Simulation is idle and the context is current, so nothing can be holding what gets evicted.
+					if (renderer.collect()) {
+						vfs::evict();
+					}
+					vfs::measure();
+					sample.frame = frame_watch.restart();
+					if (!first_frame) {
+						first_frame = true;
+						synao_info(General, "First frame presented %.2f ms after launch.\n", launch_watch.elapsed() * 1000.0);
+					}
+					sample.missed = pacer.get_missed();
+					sample.calls = renderer.get_draw_calls();
+					sample.unbatched = renderer.get_unbatched_calls();
+					runtime.push_frame_sample(sample);
+					// Swapping buffers already blocks when vertical sync is on.
 					const screen_params_t params = video.get_parameters();
 					if (params.vsync != 0) {
-						SDL_Delay(kNormDelay);
+						pacer.reset();
 					} else {
-						real64_t waiting = (1.0 / params.framerate) - sync_watch.elapsed();
-						if (waiting > 0.0) {
-							uint_t ticks = static_cast<uint_t>(waiting * 1000.0);
-							SDL_Delay(ticks);
-						}
-						sync_watch.restart();
+						pacer.wait(1.0 / params.framerate);
 					}
 				} else {
 					policy = policy_t::Quit;
 				}
+			} else {
+				pacer.reset();
 			}
 		} else {
 			SDL_Delay(kStopDelay);
+			pacer.reset();
 		}
 	}
-	return config.save();
+	const bool saved = input.end_trace();
+	return config.save() and saved;
 }
 
-static int proc_naomi(setup_file_t& config) {
+static int proc_naomi(setup_file_t& config, const launch_params_t& params, const watch_t& launch_watch) {
 	// Global input/video/audio devices are generated here...
 	input_t input;
+	video_t video;
+	audio_t audio;
+	// Global virtual filesystem device generated here.
+	// Accessible from anywhere in order to reduce headaches.
+	// Must destroy this before destroying video and audio devices.
+	vfs_t fs;
+	// Global music device is dependent on existance of audio device.
+	// Must destroy this before destroying audio device.
+	music_t music;
+	// Global renderer device is dependent on existance of virtual filesystem and audio devices.
+	// Must destroy this before destroying virtual filesystem and audio devices.
+	renderer_t renderer;
+	runtime_t runtime;
+	// Anything touching SDL, OpenGL or AngelScript stays on the main thread, the rest
+	// runs on job threads once the virtual filesystem has created them.
+	startup_graph_t startup{ launch_watch };
+	const arch_t vfs_step = startup.add("vfs", startup_thread_t::Main, {}, [&config, &fs] {
+		return fs.init_device(config);
+	});
+	const arch_t input_step = startup.add("input", startup_thread_t::Main, {}, [&config, &params, &input] {
+		return input.init(config) and start_input_trace(input, params);
+	});
+	const arch_t video_step = startup.add("video", startup_thread_t::Main, { input_step }, [&config, &video] {
+		return video.init(config);
+	});
+	const arch_t audio_step = startup.add("audio", startup_thread_t::Worker, { vfs_step }, [&config, &audio] {
+		return audio.init(config);
+	});
+	const arch_t language_step = startup.add("language", startup_thread_t::Worker, { vfs_step }, [&fs] {
+		return fs.init_language();
+	});
+	const arch_t music_step = startup.add("music", startup_thread_t::Worker, { audio_step }, [&config, &music] {
+		return music.init(config);
+	});
+	const arch_t renderer_step = startup.add("renderer", startup_thread_t::Main, { vfs_step, video_step }, [&config, &video, &renderer] {
+		return renderer.init(config, video.get_opengl_version());
+	});
+	const arch_t scripts_step = startup.add("scripts", startup_thread_t::Main, { vfs_step }, [&input, &audio, &music, &runtime] {
+		return runtime.init_scripts(input, audio, music);
+	});
+	const arch_t actors_step = startup.add("actors", startup_thread_t::Worker, { vfs_step }, [&runtime] {
+		return runtime.init_actors();
+	});
+	startup.add("runtime", startup_thread_t::Main, { language_step, music_step, renderer_step, scripts_step, actors_step }, [&audio, &renderer, &runtime] {
+		return runtime.init_state(audio, renderer);
+	});
+	const bool succeeded = startup.run();
+	startup.report();
+	if (!succeeded) {
+		synao_log("Runtime initialization failed!\n");
+		return EXIT_FAILURE;
+	}
+	if (!run_naomi(config, input, video, audio, music, renderer, runtime, launch_watch)) {
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
+// Reports go straight to stdout since benchmarks are normally run on release builds.
+static void report_headless(const std::string& field, arch_t ticks, real64_t seconds) {
+	real64_t rate = seconds > 0.0 ? static_cast<real64_t>(ticks) / seconds : 0.0;
+	std::printf(
+		"Field \"%s\": %zu ticks in %.3f seconds (%.1f ticks/sec)\n",
+		field.c_str(), ticks, seconds, rate
+	);
+}
+
+static bool run_headless(setup_file_t& config, input_t& input, video_t& video, audio_t& audio, music_t& music, renderer_t& renderer, const launch_params_t& params) {
+	runtime_t runtime;
+	if (!runtime.init(input, audio, music, renderer)) {
+		synao_log("Runtime initialization failed!\n");
+		return false;
+	}
+	if (params.field != nullptr) {
+		runtime.set_field(params.field);
+	}
+	synao_log("Entering headless loop...\n");
+	std::string current = runtime.get_field();
+	arch_t total_ticks = 0;
+	arch_t field_ticks = 0;
+	watch_t total_watch, field_watch;
+	while (params.tick_limit == 0 or total_ticks < params.tick_limit) {
+		if (params.time_limit > 0.0 and total_watch.elapsed() >= params.time_limit) {
+			break;
+		}
+		runtime.update(constants::MinInterval());
+		if (!runtime.handle(config, input, video, audio, music, renderer)) {
+			break;
+		}
+		if (input.get_trace_mode() == trace_mode_t::Finished) {
+			break;
+		}
+		++total_ticks;
+		++field_ticks;
+		if (current != runtime.get_field()) {
+			report_headless(current, field_ticks, field_watch.restart());
+			current = runtime.get_field();
+			field_ticks = 0;
+			// Nothing is ever drawn headless, so the field change alone is enough to evict at.
+			vfs::evict();
+		}
+	}
+	if (field_ticks > 0) {
+		report_headless(current, field_ticks, field_watch.elapsed());
+	}
+	report_headless("(total)", total_ticks, total_watch.elapsed());
+	return input.end_trace();
+}
+
+static int proc_headless(setup_file_t& config, const launch_params_t& params) {
+	// Null backends: no window, no OpenGL context, and no OpenAL device.
+	input_t input;
 	if (!input.init(config)) {
 		return EXIT_FAILURE;
 	}
+	if (!start_input_trace(input, params)) {
+		return EXIT_FAILURE;
+	}
 	video_t video;
-	if (!video.init(config)) {
+	if (!video.init_headless(config)) {
 		return EXIT_FAILURE;
 	}
 	audio_t audio;
-	if (!audio.init(config)) {
+	if (!audio.init_headless(config)) {
 		return EXIT_FAILURE;
 	}
-	// Global virtual filesystem device generated here.
-	// Accessible from anywhere in order to reduce headaches.
-	// Must destroy this before destroying video and audio devices.
 	vfs_t fs;
 	if (!fs.init(config)) {
 		return EXIT_FAILURE;
 	}
-	// Global music device is dependent on existance of audio device.
-	// Must destroy this before destroying audio device.
 	music_t music;
-	if (!music.init(config)) {
+	if (!music.init_headless(config)) {
 		return EXIT_FAILURE;
 	}
-	// Global renderer device is dependent on existance of virtual filesystem and audio devices.
-	// Must destroy this before destroying virtual filesystem and audio devices.
-	glm::ivec2 version = video.get_opengl_version();
+	// Renderer is never initialized or flushed, so its lists only collect vertices.
 	renderer_t renderer;
-	if (!renderer.init(version)) {
-		return EXIT_FAILURE;
-	}
-	if (!run_naomi(config, input, video, audio, music, renderer)) {
+	if (!run_headless(config, input, video, audio, music, renderer, params)) {
 		return EXIT_FAILURE;
 	}
 	return EXIT_SUCCESS;
@@ -157,7 +362,8 @@ static bool run_editor(input_t& input, video_t& video, renderer_t& renderer) {
 		return false;
 	}
 	synao_log("Entering main loop...\n");
-	watch_t sync_watch, head_watch;
+	frame_pacer_t pacer;
+	watch_t head_watch;
 	while (policy != policy_t::Quit) {
 		policy = input.poll(policy, editor_t::get_event_callback());
 		if (policy != policy_t::Stop) {
@@ -165,15 +371,11 @@ static bool run_editor(input_t& input, video_t& video, renderer_t& renderer) {
 			if (editor.viable()) {
 				editor.handle(input, renderer);
 				editor.render(video, renderer);
-				real64_t waiting = constants::MinInterval() - sync_watch.elapsed();
-				if (waiting > 0.0) {
-					uint_t ticks = static_cast<uint_t>(waiting * 1000.0);
-					SDL_Delay(ticks);
-				}
-				sync_watch.restart();
+				pacer.wait(constants::MinInterval());
 			}
 		} else {
 			SDL_Delay(kStopDelay);
+			pacer.reset();
 		}
 	}
 	return true;
@@ -195,7 +397,7 @@ static int proc_editor(setup_file_t& config) {
 	}
 	glm::ivec2 version = video.get_opengl_version();
 	renderer_t renderer;
-	if (!renderer.init(version)) {
+	if (!renderer.init(config, version)) {
 		return EXIT_FAILURE;
 	}
 	if (!run_editor(input, video, renderer)) {
@@ -204,6 +406,89 @@ static int proc_editor(setup_file_t& config) {
 	return EXIT_SUCCESS;
 }
 
+// Rewrites every quad each frame, so both streaming and chunked draws are measured.
+static bool run_stress(input_t& input, video_t& video, renderer_t& renderer, const launch_params_t& params) {
+	const arch_t frames = params.tick_limit > 0 ? params.tick_limit : kStressFrames;
+	const arch_t width = constants::NormalWidth<arch_t>();
+	const arch_t height = constants::NormalHeight<arch_t>();
+	synao_info(General, "Drawing %zu quads in one list for %zu frames...\n", params.stress_quads, frames);
+	policy_t policy = policy_t::Run;
+	frame_stats_t stats;
+	frame_sample_t sample;
+	arch_t streamed = 0;
+	arch_t uploaded = 0;
+	arch_t frame = 0;
+	watch_t frame_watch;
+	while (frame < frames and policy != policy_t::Quit) {
+		policy = input.poll(policy);
+		auto& list = renderer.get_overlay_quads(
+			layer_value::HeadsUp,
+			blend_mode_t::Alpha,
+			buffer_usage_t::Dynamic,
+			pipeline_t::VtxBlankColors
+		);
+		const glm::vec4 color = glm::vec4(
+			static_cast<real_t>(frame % 2), 1.0f,
+			static_cast<real_t>((frame + 1) % 2), 0.25f
+		);
+		for (arch_t it = 0; it < params.stress_quads; ++it) {
+			const rect_t quad = rect_t(
+				static_cast<real_t>(it % width),
+				static_cast<real_t>((it / width) % height),
+				1.0f, 1.0f
+			);
+			list.begin(display_list_t::SingleQuad)
+				.vtx_blank_write(quad, color)
+				.vtx_transform_write(quad.left_top())
+			.end();
+		}
+		renderer.flush(video.get_integral_dimensions());
+		video.flush();
+		streamed += frame_stats::take_stream_bytes();
+		uploaded += frame_stats::take_upload_bytes();
+		sample.frame = frame_watch.restart();
+		stats.push(sample);
+		++frame;
+	}
+	if (frame == 0) {
+		return false;
+	}
+	synao_info(
+		General, "Stress test: p50 %.2f ms p99 %.2f ms max %.2f ms, %zuK streamed and %zuK uploaded per frame\n",
+		stats.percentile(0.5) * 1000.0,
+		stats.percentile(0.99) * 1000.0,
+		stats.maximum() * 1000.0,
+		(streamed / frame) / 1024,
+		(uploaded / frame) / 1024
+	);
+	return true;
+}
+
+static int proc_stress(setup_file_t& config, const launch_params_t& params) {
+	config.set("Video", "VerticalSync", 0);
+	input_t input;
+	if (!input.init(config)) {
+		return EXIT_FAILURE;
+	}
+	video_t video;
+	if (!video.init(config)) {
+		return EXIT_FAILURE;
+	}
+	vfs_t fs;
+	if (!fs.init(config)) {
+		return EXIT_FAILURE;
+	}
+	glm::ivec2 version = video.get_opengl_version();
+	renderer_t renderer;
+	if (!renderer.init(config, version)) {
+		return EXIT_FAILURE;
+	}
+	if (!run_stress(input, video, renderer, params)) {
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
 static void print_version() {
 	synao_log("Leviathan Racket Version: 0.0.0.0\n");
 }
@@ -229,8 +514,11 @@ static bool attempt_mounting(const byte_t* provided_directory) {
 }
 
 int main(int argc, char** argv) {
+	// Startup timeline is measured from here
+	const watch_t launch_watch;
 	// Check arguments
 	const byte_t* directory = nullptr;
+	launch_params_t params;
 	bool_t tile_editor = false;
 	bool_t show_version = false;
 	for (sint_t it = 1; it < argc; ++it) {
@@ -239,17 +527,45 @@ int main(int argc, char** argv) {
 			show_version = true;
 		} else if (!tile_editor and std::strcmp(option, "--editor") == 0) {
 			tile_editor = true;
+		} else if (!params.headless and std::strcmp(option, "--headless") == 0) {
+			params.headless = true;
+		} else if (std::strcmp(option, "--ticks") == 0 and it + 1 < argc) {
+			params.tick_limit = static_cast<arch_t>(std::strtoull(argv[++it], nullptr, 10));
+		} else if (std::strcmp(option, "--seconds") == 0 and it + 1 < argc) {
+			params.time_limit = std::strtod(argv[++it], nullptr);
+		} else if (std::strcmp(option, "--field") == 0 and it + 1 < argc) {
+			params.field = argv[++it];
+		} else if (std::strcmp(option, "--record") == 0 and it + 1 < argc) {
+			params.record_path = argv[++it];
+		} else if (std::strcmp(option, "--replay") == 0 and it + 1 < argc) {
+			params.replay_path = argv[++it];
+		} else if (std::strcmp(option, "--seed") == 0 and it + 1 < argc) {
+			params.seed = argv[++it];
+		} else if (std::strcmp(option, "--profile") == 0 and it + 1 < argc) {
+			params.profile_path = argv[++it];
+		} else if (std::strcmp(option, "--stress") == 0 and it + 1 < argc) {
+			params.stress_quads = static_cast<arch_t>(std::strtoull(argv[++it], nullptr, 10));
 		} else if (directory == nullptr) {
 			directory = option;
 		} else {
 			break;
 		}
 	}
+	logger_t logger;
+	if (!logger.init()) {
+		return EXIT_FAILURE;
+	}
 	if (std::atexit(SDL_Quit) != 0) {
 		synao_log("Pushing to \"std::atexit\" buffer failed!\n");
 		return EXIT_FAILURE;
 	}
-	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK) < 0) {
+	if (params.headless and params.tick_limit == 0 and params.time_limit <= 0.0 and params.replay_path == nullptr) {
+		synao_log("Warning! Headless mode has no tick or time limit!\n");
+	}
+	if (params.headless and params.stress_quads > 0) {
+		synao_log("Warning! Stress test needs a window, so it's ignored in headless mode!\n");
+	}
+	if (SDL_Init(params.headless ? 0 : SDL_INIT_VIDEO | SDL_INIT_JOYSTICK) < 0) {
 		synao_log("SDL Initialization failed!\nSDL Error: %s\n", SDL_GetError());
 		return EXIT_FAILURE;
 	}
@@ -261,5 +577,18 @@ int main(int argc, char** argv) {
 	// Load config file
 	setup_file_t config;
 	load_config_file(config);
-	return tile_editor ? proc_editor(config) : proc_naomi(config);
+	logger.configure(config);
+	synao_thread("main");
+	sint_t result = EXIT_SUCCESS;
+	if (params.headless) {
+		result = proc_headless(config, params);
+	} else if (params.stress_quads > 0) {
+		result = proc_stress(config, params);
+	} else {
+		result = tile_editor ? proc_editor(config) : proc_naomi(config, params, launch_watch);
+	}
+	if (params.profile_path != nullptr) {
+		profiler::dump(params.profile_path);
+	}
+	return result;
 }
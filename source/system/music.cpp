@@ -2,6 +2,7 @@
 
 #include "../utility/setup_file.hpp"
 #include "../utility/logger.hpp"
+#include "../utility/profiler.hpp"
 #include "../utility/vfs.hpp"
 #include "../audio/alcheck.hpp"
 
@@ -72,16 +73,16 @@ bool music_t::init(const setup_file_t& config) {
 	}
 	service = std::make_unique<pxtnService>();
 	if (service == nullptr) {
-		synao_log("Pxtone service creation failed!\n");
+		synao_error(Music, "Pxtone service creation failed!\n");
 		return false;
 	}
 	pxtnERR result = service->init();
 	if (result != pxtnERR::pxtnOK) {
-		synao_log("Pxtone service initialization failed! PxtnErr: %d\n", result);
+		synao_error(Music, "Pxtone service initialization failed! PxtnErr: %d\n", result);
 		return false;
 	}
 	if (!service->set_destination_quality(channels, sampling_rate)) {
-		synao_log("Pxtone quality setting failed!\n");
+		synao_error(Music, "Pxtone quality setting failed!\n");
 		return false;
 	}
 	// Setup OpenAL stuff
@@ -96,6 +97,22 @@ bool music_t::init(const setup_file_t& config) {
 	return true;
 }
 
+// Leaves the pxtone service empty, so loading and playing tunes do nothing.
+bool music_t::init_headless(const setup_file_t& config) {
+	config.get("Music", "Volume", volume);
+	volume = glm::clamp(volume, 0.0f, 1.0f);
+	if (playing or !title.empty()) {
+		synao_log("Music device is already running!\n");
+		return false;
+	}
+	if (service != nullptr) {
+		synao_log("Pxtone service already exists!\n");
+		return false;
+	}
+	synao_log("Music service is disabled.\n");
+	return true;
+}
+
 bool music_t::load(const std::string& title) {
 	if (this->title == title) {
 		return true;
@@ -105,29 +122,29 @@ bool music_t::load(const std::string& title) {
 	}
 	this->clear();
 	const std::string tune_path = vfs::resource_path(vfs_resource_path_t::Tune);
-	std::vector<byte_t> buffer = vfs::byte_buffer(tune_path + title + ".ptcop");
-	arch_t length = buffer.size();
+	const archive_blob_t blob = vfs::memory(tune_path + title + ".ptcop");
+	arch_t length = blob.size();
 	if (!length) {
-		synao_log("Pxtone file loading failed!\n");
+		synao_error(Music, "Pxtone file loading failed!\n");
 		return false;
 	} else if (length >= kHeightLength) {
-		synao_log("Pxtone file too large!\n");
+		synao_error(Music, "Pxtone file too large!\n");
 		return false;
 	}
 	pxtnDescriptor descriptor;
-	if (!descriptor.set_memory_r(&buffer[0], static_cast<sint_t>(length))) {
-		synao_log("Pxtone descriptor creation failed!\n");
+	if (!descriptor.set_memory_r(const_cast<byte_t*>(blob.data()), static_cast<sint_t>(length))) {
+		synao_error(Music, "Pxtone descriptor creation failed!\n");
 		return false;
 	}
 	pxtnERR result = service->read(&descriptor);
 	if (result != pxtnERR::pxtnOK) {
-		synao_log("Pxtone descriptor reading failed! PxtnErr: %d\n", result);
+		synao_error(Music, "Pxtone descriptor reading failed! PxtnErr: %d\n", result);
 		service->clear();
 		return false;
 	}
 	result = service->tones_ready();
 	if (result != pxtnERR::pxtnOK) {
-		synao_log("Pxtone tone readying failed! PxtnErr: %d\n", result);
+		synao_error(Music, "Pxtone tone readying failed! PxtnErr: %d\n", result);
 		service->clear();
 		return false;
 	}
@@ -155,7 +172,7 @@ bool music_t::play(real_t start_point, real_t fade_length) {
 	preparation.fadein_sec = fade_length / 1000.0f;
 	preparation.master_volume = volume;
 	if (!service->moo_preparation(&preparation)) {
-		synao_log("Pxtone couldn't prepare tune!\n");
+		synao_error(Music, "Pxtone couldn't prepare tune!\n");
 		return false;
 	}
 	playing = true;
@@ -225,6 +242,7 @@ void music_t::process(music_t* music) {
 		synao_log("Music thread should not print this message.\n");
 		return;
 	}
+	synao_thread("music_t::process");
 	// Initialize Necessary Data
 	sint_t amount = static_cast<sint_t>(music->buffered_time * static_cast<real_t>(music->channels * music->sampling_rate * kAudioBitrate));
 	uint_t waiter = static_cast<uint_t>(music->buffered_time * kWaitConstant);
@@ -256,6 +274,7 @@ void music_t::process(music_t* music) {
 			}
 			alCheck(alGetSourcei(music->source, AL_BUFFERS_PROCESSED, &procs));
 			while (procs > 0) {
+				synao_zone("music_t::process");
 				uint_t buffer = 0;
 				alCheck(alSourceUnqueueBuffers(music->source, 1, &buffer));
 				if (music->service->Moo(&vector[0], amount)) {
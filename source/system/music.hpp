@@ -21,6 +21,7 @@ public:
 	~music_t();
 public:
 	bool init(const setup_file_t& config);
+	bool init_headless(const setup_file_t& config);
 	bool load(const std::string& title);
 	bool load(const std::string& title, real_t start_point, real_t fade_length);
 	bool play(real_t start_point, real_t fade_length);
@@ -3,20 +3,52 @@
 
 #include "../utility/constants.hpp"
 #include "../utility/logger.hpp"
+#include "../utility/profiler.hpp"
+#include "../utility/setup_file.hpp"
 #include "../utility/vfs.hpp"
+#include "../utility/watch.hpp"
 #include "../video/frame_buffer.hpp"
 
 #include <limits>
+#include <utility>
+#include <algorithm>
 #include <glm/gtc/matrix_transform.hpp>
 
+static const byte_t kProgramCacheName[] = "programs.bin";
+
+// Zero is left for null, so lists without a texture or palette sort first.
+static uint64_t identify_pointer(std::unordered_map<const void*, uint64_t>& ids, const void* pointer) {
+	if (pointer == nullptr) {
+		return 0;
+	}
+	return ids.try_emplace(pointer, ids.size() + 1).first->second;
+}
+
 renderer_t::renderer_t() :
+	stale(false),
+	pruned(false),
 	display_allocator(),
+	display_stream(),
 	overlay_quads(),
 	normal_quads(),
+	overlay_lookup(),
+	normal_lookup(),
+	overlay_sorted(true),
+	normal_sorted(true),
+	texture_ids(),
+	palette_ids(),
+	program_ids(),
+	atlas(),
+	atlas_sheets(),
+	atlas_changed(false),
+	unbatched_calls(0),
+	instancing(false),
 	programs(pipeline_t::Total),
+	binaries(),
 	projection_buffer(),
 	viewport_buffer(),
 	graphics_state(),
+	uploads(),
 	gk_projection_matrix(1.0f),
 	gk_viewport_matrix(1.0f),
 	gk_video_dimensions(constants::NormalDimensions<real_t>()),
@@ -26,11 +58,23 @@ renderer_t::renderer_t() :
 	gk_viewport_matrix = gk_projection_matrix;
 }
 
-bool renderer_t::init(glm::ivec2 version) {
+bool renderer_t::init(const setup_file_t& config, glm::ivec2 version) {
+	if (!uploads.init(config)) {
+		synao_log("Couldn't create upload_queue_t!\n");
+		return false;
+	}
 	if (!display_allocator.create(primitive_t::Triangles, UINT16_MAX)) {
 		synao_log("Couldn't create quad_buffer_allocator_t!\n");
 		return false;
 	}
+	if (!display_stream.init(config)) {
+		synao_log("Couldn't create vertex_stream_t!\n");
+		return false;
+	}
+	if (!atlas.init(config)) {
+		synao_log("Couldn't create texture_atlas_t!\n");
+		return false;
+	}
 	if (projection_buffer.valid() or viewport_buffer.valid()) {
 		synao_log("Constant buffers already exist!\n");
 		return false;
@@ -80,6 +124,11 @@ bool renderer_t::init(glm::ivec2 version) {
 	);
 	graphics_state.set_const_buffer(&viewport_buffer, 0);
 
+	watch_t program_watch;
+	if (!binaries.init(config, vfs::resource_path(vfs_resource_path_t::Init) + kProgramCacheName)) {
+		synao_log("Couldn't create program_cache_t!\n");
+		return false;
+	}
 	const shader_t* blank = vfs::shader(
 		"blank",
 		pipeline::blank_vert(version),
@@ -105,6 +154,11 @@ bool renderer_t::init(glm::ivec2 version) {
 		pipeline::indexed_frag(version),
 		shader_stage_t::Fragment
 	);
+	const shader_t* sheets = vfs::shader(
+		"atlas",
+		pipeline::atlas_frag(version),
+		shader_stage_t::Fragment
+	);
 	bool result = programs[pipeline_t::VtxBlankColors].create(blank, colors);
 	if (!result) {
 		synao_log("VtxBlankColors program creation failed!\n");
@@ -120,6 +174,30 @@ bool renderer_t::init(glm::ivec2 version) {
 		synao_log("VtxMajorIndexed program creation failed!\n");
 		return false;
 	}
+	result = programs[pipeline_t::VtxMajorAtlas].create(major, sheets);
+	if (!result) {
+		synao_log("VtxMajorAtlas program creation failed!\n");
+		return false;
+	}
+	// Sprites fall back to four vertices each when instanced programs can't be used.
+	instancing = true;
+	config.get("Video", "Instancing", instancing);
+	if (instancing and quad_buffer_t::has_instanced_option()) {
+		const shader_t* sprite = vfs::shader(
+			"sprite",
+			pipeline::sprite_vert(version),
+			shader_stage_t::Vertex
+		);
+		instancing =
+			programs[pipeline_t::VtxSpriteSprites].create(sprite, sprites) and
+			programs[pipeline_t::VtxSpriteIndexed].create(sprite, indexed) and
+			programs[pipeline_t::VtxSpriteAtlas].create(sprite, sheets);
+		if (!instancing) {
+			synao_warn(Video, "Instanced sprite program creation failed! Sprites will be expanded on the CPU.\n");
+		}
+	} else {
+		instancing = false;
+	}
 	if (!program_t::has_separable()) {
 		programs[pipeline_t::VtxBlankColors].set_block("transforms", 0);
 		programs[pipeline_t::VtxMajorSprites].set_block("transforms", 0);
@@ -127,12 +205,35 @@ bool renderer_t::init(glm::ivec2 version) {
 		programs[pipeline_t::VtxMajorIndexed].set_block("transforms", 0);
 		programs[pipeline_t::VtxMajorIndexed].set_sampler("indexed_map", 0);
 		programs[pipeline_t::VtxMajorIndexed].set_sampler("palette_map", 1);
+		programs[pipeline_t::VtxMajorAtlas].set_block("transforms", 0);
+		programs[pipeline_t::VtxMajorAtlas].set_sampler("diffuse_map", 0);
+		if (instancing) {
+			programs[pipeline_t::VtxSpriteSprites].set_block("transforms", 0);
+			programs[pipeline_t::VtxSpriteSprites].set_sampler("diffuse_map", 0);
+			programs[pipeline_t::VtxSpriteIndexed].set_block("transforms", 0);
+			programs[pipeline_t::VtxSpriteIndexed].set_sampler("indexed_map", 0);
+			programs[pipeline_t::VtxSpriteIndexed].set_sampler("palette_map", 1);
+			programs[pipeline_t::VtxSpriteAtlas].set_block("transforms", 0);
+			programs[pipeline_t::VtxSpriteAtlas].set_sampler("diffuse_map", 0);
+		}
 	}
+	binaries.save();
+	synao_log(
+		"Built shader programs in %.2f ms with %zu restored from cache.\n",
+		program_watch.elapsed() * 1000.0,
+		binaries.get_restored()
+	);
 	synao_log("Rendering service is ready.\n");
 	return true;
 }
 
+// The simulation thread calls this while the main thread may still be flushing,
+// so unowned lists are only removed the next time a list is looked up.
 void renderer_t::clear() {
+	stale.store(true, std::memory_order_release);
+}
+
+void renderer_t::prune() {
 	auto lacks_owner = [](auto& list) { return !list.persists(); };
 	overlay_quads.erase(
 		std::remove_if(overlay_quads.begin(), overlay_quads.end(), lacks_owner),
@@ -142,9 +243,112 @@ void renderer_t::clear() {
 		std::remove_if(normal_quads.begin(), normal_quads.end(), lacks_owner),
 		normal_quads.end()
 	);
+	// Ids only ever grow between prunes, so whatever survived gets them handed out again.
+	texture_ids.clear();
+	palette_ids.clear();
+	program_ids.clear();
+	for (auto&& list : overlay_quads) {
+		list.key = this->identify(list.layer, list.blend_mode, list.quad_buffer.get_usage(), list.program, list.texture, list.palette);
+	}
+	for (auto&& list : normal_quads) {
+		list.key = this->identify(list.layer, list.blend_mode, list.quad_buffer.get_usage(), list.program, list.texture, list.palette);
+	}
+	overlay_sorted = false;
+	normal_sorted = false;
+	this->order(overlay_quads, overlay_lookup, overlay_sorted);
+	this->order(normal_quads, normal_lookup, normal_sorted);
+	// Sheets get packed again for the next field, and sprites leaving the atlas need to be rewritten.
+	atlas_changed = atlas_changed or atlas.get_packed() > 0;
+	atlas.clear();
+	pruned = true;
+}
+
+uint64_t renderer_t::identify(layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, const program_t* program, const texture_t* texture, const palette_t* palette) {
+	return display_list_t::pack(
+		layer, blend_mode, usage,
+		identify_pointer(texture_ids, texture),
+		identify_pointer(palette_ids, palette),
+		identify_pointer(program_ids, program)
+	);
+}
+
+// Lists are appended unsorted, and order() sorts them once before they're flushed.
+display_list_t& renderer_t::fetch(std::vector<display_list_t>& lists, std::unordered_map<uint64_t, arch_t>& lookup, bool_t& sorted, layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, const program_t* program, const texture_t* texture, const palette_t* palette) {
+	if (stale.exchange(false, std::memory_order_acq_rel)) {
+		this->prune();
+	}
+	const uint64_t key = this->identify(layer, blend_mode, usage, program, texture, palette);
+	auto iter = lookup.find(key);
+	if (iter != lookup.end()) {
+		display_list_t& found = lists[iter->second];
+		if (found.matches(layer, blend_mode, usage, texture, palette, program)) {
+			return found;
+		}
+		// Keys only collide once ids run past their limits, so searching is fine here.
+		for (auto&& list : lists) {
+			if (list.matches(layer, blend_mode, usage, texture, palette, program)) {
+				return list;
+			}
+		}
+	}
+	lookup.try_emplace(key, lists.size());
+	if (!lists.empty() and lists.back().get_key() > key) {
+		sorted = false;
+	}
+	lists.emplace_back(
+		layer, blend_mode, usage,
+		texture, palette, program,
+		key, &display_allocator, &display_stream
+	);
+	return lists.back();
+}
+
+// Sheets packed here are only used from the next frame on, which is also when every
+// sprite gets rewritten, since the ones moving into the atlas change lists.
+void renderer_t::settle() {
+	arch_t drawn = 0;
+	arch_t merged = 0;
+	for (auto&& list : overlay_quads) {
+		if (list.rendered()) {
+			drawn++;
+			merged += list.texture == atlas.get_texture() ? 1 : 0;
+		}
+	}
+	for (auto&& list : normal_quads) {
+		if (list.rendered()) {
+			drawn++;
+			merged += list.texture == atlas.get_texture() ? 1 : 0;
+		}
+	}
+	unbatched_calls = drawn - merged + atlas_sheets.size();
+	atlas_sheets.clear();
+	atlas_changed = atlas.pack();
+}
+
+void renderer_t::order(std::vector<display_list_t>& lists, std::unordered_map<uint64_t, arch_t>& lookup, bool_t& sorted) {
+	if (!sorted) {
+		std::sort(lists.begin(), lists.end(), [](const display_list_t& lhv, const display_list_t& rhv) {
+			return lhv.get_key() < rhv.get_key();
+		});
+		lookup.clear();
+		for (arch_t it = 0; it < lists.size(); ++it) {
+			lookup.try_emplace(lists[it].get_key(), it);
+		}
+		sorted = true;
+	}
+}
+
+// True once per prune, which is when lists stop pointing at the last field's textures.
+bool renderer_t::collect() {
+	if (stale.exchange(false, std::memory_order_acq_rel)) {
+		this->prune();
+	}
+	return std::exchange(pruned, false);
 }
 
 void renderer_t::flush(const video_t& video, const glm::mat4& viewport_matrix) {
+	synao_zone("renderer_t::flush");
+	uploads.process();
 	// Update Constant Buffers
 	glm::vec2 video_dimensions = video.get_dimensions();
 	if (gk_video_dimensions != video_dimensions) {
@@ -156,6 +360,9 @@ void renderer_t::flush(const video_t& video, const glm::mat4& viewport_matrix) {
 		gk_viewport_matrix = viewport_matrix;
 		viewport_buffer.update(&gk_viewport_matrix, sizeof(glm::mat4));
 	}
+	this->order(normal_quads, normal_lookup, normal_sorted);
+	this->order(overlay_quads, overlay_lookup, overlay_sorted);
+	display_stream.begin();
 	// Draw Normal Quads
 	frame_buffer_t::clear(video.get_integral_dimensions());
 	graphics_state.set_const_buffer(&viewport_buffer, 0);
@@ -167,15 +374,22 @@ void renderer_t::flush(const video_t& video, const glm::mat4& viewport_matrix) {
 	for (auto&& list : overlay_quads) {
 		list.flush(graphics_state);
 	}
+	display_stream.end();
+	this->settle();
 }
 
 void renderer_t::flush(const glm::ivec2& dimensions) {
+	uploads.process();
+	this->order(overlay_quads, overlay_lookup, overlay_sorted);
+	display_stream.begin();
 	// Draw Overlay Quads (Only)
 	frame_buffer_t::clear(dimensions);
 	graphics_state.set_const_buffer(&projection_buffer, 0);
 	for (auto&& list : overlay_quads) {
 		list.flush(graphics_state);
 	}
+	display_stream.end();
+	this->settle();
 }
 
 void renderer_t::ortho(glm::ivec2 integral_dimensions) {
@@ -218,22 +432,40 @@ arch_t renderer_t::get_draw_calls() const {
 	return result;
 }
 
-display_list_t& renderer_t::get_overlay_quads(layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, const program_t* program, const texture_t* texture, const palette_t* palette) {
-	for (auto&& list : overlay_quads) {
-		if (list.matches(layer, blend_mode, usage, texture, palette, program)) {
-			return list;
-		}
+arch_t renderer_t::get_unbatched_calls() const {
+	return unbatched_calls;
+}
+
+// Only sheets drawn with the sprites pipeline can go in the atlas, since indexed ones
+// already need the third texture coordinate for their palette row.
+const atlas_entry_t* renderer_t::get_atlas_entry(const texture_t* texture, layer_t layer) {
+	const atlas_entry_t* entry = atlas.find(texture);
+	if (entry != nullptr) {
+		atlas_sheets.insert(this->identify(
+			layer, blend_mode_t::Alpha, buffer_usage_t::Dynamic,
+			&programs[pipeline_t::VtxMajorSprites], texture, nullptr
+		));
 	}
-	overlay_quads.emplace_back(
-		layer, blend_mode, usage,
-		texture, palette,
-		program, &display_allocator
-	);
-	std::sort(overlay_quads.begin(), overlay_quads.end());
-	return this->get_overlay_quads(
+	return entry;
+}
+
+const texture_t* renderer_t::get_atlas() const {
+	return atlas.get_texture();
+}
+
+bool renderer_t::repacked() const {
+	return atlas_changed;
+}
+
+bool renderer_t::instanced() const {
+	return instancing;
+}
+
+display_list_t& renderer_t::get_overlay_quads(layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, const program_t* program, const texture_t* texture, const palette_t* palette) {
+	return this->fetch(
+		overlay_quads, overlay_lookup, overlay_sorted,
 		layer, blend_mode, usage,
-		program, texture,
-		palette
+		program, texture, palette
 	);
 }
 
@@ -254,21 +486,10 @@ display_list_t& renderer_t::get_overlay_quads(layer_t layer, blend_mode_t blend_
 }
 
 display_list_t& renderer_t::get_normal_quads(layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, const program_t* program, const texture_t* texture, const palette_t* palette) {
-	for (auto&& list : normal_quads) {
-		if (list.matches(layer, blend_mode, usage, texture, palette, program)) {
-			return list;
-		}
-	}
-	normal_quads.emplace_back(
-		layer, blend_mode, usage,
-		texture, palette,
-		program, &display_allocator
-	);
-	std::sort(normal_quads.begin(), normal_quads.end());
-	return this->get_normal_quads(
+	return this->fetch(
+		normal_quads, normal_lookup, normal_sorted,
 		layer, blend_mode, usage,
-		program, texture,
-		palette
+		program, texture, palette
 	);
 }
 
@@ -1,13 +1,20 @@
 #ifndef LEVIATHAN_INCLUDED_SYSTEM_RENDERER_HPP
 #define LEVIATHAN_INCLUDED_SYSTEM_RENDERER_HPP
 
+#include <atomic>
 #include <optional>
+#include <unordered_map>
+#include <unordered_set>
 #include <glm/mat4x4.hpp>
 
 #include "../utility/enums.hpp"
 #include "../resource/pipeline.hpp"
 #include "../video/const_buffer.hpp"
 #include "../video/display_list.hpp"
+#include "../video/program_cache.hpp"
+#include "../video/texture_atlas.hpp"
+#include "../video/upload_queue.hpp"
+#include "../video/vertex_stream.hpp"
 
 struct setup_file_t;
 struct video_t;
@@ -15,16 +22,21 @@ struct video_t;
 struct renderer_t : public not_copyable_t {
 public:
 	renderer_t();
-	renderer_t(renderer_t&&) = default;
-	renderer_t& operator=(renderer_t&&) = default;
+	renderer_t(renderer_t&&) = delete;
+	renderer_t& operator=(renderer_t&&) = delete;
 	~renderer_t() = default;
 public:
-	bool init(glm::ivec2 version);
+	bool init(const setup_file_t& config, glm::ivec2 version);
 	void clear();
 	void flush(const video_t& video, const glm::mat4& viewport_matrix);
 	void flush(const glm::ivec2& dimensions);
 	void ortho(glm::ivec2 integral_dimensions);
 	arch_t get_draw_calls() const;
+	arch_t get_unbatched_calls() const;
+	const atlas_entry_t* get_atlas_entry(const texture_t* texture, layer_t layer);
+	const texture_t* get_atlas() const;
+	bool repacked() const;
+	bool instanced() const;
 	display_list_t& get_overlay_quads(layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, const program_t* program, const texture_t* texture, const palette_t* palette);
 	display_list_t& get_overlay_quads(layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, pipeline_t pipeline, const texture_t* texture, const palette_t* palette);
 	display_list_t& get_overlay_quads(layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, pipeline_t pipeline);
@@ -34,12 +46,32 @@ public:
 	display_list_t* find_quads(sint64_t guid);
 	sint64_t capture_list(display_list_t& list);
 	void release_list(display_list_t& list);
+	bool collect();
 private:
+	void prune();
+	uint64_t identify(layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, const program_t* program, const texture_t* texture, const palette_t* palette);
+	display_list_t& fetch(std::vector<display_list_t>& lists, std::unordered_map<uint64_t, arch_t>& lookup, bool_t& sorted, layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, const program_t* program, const texture_t* texture, const palette_t* palette);
+	void order(std::vector<display_list_t>& lists, std::unordered_map<uint64_t, arch_t>& lookup, bool_t& sorted);
+	void settle();
+private:
+	std::atomic<bool> stale;
+	bool_t pruned;
 	quad_buffer_allocator_t display_allocator;
+	vertex_stream_t display_stream;
 	std::vector<display_list_t> overlay_quads, normal_quads;
+	std::unordered_map<uint64_t, arch_t> overlay_lookup, normal_lookup;
+	bool_t overlay_sorted, normal_sorted;
+	std::unordered_map<const void*, uint64_t> texture_ids, palette_ids, program_ids;
+	texture_atlas_t atlas;
+	std::unordered_set<uint64_t> atlas_sheets;
+	bool_t atlas_changed;
+	arch_t unbatched_calls;
+	bool_t instancing;
 	std::vector<program_t> programs;
+	program_cache_t binaries;
 	const_buffer_t projection_buffer, viewport_buffer;
 	gfx_t graphics_state;
+	upload_queue_t uploads;
 	glm::mat4 gk_projection_matrix, gk_viewport_matrix;
 	glm::vec2 gk_video_dimensions, gk_video_resolution;
 };
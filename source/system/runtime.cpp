@@ -1,17 +1,17 @@
 #include "./runtime.hpp"
 
-#include <tmxlite/Map.hpp>
-
 #include "../component/location.hpp"
 #include "../component/health.hpp"
 #include "../system/input.hpp"
 #include "../system/audio.hpp"
 #include "../system/video.hpp"
 #include "../system/renderer.hpp"
+#include "../field/field_file.hpp"
+#include "../field/prefetch.hpp"
 #include "../utility/debug.hpp"
 #include "../utility/constants.hpp"
 #include "../utility/logger.hpp"
-#include "../utility/tmx_convert.hpp"
+#include "../utility/profiler.hpp"
 #include "../utility/setup_file.hpp"
 #include "../utility/vfs.hpp"
 
@@ -20,6 +20,7 @@ static const byte_t kStatCpntPath[] = "_check.cfg";
 
 runtime_t::runtime_t() :
 	accum(0.0),
+	iterations(0),
 	kernel(),
 	receiver(),
 	stack_gui(),
@@ -30,15 +31,49 @@ runtime_t::runtime_t() :
 	camera(),
 	naomi_state(),
 	kontext(),
-	tilemap()
+	tilemap(),
+	viewport_matrix(1.0f),
+	simulation(),
+	simulation_mutex(),
+	simulation_signal(),
+	simulation_task(),
+	pending(false),
+	exiting(false),
+	succeeded(true)
 {
 
 }
 
-bool runtime_t::init(input_t& input, audio_t& audio, music_t& music, renderer_t& renderer) {
-	if (!receiver.init(input, audio, music, kernel, stack_gui, dialogue_gui, title_view, headsup, camera, naomi_state, kontext)) {
-		return false;
+runtime_t::~runtime_t() {
+	if (simulation.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock{ simulation_mutex };
+			exiting = true;
+		}
+		simulation_signal.notify_all();
+		simulation.join();
 	}
+}
+
+bool runtime_t::init(input_t& input, audio_t& audio, music_t& music, renderer_t& renderer) {
+	return
+		this->init_scripts(input, audio, music) and
+		this->init_actors() and
+		this->init_state(audio, renderer);
+}
+
+// The script engine keeps per-thread context state, so startup builds it on the main
+// thread. Actors only register themselves and can run on a job thread meanwhile.
+// Everything in init_state has to wait for them, the language and the renderer.
+bool runtime_t::init_scripts(input_t& input, audio_t& audio, music_t& music) {
+	return receiver.init(input, audio, music, kernel, stack_gui, dialogue_gui, title_view, headsup, camera, naomi_state, kontext);
+}
+
+bool runtime_t::init_actors() {
+	return kontext.generate();
+}
+
+bool runtime_t::init_state(audio_t& audio, renderer_t& renderer) {
 	if (!dialogue_gui.init(audio, receiver)) {
 		return false;
 	}
@@ -63,8 +98,12 @@ bool runtime_t::init(input_t& input, audio_t& audio, music_t& music, renderer_t&
 }
 
 bool runtime_t::handle(setup_file_t& config, input_t& input, video_t& video, audio_t& audio, music_t& music, renderer_t& renderer) {
+	synao_zone("runtime_t::handle");
+	iterations = 0;
 	while (this->viable()) {
 		accum = glm::max(accum - constants::MinInterval(), 0.0);
+		++iterations;
+		input.tick_trace();
 		if (headsup.is_fade_done()) {
 			if (kernel.has(kernel_state_t::Boot)) {
 				this->setup_boot(renderer);
@@ -105,6 +144,48 @@ bool runtime_t::handle(setup_file_t& config, input_t& input, video_t& video, aud
 	return true;
 }
 
+// Runs handle() on the simulation thread. Nothing else may touch the runtime,
+// the input device or the audio device until await() returns.
+void runtime_t::launch(setup_file_t& config, input_t& input, video_t& video, audio_t& audio, music_t& music, renderer_t& renderer) {
+	if (!simulation.joinable()) {
+		simulation = std::thread(&runtime_t::simulate, this);
+	}
+	{
+		std::lock_guard<std::mutex> lock{ simulation_mutex };
+		simulation_task = [this, &config, &input, &video, &audio, &music, &renderer] {
+			return this->handle(config, input, video, audio, music, renderer);
+		};
+		pending = true;
+	}
+	simulation_signal.notify_all();
+}
+
+bool runtime_t::await() {
+	std::unique_lock<std::mutex> lock{ simulation_mutex };
+	simulation_signal.wait(lock, [this] { return !pending; });
+	return succeeded;
+}
+
+void runtime_t::simulate() {
+	synao_thread("simulation");
+	std::unique_lock<std::mutex> lock{ simulation_mutex };
+	while (true) {
+		simulation_signal.wait(lock, [this] { return pending or exiting; });
+		if (exiting) {
+			break;
+		}
+		lock.unlock();
+		bool result = std::invoke(simulation_task);
+		lock.lock();
+		succeeded = result;
+		pending = false;
+		simulation_signal.notify_all();
+	}
+	lock.unlock();
+	// Script contexts ran on this thread, so free what AngelScript kept for it.
+	asThreadCleanup();
+}
+
 void runtime_t::update(real64_t delta) {
 	accum += delta;
 	kernel.update(delta);
@@ -120,6 +201,48 @@ void runtime_t::update(real64_t delta) {
 }
 
 void runtime_t::render(const video_t& video, renderer_t& renderer) const {
+	this->generate(renderer);
+	renderer.flush(video, camera.get_matrix());
+	video.flush();
+}
+
+// Vertices written here and the captured matrix are the snapshot that present()
+// submits, so the simulation is free to advance while the driver works.
+void runtime_t::draw(renderer_t& renderer) {
+	this->generate(renderer);
+	viewport_matrix = camera.get_matrix();
+}
+
+void runtime_t::present(const video_t& video, renderer_t& renderer) const {
+	renderer.flush(video, viewport_matrix);
+	video.flush();
+}
+
+bool runtime_t::viable() const {
+	return accum >= constants::MaxInterval();
+}
+
+void runtime_t::set_field(const std::string& field) {
+	kernel.reset(field);
+}
+
+const std::string& runtime_t::get_field() const {
+	return kernel.get_field();
+}
+
+void runtime_t::set_perf_visible(bool_t visible) {
+	headsup.set_perf_visible(visible);
+}
+
+void runtime_t::push_frame_sample(frame_sample_t sample) {
+	sample.iterations = iterations;
+	sample.uploads = frame_stats::take_upload_bytes();
+	sample.streamed = frame_stats::take_stream_bytes();
+	sample.entities = kontext.active();
+	headsup.push_frame_sample(sample);
+}
+
+void runtime_t::generate(renderer_t& renderer) const {
 	stack_gui.render(renderer, inventory_gui);
 	dialogue_gui.render(renderer);
 	inventory_gui.render(renderer, kernel);
@@ -130,15 +253,10 @@ void runtime_t::render(const video_t& video, renderer_t& renderer) const {
 		kontext.render(renderer, viewport);
 		tilemap.render(renderer, viewport);
 	}
-	renderer.flush(video, camera.get_matrix());
-	video.flush();
-}
-
-bool runtime_t::viable() const {
-	return accum >= constants::MaxInterval();
 }
 
 bool runtime_t::setup_field(audio_t& audio, renderer_t& renderer) {
+	synao_zone("runtime_t::setup_field");
 	renderer.clear();
 	kernel.lock();
 	receiver.reset();
@@ -151,33 +269,17 @@ bool runtime_t::setup_field(audio_t& audio, renderer_t& renderer) {
 		return false;
 	}
 	receiver.run_function(kernel);
-	const std::string full_path = vfs::resource_path(vfs_resource_path_t::Field) + kernel.get_field() + ".tmx";
-	tmx::Map tmxmap;
-	if (!tmxmap.load(full_path)) {
-		synao_log("Map file loading failed! Map Path: %s\n", full_path.c_str());
+	field_file_t field;
+	if (!field.load(kernel.get_field())) {
+		synao_error(Field, "Map file loading failed! Map Name: %s\n", kernel.get_field().c_str());
 		kernel.finish_field();
 		return false;
 	}
-	camera.set_view_limits(
-		tmx_convert::rect_to_rect(tmxmap.getBounds())
-	);
-	tilemap.push_properties(tmxmap);
-	for (auto&& layer : tmxmap.getLayers()) {
-		switch (layer->getType()) {
-		case tmx::Layer::Type::Tile:
-			tilemap.push_tile_layer(layer);
-			break;
-		case tmx::Layer::Type::Object:
-			kontext.setup_layer(layer, kernel, receiver);
-			break;
-		case tmx::Layer::Type::Image:
-			tilemap.push_parallax_background(layer);
-			break;
-		default:
-			break;
-		}
-	}
+	camera.set_view_limits(field.bounds);
+	tilemap.setup(field);
+	kontext.setup_field(field, kernel, receiver);
 	naomi_state.setup(audio, kernel, camera, kontext);
+	prefetch::neighbours(kernel.get_field(), field);
 	kernel.finish_field();
 	synao_log("Field loading successful.\n");
 	return true;
@@ -230,17 +332,17 @@ void runtime_t::setup_load(renderer_t& renderer) {
 			kernel.read_data(file);
 			if (!kernel.read_stream(save_path)) {
 				failure = true;
-				synao_log("Couldn't load current flags!\n");
+				synao_warn(Field, "Couldn't load current flags!\n");
 			} else {
 				synao_log("Load successful.\n");
 			}
 		} else {
 			failure = true;
-			synao_log("Couldn't load current state!\n");
+			synao_warn(Field, "Couldn't load current state!\n");
 		}
 	} else {
 		failure = true;
-		synao_log("Couldn't create save directory!\n");
+		synao_warn(Field, "Couldn't create save directory!\n");
 	}
 	kernel.finish_file_operation();
 	if (failure) {
@@ -264,14 +366,14 @@ void runtime_t::setup_save() {
 		file.set("Status", "Equips", naomi_state.hexadecimal_equips());
 		kernel.write_data(file);
 		if (!kernel.write_stream(save_path)) {
-			synao_log("Couldn't save current flags!\n");
+			synao_warn(Field, "Couldn't save current flags!\n");
 		} else if (!file.save(save_path + std::to_string(kernel.get_file_index()) + path_type)) {
-			synao_log("Couldn't save current state!\n");
+			synao_warn(Field, "Couldn't save current state!\n");
 		} else {
 			synao_log("Save successful.\n");
 		}
 	} else {
-		synao_log("Couldn't create save directory!\n");
+		synao_warn(Field, "Couldn't create save directory!\n");
 	}
 	kernel.finish_file_operation();
 }
@@ -298,6 +400,11 @@ void runtime_t::setup_debug(input_t& input, const renderer_t& renderer) {
 			headsup.set_hidden_state(draw_hidden_state_t::ActorCount, [this] {
 				return static_cast<sint_t>(kontext.active());
 			});
+		} else if (input.debug_pressed[SDL_SCANCODE_5]) {
+			headsup.set_perf_visible(!headsup.is_perf_visible());
+		} else if (input.debug_pressed[SDL_SCANCODE_0]) {
+			const std::string init_path = vfs::resource_path(vfs_resource_path_t::Init);
+			profiler::dump(init_path + "profile.json");
 		} else if (input.debug_pressed[SDL_SCANCODE_MINUS]) {
 			debug::Hitboxes = !debug::Hitboxes;
 		} else if (input.debug_pressed[SDL_SCANCODE_EQUALS]) {
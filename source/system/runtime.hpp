@@ -1,6 +1,12 @@
 #ifndef LEVIATHAN_INCLUDED_SYSTEM_RUNTIME_HPP
 #define LEVIATHAN_INCLUDED_SYSTEM_RUNTIME_HPP
 
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+#include <glm/mat4x4.hpp>
+
 #include "./kernel.hpp"
 
 #include "../utility/enums.hpp"
@@ -25,16 +31,29 @@ struct renderer_t;
 struct runtime_t : public not_copyable_t {
 public:
 	runtime_t();
-	runtime_t(runtime_t&&) = default;
-	runtime_t& operator=(runtime_t&&) = default;
-	~runtime_t() = default;
+	runtime_t(runtime_t&&) = delete;
+	runtime_t& operator=(runtime_t&&) = delete;
+	~runtime_t();
 public:
 	bool init(input_t& input, audio_t& audio, music_t& music, renderer_t& renderer);
+	bool init_scripts(input_t& input, audio_t& audio, music_t& music);
+	bool init_actors();
+	bool init_state(audio_t& audio, renderer_t& renderer);
 	bool handle(setup_file_t& config, input_t& input, video_t& video, audio_t& audio, music_t& music, renderer_t& renderer);
+	void launch(setup_file_t& config, input_t& input, video_t& video, audio_t& audio, music_t& music, renderer_t& renderer);
+	bool await();
 	void update(real64_t delta);
 	void render(const video_t& video, renderer_t& renderer) const;
+	void draw(renderer_t& renderer);
+	void present(const video_t& video, renderer_t& renderer) const;
 	bool viable() const;
+	void set_field(const std::string& field);
+	const std::string& get_field() const;
+	void set_perf_visible(bool_t visible);
+	void push_frame_sample(frame_sample_t sample);
 private:
+	void simulate();
+	void generate(renderer_t& renderer) const;
 	bool setup_field(audio_t& audio, renderer_t& renderer);
 	void setup_boot(renderer_t& renderer);
 	void setup_load(renderer_t& renderer);
@@ -44,6 +63,7 @@ private:
 #endif
 private:
 	real64_t accum;
+	arch_t iterations;
 	kernel_t kernel;
 	receiver_t receiver;
 	stack_gui_t stack_gui;
@@ -55,6 +75,12 @@ private:
 	naomi_state_t naomi_state;
 	kontext_t kontext;
 	tilemap_t tilemap;
+	glm::mat4 viewport_matrix;
+	std::thread simulation;
+	std::mutex simulation_mutex;
+	std::condition_variable simulation_signal;
+	std::function<bool()> simulation_task;
+	bool_t pending, exiting, succeeded;
 };
 
 #endif // LEVIATHAN_INCLUDED_SYSTEM_RUNTIME_HPP
@@ -14,7 +14,10 @@ video_t::video_t() :
 	context(nullptr),
 	params(),
 	major(4),
-	minor(6)
+	minor(6),
+	owner(),
+	pending_mutex(),
+	pending()
 {
 
 }
@@ -31,25 +34,8 @@ video_t::~video_t() {
 }
 
 bool video_t::init(const setup_file_t& config, bool start_imgui) {
-	config.get("Video", "VerticalSync", params.vsync);
-	config.get("Video", "Fullscreen", 	params.full);
-	config.get("Video", "ScaleFactor", params.scaling);
-	config.get("Video", "FrameLimiter", params.framerate);
-	bool_t use_opengl_4 = true;
-	config.get("Video", "UseOpenGL4", use_opengl_4);
-	if (!use_opengl_4) {
-		this->major = 3;
-		this->minor = 3;
-	}
-	params.scaling = glm::clamp(
-		params.scaling,
-		screen_params_t::kDefaultScaling,
-		screen_params_t::kHighestScaling
-	);
-	params.framerate = glm::max(
-		params.framerate,
-		screen_params_t::kDefaultFramerate
-	);
+	this->read_parameters(config);
+	owner = std::this_thread::get_id();
 	if (window != nullptr) {
 		synao_log("Window already created!\n");
 		return false;
@@ -188,6 +174,22 @@ bool video_t::init(const setup_file_t& config, bool start_imgui) {
 	return true;
 }
 
+// No window or context is created, so the OpenGL function pointers stay null.
+// Textures and palettes check for this and skip their uploads.
+bool video_t::init_headless(const setup_file_t& config) {
+	this->read_parameters(config);
+	if (window != nullptr) {
+		synao_log("Window already created!\n");
+		return false;
+	}
+	if (context != nullptr) {
+		synao_log("OpenGL context already created!\n");
+		return false;
+	}
+	synao_log("Video system initialized without a window.\n");
+	return true;
+}
+
 void video_t::submit(const frame_buffer_t* frame_buffer, arch_t index) const {
 	if (frame_buffer != nullptr) {
 		const glm::ivec2 source_dimensions = frame_buffer->get_integral_dimensions();
@@ -205,6 +207,31 @@ void video_t::flush() const {
 }
 
 void video_t::set_parameters(screen_params_t params) {
+	if (window == nullptr) {
+		this->params = params;
+	} else if (std::this_thread::get_id() != owner) {
+		// Window calls have to come from the thread that created it,
+		// so the owner picks these up in apply_parameters().
+		std::lock_guard<std::mutex> lock{ pending_mutex };
+		pending = params;
+	} else {
+		this->change_parameters(params);
+	}
+}
+
+void video_t::apply_parameters() {
+	std::optional<screen_params_t> params;
+	{
+		std::lock_guard<std::mutex> lock{ pending_mutex };
+		std::swap(params, pending);
+	}
+	if (params.has_value()) {
+		this->change_parameters(*params);
+	}
+}
+
+void video_t::change_parameters(screen_params_t params) {
+	std::lock_guard<std::mutex> lock{ pending_mutex };
 	if (this->params.vsync != params.vsync) {
 		this->params.vsync = params.vsync;
 		if (SDL_GL_SetSwapInterval(params.vsync) < 0) {
@@ -250,7 +277,8 @@ void video_t::set_parameters(screen_params_t params) {
 }
 
 screen_params_t video_t::get_parameters() const {
-	return params;
+	std::lock_guard<std::mutex> lock{ pending_mutex };
+	return pending.value_or(params);
 }
 
 glm::vec2 video_t::get_dimensions() const {
@@ -268,3 +296,25 @@ glm::ivec2 video_t::get_imgui_dimensions() const {
 glm::ivec2 video_t::get_opengl_version() const {
 	return glm::ivec2(major, minor);
 }
+
+void video_t::read_parameters(const setup_file_t& config) {
+	config.get("Video", "VerticalSync", params.vsync);
+	config.get("Video", "Fullscreen", 	params.full);
+	config.get("Video", "ScaleFactor", params.scaling);
+	config.get("Video", "FrameLimiter", params.framerate);
+	bool_t use_opengl_4 = true;
+	config.get("Video", "UseOpenGL4", use_opengl_4);
+	if (!use_opengl_4) {
+		this->major = 3;
+		this->minor = 3;
+	}
+	params.scaling = glm::clamp(
+		params.scaling,
+		screen_params_t::kDefaultScaling,
+		screen_params_t::kHighestScaling
+	);
+	params.framerate = glm::max(
+		params.framerate,
+		screen_params_t::kDefaultFramerate
+	);
+}
@@ -2,6 +2,9 @@
 #define LEVIATHAN_INCLUDED_SYSTEM_VIDEO_HPP
 
 #include <tuple>
+#include <mutex>
+#include <thread>
+#include <optional>
 #include <SDL2/SDL_video.h>
 
 #include "../utility/watch.hpp"
@@ -43,9 +46,11 @@ public:
 	~video_t();
 public:
 	bool init(const setup_file_t& config, bool start_imgui = false);
+	bool init_headless(const setup_file_t& config);
 	void submit(const frame_buffer_t* frame_buffer, arch_t index) const;
 	void flush() const;
 	void set_parameters(screen_params_t params);
+	void apply_parameters();
 	screen_params_t get_parameters() const;
 	glm::vec2 get_dimensions() const;
 	glm::ivec2 get_integral_dimensions() const;
@@ -54,11 +59,17 @@ public:
 	auto get_device() const {
 		return std::make_tuple(window, context);
 	}
+private:
+	void read_parameters(const setup_file_t& config);
+	void change_parameters(screen_params_t params);
 private:
 	SDL_Window* window;
 	SDL_GLContext context;
 	screen_params_t params;
 	sint_t major, minor;
+	std::thread::id owner;
+	mutable std::mutex pending_mutex;
+	std::optional<screen_params_t> pending;
 };
 
 #endif // LEVIATHAN_INCLUDED_SYSTEM_VIDEO_HPP
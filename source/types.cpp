@@ -9,14 +9,29 @@
 	using mersenne_t = std::mt19937;
 #endif
 
+static uint64_t& get_seed_value() {
+	static uint64_t seed = static_cast<uint_t>(
+		std::chrono::high_resolution_clock::now()
+			.time_since_epoch()
+			.count()
+	);
+	return seed;
+}
+
 static mersenne_t& get_mersenne() {
-	static const sint64_t seed = std::chrono::high_resolution_clock::now()
-		.time_since_epoch()
-		.count();
-	static mersenne_t generator(static_cast<uint_t>(seed));
+	static mersenne_t generator(static_cast<mersenne_t::result_type>(get_seed_value()));
 	return generator;
 }
 
+void rng::seed(uint64_t value) {
+	get_seed_value() = value;
+	get_mersenne().seed(static_cast<mersenne_t::result_type>(value));
+}
+
+uint64_t rng::get_seed() {
+	return get_seed_value();
+}
+
 sint_t rng::next(sint_t low, sint_t high) {
 	std::uniform_int_distribution<sint_t> distribution(low, high);
 	return distribution(get_mersenne());
@@ -127,6 +127,8 @@ public:
 };
 
 namespace rng {
+	void seed(uint64_t value);
+	uint64_t get_seed();
 	sint_t next(sint_t low, sint_t high);
 	real_t next(real_t low, real_t high);
 }
@@ -0,0 +1,379 @@
+#include "./archive.hpp"
+#include "./logger.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(LEVIATHAN_PLATFORM_WINDOWS)
+	#include <windows.h>
+#elif defined(LEVIATHAN_POSIX_COMPLIANT)
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+struct archive_header_t {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t count;
+	uint32_t alignment;
+	uint64_t index;
+	uint64_t reserved;
+};
+
+static_assert(sizeof(archive_header_t) == 32, "Archive header must stay 32 bytes!");
+
+static constexpr uint64_t kHashBasis = 0xCBF29CE484222325ULL;
+static constexpr uint64_t kHashPrime = 0x00000100000001B3ULL;
+// LZ4 can't expand a block by more than this, so anything larger is damage.
+static constexpr uint64_t kMaximumRatio = 255;
+
+// Plain LZ4 block decoder. Every read and write is bounds checked
+// since a damaged archive shouldn't be able to crash the game.
+static bool decompress(const uint8_t* source, arch_t source_length, uint8_t* output, arch_t output_length) {
+	const uint8_t* ip = source;
+	const uint8_t* iend = source + source_length;
+	uint8_t* op = output;
+	uint8_t* oend = output + output_length;
+	auto extend = [&ip, iend](arch_t& length) {
+		uint8_t next = 255;
+		while (next == 255) {
+			if (ip >= iend) {
+				return false;
+			}
+			next = *ip++;
+			length += next;
+		}
+		return true;
+	};
+	while (ip < iend) {
+		const uint_t token = *ip++;
+		arch_t literals = token >> 4;
+		if (literals == 15 and !extend(literals)) {
+			return false;
+		}
+		if (literals > static_cast<arch_t>(iend - ip) or literals > static_cast<arch_t>(oend - op)) {
+			return false;
+		}
+		std::memcpy(op, ip, literals);
+		ip += literals;
+		op += literals;
+		if (ip >= iend) {
+			break;
+		}
+		if (iend - ip < 2) {
+			return false;
+		}
+		const arch_t offset = static_cast<arch_t>(ip[0]) | (static_cast<arch_t>(ip[1]) << 8);
+		ip += 2;
+		if (offset == 0 or offset > static_cast<arch_t>(op - output)) {
+			return false;
+		}
+		arch_t matches = token & 15;
+		if (matches == 15 and !extend(matches)) {
+			return false;
+		}
+		matches += 4;
+		if (matches > static_cast<arch_t>(oend - op)) {
+			return false;
+		}
+		// Matches may overlap the bytes they produce, so copy forwards one at a time.
+		const uint8_t* mp = op - offset;
+		for (arch_t it = 0; it < matches; ++it) {
+			*op++ = *mp++;
+		}
+	}
+	return op == oend;
+}
+
+archive_blob_t::archive_blob_t(const byte_t* pointer, arch_t length) :
+	storage(),
+	pointer(pointer),
+	length(length)
+{
+
+}
+
+archive_blob_t::archive_blob_t(std::vector<byte_t>&& storage) :
+	storage(std::move(storage)),
+	pointer(nullptr),
+	length(0)
+{
+	pointer = this->storage.data();
+	length = this->storage.size();
+}
+
+archive_blob_t::archive_blob_t() :
+	storage(),
+	pointer(nullptr),
+	length(0)
+{
+
+}
+
+archive_blob_t::archive_blob_t(archive_blob_t&& that) noexcept : archive_blob_t() {
+	if (this != &that) {
+		std::swap(storage, that.storage);
+		std::swap(pointer, that.pointer);
+		std::swap(length, that.length);
+	}
+}
+
+archive_blob_t& archive_blob_t::operator=(archive_blob_t&& that) noexcept {
+	if (this != &that) {
+		std::swap(storage, that.storage);
+		std::swap(pointer, that.pointer);
+		std::swap(length, that.length);
+	}
+	return *this;
+}
+
+const byte_t* archive_blob_t::data() const {
+	return pointer;
+}
+
+arch_t archive_blob_t::size() const {
+	return length;
+}
+
+bool archive_blob_t::empty() const {
+	return pointer == nullptr;
+}
+
+archive_streambuf_t::archive_streambuf_t(const archive_blob_t& blob) : std::streambuf() {
+	byte_t* begin = const_cast<byte_t*>(blob.data());
+	this->setg(begin, begin, begin + blob.size());
+}
+
+archive_reader_t::archive_reader_t(const archive_blob_t& blob) :
+	data(blob.data()),
+	length(blob.size()),
+	position(0),
+	table(nullptr),
+	table_length(0)
+{
+
+}
+
+bool archive_reader_t::take(optr_t output, arch_t bytes) {
+	if (bytes > length - position) {
+		return false;
+	}
+	std::memcpy(output, data + position, bytes);
+	position += bytes;
+	return true;
+}
+
+// Splits the string table off the end, so nothing taken afterwards can overlap it.
+bool archive_reader_t::strings(arch_t bytes) {
+	if (bytes > length - position) {
+		return false;
+	}
+	length -= bytes;
+	table = data + length;
+	table_length = bytes;
+	return true;
+}
+
+bool archive_reader_t::resolve(const archive_string_t& string, std::string& output) const {
+	if (string.offset > table_length or string.length > table_length - string.offset) {
+		return false;
+	}
+	output.assign(table + string.offset, string.length);
+	return true;
+}
+
+// Views stay valid for as long as the blob does.
+bool archive_reader_t::resolve(const archive_string_t& string, std::string_view& output) const {
+	if (string.offset > table_length or string.length > table_length - string.offset) {
+		return false;
+	}
+	output = std::string_view(table + string.offset, string.length);
+	return true;
+}
+
+archive_t::archive_t() :
+	memory(nullptr),
+	length(0),
+	entries(nullptr),
+	count(0),
+	file(nullptr),
+	mapping(nullptr)
+{
+
+}
+
+archive_t::~archive_t() {
+	this->close();
+}
+
+bool archive_t::open(const std::string& full_path) {
+	this->close();
+#if defined(LEVIATHAN_PLATFORM_WINDOWS)
+	HANDLE handle = ::CreateFileA(
+		full_path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL
+	);
+	if (handle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!::GetFileSizeEx(handle, &size) or size.QuadPart == 0) {
+		::CloseHandle(handle);
+		return false;
+	}
+	HANDLE view = ::CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (view == NULL) {
+		::CloseHandle(handle);
+		return false;
+	}
+	memory = static_cast<const byte_t*>(::MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0));
+	if (memory == nullptr) {
+		::CloseHandle(view);
+		::CloseHandle(handle);
+		return false;
+	}
+	file = handle;
+	mapping = view;
+	length = static_cast<arch_t>(size.QuadPart);
+#else
+	sint_t descriptor = ::open(full_path.c_str(), O_RDONLY);
+	if (descriptor < 0) {
+		return false;
+	}
+	struct stat sb;
+	if (::fstat(descriptor, &sb) != 0 or sb.st_size <= 0) {
+		::close(descriptor);
+		return false;
+	}
+	optr_t view = ::mmap(nullptr, static_cast<arch_t>(sb.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+	// The mapping keeps its own reference to the file.
+	::close(descriptor);
+	if (view == MAP_FAILED) {
+		return false;
+	}
+	memory = static_cast<const byte_t*>(view);
+	length = static_cast<arch_t>(sb.st_size);
+#endif
+	archive_header_t header;
+	if (length < sizeof(archive_header_t)) {
+		synao_error(Vfs, "Archive \"%s\" is too small!\n", full_path.c_str());
+		this->close();
+		return false;
+	}
+	std::memcpy(&header, memory, sizeof(archive_header_t));
+	if (header.magic != archive_t::Magic or header.version != archive_t::Version) {
+		synao_error(Vfs, "Archive \"%s\" has bad header!\n", full_path.c_str());
+		this->close();
+		return false;
+	}
+	if (header.index > length or header.count > (length - header.index) / sizeof(archive_entry_t)) {
+		synao_error(Vfs, "Archive \"%s\" has truncated index!\n", full_path.c_str());
+		this->close();
+		return false;
+	}
+	entries = reinterpret_cast<const archive_entry_t*>(memory + header.index);
+	count = header.count;
+	for (arch_t it = 0; it < count; ++it) {
+		const archive_entry_t& entry = entries[it];
+		if (entry.offset > length or entry.stored > length - entry.offset) {
+			synao_error(Vfs, "Archive \"%s\" has entry out of bounds!\n", full_path.c_str());
+			this->close();
+			return false;
+		}
+		if (entry.flags & archive_t::Compressed) {
+			if (static_cast<uint64_t>(entry.length) > static_cast<uint64_t>(entry.stored) * kMaximumRatio) {
+				synao_error(Vfs, "Archive \"%s\" has entry with impossible length!\n", full_path.c_str());
+				this->close();
+				return false;
+			}
+		} else if (entry.length != entry.stored) {
+			synao_error(Vfs, "Archive \"%s\" has entry with mismatched length!\n", full_path.c_str());
+			this->close();
+			return false;
+		}
+		if (it > 0 and entries[it - 1].hash >= entry.hash) {
+			synao_error(Vfs, "Archive \"%s\" has unsorted index!\n", full_path.c_str());
+			this->close();
+			return false;
+		}
+	}
+	synao_info(Vfs, "Mounted archive \"%s\" with %zu entries.\n", full_path.c_str(), count);
+	return true;
+}
+
+void archive_t::close() {
+	if (memory != nullptr) {
+#if defined(LEVIATHAN_PLATFORM_WINDOWS)
+		::UnmapViewOfFile(memory);
+		::CloseHandle(static_cast<HANDLE>(mapping));
+		::CloseHandle(static_cast<HANDLE>(file));
+#else
+		::munmap(const_cast<byte_t*>(memory), length);
+#endif
+	}
+	memory = nullptr;
+	length = 0;
+	entries = nullptr;
+	count = 0;
+	file = nullptr;
+	mapping = nullptr;
+}
+
+bool archive_t::valid() const {
+	return memory != nullptr;
+}
+
+bool archive_t::contains(const std::string& path) const {
+	return this->search(path) != nullptr;
+}
+
+archive_blob_t archive_t::find(const std::string& path) const {
+	const archive_entry_t* entry = this->search(path);
+	if (entry == nullptr) {
+		return archive_blob_t();
+	}
+	const byte_t* pointer = memory + entry->offset;
+	if (!(entry->flags & archive_t::Compressed)) {
+		return archive_blob_t(pointer, entry->length);
+	}
+	std::vector<byte_t> storage(entry->length);
+	if (!decompress(
+		reinterpret_cast<const uint8_t*>(pointer), entry->stored,
+		reinterpret_cast<uint8_t*>(storage.data()), storage.size()
+	)) {
+		synao_error(Vfs, "Archive entry \"%s\" failed to decompress!\n", path.c_str());
+		return archive_blob_t();
+	}
+	return archive_blob_t(std::move(storage));
+}
+
+uint64_t archive_t::hash(const std::string& path) {
+	arch_t index = 0;
+	if (path.size() >= 2 and path[0] == '.' and (path[1] == '/' or path[1] == '\\')) {
+		index = 2;
+	}
+	uint64_t result = kHashBasis;
+	for (; index < path.size(); ++index) {
+		const byte_t character = path[index] == '\\' ? '/' : path[index];
+		result ^= static_cast<uint8_t>(character);
+		result *= kHashPrime;
+	}
+	return result;
+}
+
+const archive_entry_t* archive_t::search(const std::string& path) const {
+	if (entries == nullptr) {
+		return nullptr;
+	}
+	const uint64_t key = archive_t::hash(path);
+	auto it = std::lower_bound(
+		entries, entries + count, key,
+		[](const archive_entry_t& entry, uint64_t value) { return entry.hash < value; }
+	);
+	if (it == entries + count or it->hash != key) {
+		return nullptr;
+	}
+	return it;
+}
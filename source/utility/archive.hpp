@@ -0,0 +1,102 @@
+#ifndef LEVIATHAN_INCLUDED_UTILITY_ARCHIVE_HPP
+#define LEVIATHAN_INCLUDED_UTILITY_ARCHIVE_HPP
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <streambuf>
+
+#include "../types.hpp"
+
+struct archive_entry_t {
+	uint64_t hash;
+	uint64_t offset;
+	uint32_t length;
+	uint32_t stored;
+	uint32_t flags;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(archive_entry_t) == 32, "Archive entries must stay 32 bytes!");
+
+struct archive_blob_t : public not_copyable_t {
+public:
+	archive_blob_t(const byte_t* pointer, arch_t length);
+	archive_blob_t(std::vector<byte_t>&& storage);
+	archive_blob_t();
+	archive_blob_t(archive_blob_t&& that) noexcept;
+	archive_blob_t& operator=(archive_blob_t&& that) noexcept;
+	~archive_blob_t() = default;
+public:
+	const byte_t* data() const;
+	arch_t size() const;
+	bool empty() const;
+private:
+	std::vector<byte_t> storage;
+	const byte_t* pointer;
+	arch_t length;
+};
+
+// Lets stream based parsers read a blob in place.
+struct archive_streambuf_t : public std::streambuf {
+public:
+	archive_streambuf_t(const archive_blob_t& blob);
+};
+
+// Refers to a span of the string table that trails a cooked blob.
+struct archive_string_t {
+	uint32_t offset;
+	uint32_t length;
+};
+
+// Bounds checked cursor for reading cooked blobs in place.
+struct archive_reader_t : public not_copyable_t {
+public:
+	archive_reader_t(const archive_blob_t& blob);
+	~archive_reader_t() = default;
+public:
+	bool take(optr_t output, arch_t bytes);
+	template<typename T> bool take(T& output);
+	bool strings(arch_t bytes);
+	bool resolve(const archive_string_t& string, std::string& output) const;
+	bool resolve(const archive_string_t& string, std::string_view& output) const;
+private:
+	const byte_t* data;
+	arch_t length, position;
+	const byte_t* table;
+	arch_t table_length;
+};
+
+template<typename T>
+inline bool archive_reader_t::take(T& output) {
+	return this->take(&output, sizeof(T));
+}
+
+struct archive_t : public not_copyable_t {
+public:
+	archive_t();
+	archive_t(archive_t&&) = delete;
+	archive_t& operator=(archive_t&&) = delete;
+	~archive_t();
+public:
+	bool open(const std::string& full_path);
+	void close();
+	bool valid() const;
+	bool contains(const std::string& path) const;
+	archive_blob_t find(const std::string& path) const;
+	static uint64_t hash(const std::string& path);
+public:
+	static constexpr uint32_t Magic = 0x4B50564C;
+	static constexpr uint32_t Version = 1;
+	static constexpr uint32_t Compressed = 1 << 0;
+private:
+	const archive_entry_t* search(const std::string& path) const;
+private:
+	const byte_t* memory;
+	arch_t length;
+	const archive_entry_t* entries;
+	arch_t count;
+	optr_t file, mapping;
+};
+
+#endif // LEVIATHAN_INCLUDED_UTILITY_ARCHIVE_HPP
@@ -14,9 +14,12 @@ namespace layer_value {
 	constexpr __enum_layer::type TileFront	= 1.0f;
 	constexpr __enum_layer::type HeadsUp	= 1.5f;
 	constexpr __enum_layer::type Invisible	= 2.0f;
+	// Layers are only told apart to the nearest tenth, which display list keys rely on.
+	inline sint_t quantize(__enum_layer::type layer) {
+		return static_cast<sint_t>(glm::round(layer * 10.0f));
+	}
 	inline bool equal(__enum_layer::type lhv, __enum_layer::type rhv) {
-		static constexpr __enum_layer::type kEpsilon = 0.1f;
-		return glm::abs(lhv - rhv) < kEpsilon;
+		return layer_value::quantize(lhv) == layer_value::quantize(rhv);
 	}
 }
 
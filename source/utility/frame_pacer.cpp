@@ -0,0 +1,64 @@
+#include "./frame_pacer.hpp"
+#include "./logger.hpp"
+
+#include <algorithm>
+#include <thread>
+
+static constexpr std::chrono::nanoseconds kMinMargin{ 250000 };
+static constexpr std::chrono::nanoseconds kMaxMargin{ 20000000 };
+static constexpr sint64_t kMarginWeight = 8;
+static constexpr sint64_t kMaxBacklog = 2;
+
+frame_pacer_t::frame_pacer_t() :
+	deadline(std::chrono::steady_clock::now()),
+	margin(1000000),
+	missed(0)
+{
+
+}
+
+void frame_pacer_t::reset() {
+	deadline = std::chrono::steady_clock::now();
+}
+
+// Sleeps until shortly before the deadline, then spins the rest of the way.
+// The spin margin follows the measured oversleep of the operating system's timer,
+// so coarse timers spin longer and precise timers barely spin at all.
+bool frame_pacer_t::wait(real64_t interval) {
+	const std::chrono::nanoseconds period{ static_cast<sint64_t>(interval * 1000000000.0) };
+	deadline += period;
+	auto now = std::chrono::steady_clock::now();
+	if (now >= deadline) {
+		++missed;
+		// Don't try to catch up after long stalls, otherwise the next frames are rushed.
+		if (now - deadline >= period * kMaxBacklog) {
+			synao_log(
+				"Missed frame deadline by %.2f ms!\n",
+				std::chrono::duration<real64_t, std::milli>(now - deadline).count()
+			);
+			deadline = now;
+		}
+		return false;
+	}
+	if (deadline - now > margin) {
+		const auto wake = deadline - margin;
+		std::this_thread::sleep_until(wake);
+		now = std::chrono::steady_clock::now();
+		const auto oversleep = std::chrono::duration_cast<std::chrono::nanoseconds>(now - wake);
+		margin += (oversleep * 2 - margin) / kMarginWeight;
+		margin = std::clamp(margin, kMinMargin, std::max(kMinMargin, std::min(kMaxMargin, period)));
+	}
+	while (now < deadline) {
+		std::this_thread::yield();
+		now = std::chrono::steady_clock::now();
+	}
+	return true;
+}
+
+arch_t frame_pacer_t::get_missed() const {
+	return missed;
+}
+
+real64_t frame_pacer_t::get_margin() const {
+	return std::chrono::duration<real64_t>(margin).count();
+}
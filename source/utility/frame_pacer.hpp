@@ -0,0 +1,25 @@
+#ifndef LEVIATHAN_INCLUDED_UTILITY_FRAME_PACER_HPP
+#define LEVIATHAN_INCLUDED_UTILITY_FRAME_PACER_HPP
+
+#include <chrono>
+
+#include "../types.hpp"
+
+struct frame_pacer_t : public not_copyable_t {
+public:
+	frame_pacer_t();
+	frame_pacer_t(frame_pacer_t&&) = default;
+	frame_pacer_t& operator=(frame_pacer_t&&) = default;
+	~frame_pacer_t() = default;
+public:
+	void reset();
+	bool wait(real64_t interval);
+	arch_t get_missed() const;
+	real64_t get_margin() const;
+private:
+	std::chrono::steady_clock::time_point deadline;
+	std::chrono::nanoseconds margin;
+	arch_t missed;
+};
+
+#endif // LEVIATHAN_INCLUDED_UTILITY_FRAME_PACER_HPP
@@ -0,0 +1,86 @@
+#include "./frame_stats.hpp"
+
+#include <atomic>
+#include <algorithm>
+
+frame_stats_t::frame_stats_t() :
+	samples(),
+	head(0),
+	count(0)
+{
+
+}
+
+void frame_stats_t::clear() {
+	head = 0;
+	count = 0;
+}
+
+void frame_stats_t::push(const frame_sample_t& sample) {
+	samples[head] = sample;
+	head = (head + 1) % HistoryLength;
+	count = glm::min(count + 1, HistoryLength);
+}
+
+real64_t frame_stats_t::percentile(real64_t fraction) const {
+	if (count == 0) {
+		return 0.0;
+	}
+	std::array<real64_t, HistoryLength> sorted;
+	for (arch_t it = 0; it < count; ++it) {
+		sorted[it] = samples[it].frame;
+	}
+	arch_t index = static_cast<arch_t>(glm::clamp(fraction, 0.0, 1.0) * static_cast<real64_t>(count - 1));
+	std::nth_element(sorted.begin(), sorted.begin() + index, sorted.begin() + count);
+	return sorted[index];
+}
+
+real64_t frame_stats_t::maximum() const {
+	real64_t result = 0.0;
+	for (arch_t it = 0; it < count; ++it) {
+		result = glm::max(result, samples[it].frame);
+	}
+	return result;
+}
+
+// Oldest sample is at index zero.
+real64_t frame_stats_t::at(arch_t index) const {
+	if (index >= count) {
+		return 0.0;
+	}
+	return samples[(head + HistoryLength - count + index) % HistoryLength].frame;
+}
+
+arch_t frame_stats_t::size() const {
+	return count;
+}
+
+const frame_sample_t& frame_stats_t::latest() const {
+	return samples[(head + HistoryLength - 1) % HistoryLength];
+}
+
+static std::atomic<arch_t>& get_upload_bytes() {
+	static std::atomic<arch_t> upload_bytes{ 0 };
+	return upload_bytes;
+}
+
+void frame_stats::add_upload_bytes(arch_t bytes) {
+	get_upload_bytes().fetch_add(bytes, std::memory_order_relaxed);
+}
+
+arch_t frame_stats::take_upload_bytes() {
+	return get_upload_bytes().exchange(0, std::memory_order_relaxed);
+}
+
+static std::atomic<arch_t>& get_stream_bytes() {
+	static std::atomic<arch_t> stream_bytes{ 0 };
+	return stream_bytes;
+}
+
+void frame_stats::add_stream_bytes(arch_t bytes) {
+	get_stream_bytes().fetch_add(bytes, std::memory_order_relaxed);
+}
+
+arch_t frame_stats::take_stream_bytes() {
+	return get_stream_bytes().exchange(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,70 @@
+#ifndef LEVIATHAN_INCLUDED_UTILITY_FRAME_STATS_HPP
+#define LEVIATHAN_INCLUDED_UTILITY_FRAME_STATS_HPP
+
+#include <array>
+
+#include "../types.hpp"
+
+namespace __enum_frame_stage {
+	enum type : arch_t {
+		Update,
+		Handle,
+		Render,
+		Total
+	};
+}
+
+using frame_stage_t = __enum_frame_stage::type;
+
+struct frame_sample_t {
+public:
+	real64_t frame;
+	std::array<real64_t, frame_stage_t::Total> stages;
+	arch_t iterations, uploads, streamed, entities, missed, calls, unbatched;
+public:
+	frame_sample_t() :
+		frame(0.0),
+		stages{},
+		iterations(0),
+		uploads(0),
+		streamed(0),
+		entities(0),
+		missed(0),
+		calls(0),
+		unbatched(0) {}
+	frame_sample_t(const frame_sample_t&) = default;
+	frame_sample_t(frame_sample_t&&) = default;
+	frame_sample_t& operator=(const frame_sample_t&) = default;
+	frame_sample_t& operator=(frame_sample_t&&) = default;
+	~frame_sample_t() = default;
+};
+
+struct frame_stats_t : public not_copyable_t {
+public:
+	frame_stats_t();
+	frame_stats_t(frame_stats_t&&) = default;
+	frame_stats_t& operator=(frame_stats_t&&) = default;
+	~frame_stats_t() = default;
+public:
+	void clear();
+	void push(const frame_sample_t& sample);
+	real64_t percentile(real64_t fraction) const;
+	real64_t maximum() const;
+	real64_t at(arch_t index) const;
+	arch_t size() const;
+	const frame_sample_t& latest() const;
+public:
+	static constexpr arch_t HistoryLength = 120;
+private:
+	std::array<frame_sample_t, HistoryLength> samples;
+	arch_t head, count;
+};
+
+namespace frame_stats {
+	void add_upload_bytes(arch_t bytes);
+	arch_t take_upload_bytes();
+	void add_stream_bytes(arch_t bytes);
+	arch_t take_stream_bytes();
+}
+
+#endif // LEVIATHAN_INCLUDED_UTILITY_FRAME_STATS_HPP
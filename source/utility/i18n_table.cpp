@@ -0,0 +1,258 @@
+#include "./i18n_table.hpp"
+#include "./logger.hpp"
+#include "./profiler.hpp"
+#include "./vfs.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <nlohmann/json.hpp>
+
+static const byte_t kCookedExtension[] = ".lng";
+static const byte_t kSourceExtension[] = ".json";
+
+static constexpr uint64_t kHashBasis = 0xCBF29CE484222325ULL;
+static constexpr uint64_t kHashPrime = 0x00000100000001B3ULL;
+
+// Layout written by scripts/cook_languages.py. The header is followed by the segments
+// sorted by hash, one string reference per entry, and then the UTF-8 text itself.
+struct i18n_header_t {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t segments;
+	uint32_t entries;
+	uint32_t strings;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(i18n_header_t) == 24, "Language pack headers must stay 24 bytes!");
+static_assert(sizeof(archive_string_t) == 8, "Language pack entries must stay 8 bytes!");
+
+i18n_table_t::i18n_table_t() :
+	blob(),
+	segments(),
+	strings(),
+	decoded(),
+	storage()
+{
+
+}
+
+i18n_table_t::i18n_table_t(i18n_table_t&& that) noexcept : i18n_table_t() {
+	if (this != &that) {
+		std::swap(blob, that.blob);
+		std::swap(segments, that.segments);
+		std::swap(strings, that.strings);
+		std::swap(decoded, that.decoded);
+		std::swap(storage, that.storage);
+	}
+}
+
+i18n_table_t& i18n_table_t::operator=(i18n_table_t&& that) noexcept {
+	if (this != &that) {
+		std::swap(blob, that.blob);
+		std::swap(segments, that.segments);
+		std::swap(strings, that.strings);
+		std::swap(decoded, that.decoded);
+		std::swap(storage, that.storage);
+	}
+	return *this;
+}
+
+bool i18n_table_t::load(const std::string& path) {
+	synao_zone("i18n_table_t::load");
+	this->clear();
+	if (vfs::contains(path + kCookedExtension)) {
+		if (this->read(vfs::memory(path + kCookedExtension))) {
+			return true;
+		}
+		synao_warn(Vfs, "Language pack %s%s is invalid! Falling back to its json file.\n", path.c_str(), kCookedExtension);
+		this->clear();
+	}
+	const archive_blob_t source = vfs::memory(path + kSourceExtension);
+	if (source.empty() or !this->parse(source)) {
+		this->clear();
+		return false;
+	}
+	return true;
+}
+
+void i18n_table_t::clear() {
+	blob = archive_blob_t();
+	segments.clear();
+	strings.clear();
+	decoded.clear();
+	storage.clear();
+}
+
+std::string_view i18n_table_t::find(std::string_view segment, arch_t index) const {
+	const i18n_segment_t* result = this->search(segment);
+	if (result == nullptr or index >= result->count) {
+		return std::string_view();
+	}
+	return strings[result->first + index];
+}
+
+std::string_view i18n_table_t::find(std::string_view segment, arch_t first, arch_t last) const {
+	const i18n_segment_t* result = this->search(segment);
+	if (result == nullptr or first > last or last >= result->count) {
+		return std::string_view();
+	}
+	const std::string_view& front = strings[result->first + first];
+	const std::string_view& back = strings[result->first + last];
+	return std::string_view(front.data(), static_cast<arch_t>(back.data() - front.data()) + back.size());
+}
+
+std::u32string_view i18n_table_t::utf32(std::string_view segment, arch_t index) const {
+	const i18n_segment_t* result = this->search(segment);
+	if (result == nullptr or index >= result->count) {
+		return std::u32string_view();
+	}
+	return decoded[result->first + index];
+}
+
+std::u32string_view i18n_table_t::utf32(std::string_view segment, arch_t first, arch_t last) const {
+	const i18n_segment_t* result = this->search(segment);
+	if (result == nullptr or first > last or last >= result->count) {
+		return std::u32string_view();
+	}
+	const std::u32string_view& front = decoded[result->first + first];
+	const std::u32string_view& back = decoded[result->first + last];
+	return std::u32string_view(front.data(), static_cast<arch_t>(back.data() - front.data()) + back.size());
+}
+
+arch_t i18n_table_t::size(std::string_view segment) const {
+	const i18n_segment_t* result = this->search(segment);
+	if (result == nullptr) {
+		return 0;
+	}
+	return result->count;
+}
+
+uint64_t i18n_table_t::hash(std::string_view segment) {
+	uint64_t result = kHashBasis;
+	for (auto&& character : segment) {
+		result ^= static_cast<uint8_t>(character);
+		result *= kHashPrime;
+	}
+	return result;
+}
+
+bool i18n_table_t::read(archive_blob_t&& pack) {
+	archive_reader_t reader{ pack };
+	i18n_header_t header;
+	if (!reader.take(header) or header.magic != i18n_table_t::Magic or header.version != i18n_table_t::Version) {
+		return false;
+	}
+	if (!reader.strings(header.strings)) {
+		return false;
+	}
+	for (uint32_t it = 0; it < header.segments; ++it) {
+		i18n_segment_t& segment = segments.emplace_back();
+		if (!reader.take(segment)) {
+			return false;
+		}
+		if (segment.first > header.entries or segment.count > header.entries - segment.first) {
+			return false;
+		}
+		if (it > 0 and segments[it - 1].hash >= segment.hash) {
+			return false;
+		}
+	}
+	for (uint32_t it = 0; it < header.entries; ++it) {
+		archive_string_t entry;
+		if (!reader.take(entry) or !reader.resolve(entry, strings.emplace_back())) {
+			return false;
+		}
+	}
+	// Ranges are handed out as one view, so each segment has to be laid out back to back.
+	for (auto&& segment : segments) {
+		for (uint32_t it = 1; it < segment.count; ++it) {
+			const std::string_view& prior = strings[segment.first + it - 1];
+			if (prior.data() + prior.size() != strings[segment.first + it].data()) {
+				return false;
+			}
+		}
+	}
+	// Everything is decoded up front so text boxes never have to.
+	std::u32string buffer;
+	std::vector<std::pair<arch_t, arch_t> > spans;
+	spans.reserve(strings.size());
+	for (auto&& string : strings) {
+		const arch_t offset = buffer.size();
+		vfs::to_utf32(string, std::back_inserter(buffer));
+		spans.emplace_back(offset, buffer.size() - offset);
+	}
+	storage.assign(buffer.begin(), buffer.end());
+	decoded.reserve(spans.size());
+	for (auto&& span : spans) {
+		decoded.emplace_back(storage.data() + span.first, span.second);
+	}
+	blob = std::move(pack);
+	return true;
+}
+
+// Builds the same pack scripts/cook_languages.py would, then reads it like any other.
+bool i18n_table_t::parse(const archive_blob_t& source) {
+	nlohmann::json file = nlohmann::json::parse(source.data(), source.data() + source.size(), nullptr, false);
+	if (file.is_discarded() or !file.is_object()) {
+		return false;
+	}
+	std::vector<i18n_segment_t> records;
+	std::vector<archive_string_t> entries;
+	std::string text;
+	for (auto it = file.begin(); it != file.end(); ++it) {
+		if (!it.value().is_array()) {
+			return false;
+		}
+		i18n_segment_t& record = records.emplace_back();
+		record.hash = i18n_table_t::hash(it.key());
+		record.first = static_cast<uint32_t>(entries.size());
+		record.count = static_cast<uint32_t>(it.value().size());
+		for (auto&& value : it.value()) {
+			if (!value.is_string()) {
+				return false;
+			}
+			const std::string& string = value.get_ref<const std::string&>();
+			entries.push_back({
+				static_cast<uint32_t>(text.size()),
+				static_cast<uint32_t>(string.size())
+			});
+			text += string;
+		}
+	}
+	std::sort(records.begin(), records.end(), [](const i18n_segment_t& lhv, const i18n_segment_t& rhv) {
+		return lhv.hash < rhv.hash;
+	});
+	i18n_header_t header;
+	header.magic = i18n_table_t::Magic;
+	header.version = i18n_table_t::Version;
+	header.segments = static_cast<uint32_t>(records.size());
+	header.entries = static_cast<uint32_t>(entries.size());
+	header.strings = static_cast<uint32_t>(text.size());
+	header.reserved = 0;
+	std::vector<byte_t> pack(
+		sizeof(i18n_header_t) +
+		records.size() * sizeof(i18n_segment_t) +
+		entries.size() * sizeof(archive_string_t) +
+		text.size()
+	);
+	byte_t* cursor = pack.data();
+	std::memcpy(cursor, &header, sizeof(i18n_header_t));
+	cursor += sizeof(i18n_header_t);
+	cursor = std::copy_n(reinterpret_cast<const byte_t*>(records.data()), records.size() * sizeof(i18n_segment_t), cursor);
+	cursor = std::copy_n(reinterpret_cast<const byte_t*>(entries.data()), entries.size() * sizeof(archive_string_t), cursor);
+	std::copy(text.begin(), text.end(), cursor);
+	return this->read(archive_blob_t(std::move(pack)));
+}
+
+const i18n_segment_t* i18n_table_t::search(std::string_view segment) const {
+	const uint64_t key = i18n_table_t::hash(segment);
+	auto it = std::lower_bound(
+		segments.begin(), segments.end(), key,
+		[](const i18n_segment_t& entry, uint64_t value) { return entry.hash < value; }
+	);
+	if (it == segments.end() or it->hash != key) {
+		return nullptr;
+	}
+	return &(*it);
+}
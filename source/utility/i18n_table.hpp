@@ -0,0 +1,51 @@
+#ifndef LEVIATHAN_INCLUDED_UTILITY_I18N_TABLE_HPP
+#define LEVIATHAN_INCLUDED_UTILITY_I18N_TABLE_HPP
+
+#include <vector>
+#include <string>
+#include <string_view>
+
+#include "./archive.hpp"
+
+struct i18n_segment_t {
+	uint64_t hash;
+	uint32_t first;
+	uint32_t count;
+};
+
+static_assert(sizeof(i18n_segment_t) == 16, "Language pack segments must stay 16 bytes!");
+
+// Every string of a language, interned into one UTF-8 blob. It's read in place from the pack
+// that scripts/cook_languages.py writes when there is one, or else built out of the json file.
+// Strings in a segment are stored back to back, so ranges are views too.
+struct i18n_table_t : public not_copyable_t {
+public:
+	i18n_table_t();
+	i18n_table_t(i18n_table_t&& that) noexcept;
+	i18n_table_t& operator=(i18n_table_t&& that) noexcept;
+	~i18n_table_t() = default;
+public:
+	bool load(const std::string& path);
+	void clear();
+	std::string_view find(std::string_view segment, arch_t index) const;
+	std::string_view find(std::string_view segment, arch_t first, arch_t last) const;
+	std::u32string_view utf32(std::string_view segment, arch_t index) const;
+	std::u32string_view utf32(std::string_view segment, arch_t first, arch_t last) const;
+	arch_t size(std::string_view segment) const;
+	static uint64_t hash(std::string_view segment);
+public:
+	static constexpr uint32_t Magic = 0x474E4C4C;
+	static constexpr uint32_t Version = 1;
+private:
+	bool read(archive_blob_t&& pack);
+	bool parse(const archive_blob_t& source);
+	const i18n_segment_t* search(std::string_view segment) const;
+private:
+	archive_blob_t blob;
+	std::vector<i18n_segment_t> segments;
+	std::vector<std::string_view> strings;
+	std::vector<std::u32string_view> decoded;
+	std::vector<char32_t> storage;
+};
+
+#endif // LEVIATHAN_INCLUDED_UTILITY_I18N_TABLE_HPP
@@ -0,0 +1,376 @@
+#include "./job_system.hpp"
+#include "./logger.hpp"
+#include "./profiler.hpp"
+
+#include <algorithm>
+
+static constexpr arch_t kJobCapacity 	= 1 << 12;
+static constexpr arch_t kReservedThreads = 2;
+static constexpr arch_t kNotWorker 		= ~static_cast<arch_t>(0);
+
+static_assert((kJobCapacity & (kJobCapacity - 1)) == 0, "Job capacity must be a power of two!");
+
+// Bounded multi-producer multi-consumer ring of job indices. Used as the free list
+// and as the injection queue for threads that don't own a deque.
+struct job_ring_t {
+public:
+	job_ring_t() :
+		cells(std::make_unique<cell_t[]>(kJobCapacity)),
+		enqueue_position(0),
+		dequeue_position(0)
+	{
+		for (arch_t it = 0; it < kJobCapacity; ++it) {
+			cells[it].sequence.store(it, std::memory_order_relaxed);
+		}
+	}
+public:
+	bool enqueue(uint32_t value) {
+		cell_t* cell = nullptr;
+		arch_t position = enqueue_position.load(std::memory_order_relaxed);
+		while (true) {
+			cell = &cells[position & (kJobCapacity - 1)];
+			arch_t sequence = cell->sequence.load(std::memory_order_acquire);
+			sint64_t difference = static_cast<sint64_t>(sequence) - static_cast<sint64_t>(position);
+			if (difference == 0) {
+				if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (difference < 0) {
+				return false;
+			} else {
+				position = enqueue_position.load(std::memory_order_relaxed);
+			}
+		}
+		cell->value = value;
+		cell->sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+	bool dequeue(uint32_t& value) {
+		cell_t* cell = nullptr;
+		arch_t position = dequeue_position.load(std::memory_order_relaxed);
+		while (true) {
+			cell = &cells[position & (kJobCapacity - 1)];
+			arch_t sequence = cell->sequence.load(std::memory_order_acquire);
+			sint64_t difference = static_cast<sint64_t>(sequence) - static_cast<sint64_t>(position + 1);
+			if (difference == 0) {
+				if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (difference < 0) {
+				return false;
+			} else {
+				position = dequeue_position.load(std::memory_order_relaxed);
+			}
+		}
+		value = cell->value;
+		cell->sequence.store(position + kJobCapacity, std::memory_order_release);
+		return true;
+	}
+private:
+	struct cell_t {
+		std::atomic<arch_t> sequence;
+		uint32_t value;
+	};
+	std::unique_ptr<cell_t[]> cells;
+	alignas(64) std::atomic<arch_t> enqueue_position;
+	alignas(64) std::atomic<arch_t> dequeue_position;
+};
+
+// Chase-Lev deque. The owning worker pushes and pops at the bottom,
+// everyone else steals from the top. It can hold every job in the pool,
+// so pushing should never fail.
+struct job_deque_t {
+public:
+	job_deque_t() :
+		items(std::make_unique<std::atomic<uint32_t>[]>(kJobCapacity)),
+		top(0),
+		bottom(0)
+	{
+
+	}
+public:
+	bool push(uint32_t value) {
+		sint64_t b = bottom.load(std::memory_order_relaxed);
+		if (b - top.load(std::memory_order_acquire) >= static_cast<sint64_t>(kJobCapacity)) {
+			return false;
+		}
+		items[b & (kJobCapacity - 1)].store(value, std::memory_order_relaxed);
+		bottom.store(b + 1, std::memory_order_release);
+		return true;
+	}
+	bool pop(uint32_t& value) {
+		sint64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		sint64_t t = top.load(std::memory_order_relaxed);
+		if (t > b) {
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+		value = items[b & (kJobCapacity - 1)].load(std::memory_order_relaxed);
+		if (t == b) {
+			// Last item, so race any thieves for it.
+			bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return won;
+		}
+		return true;
+	}
+	bool steal(uint32_t& value) {
+		sint64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		sint64_t b = bottom.load(std::memory_order_acquire);
+		if (t >= b) {
+			return false;
+		}
+		value = items[t & (kJobCapacity - 1)].load(std::memory_order_relaxed);
+		return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+private:
+	std::unique_ptr<std::atomic<uint32_t>[]> items;
+	alignas(64) std::atomic<sint64_t> top;
+	alignas(64) std::atomic<sint64_t> bottom;
+};
+
+static std::atomic<job_system_t*> device{ nullptr };
+static thread_local const job_system_t* current_system = nullptr;
+static thread_local arch_t current_worker = kNotWorker;
+static thread_local job_priority_t current_priority = job_priority_t::Urgent;
+
+job_counter_t::job_counter_t() :
+	pending(0),
+	attached(false)
+{
+
+}
+
+job_counter_t::job_counter_t(job_counter_t&& that) noexcept : job_counter_t() {
+	if (this != &that) {
+		pending.store(that.pending.exchange(pending.load()));
+		attached.store(that.attached.exchange(attached.load()));
+	}
+}
+
+job_counter_t& job_counter_t::operator=(job_counter_t&& that) noexcept {
+	if (this != &that) {
+		pending.store(that.pending.exchange(pending.load()));
+		attached.store(that.attached.exchange(attached.load()));
+	}
+	return *this;
+}
+
+job_counter_t::~job_counter_t() {
+	this->wait();
+}
+
+bool job_counter_t::valid() const {
+	return attached.load(std::memory_order_acquire);
+}
+
+bool job_counter_t::finished() const {
+	return pending.load(std::memory_order_acquire) == 0;
+}
+
+void job_counter_t::wait() const {
+	while (!this->finished()) {
+		job_system_t* it = device.load(std::memory_order_acquire);
+		if (it == nullptr or !it->help()) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void job_counter_t::reset() {
+	this->wait();
+	attached.store(false, std::memory_order_release);
+}
+
+job_system_t::job_system_t() :
+	jobs(),
+	available(),
+	injected(),
+	deques(),
+	threads(),
+	running(false),
+	queued(0),
+	sleeping(0),
+	sleep_mutex(),
+	sleep_signal()
+{
+
+}
+
+job_system_t::~job_system_t() {
+	this->destroy();
+}
+
+bool job_system_t::init(arch_t count) {
+	job_system_t* expected = nullptr;
+	if (!device.compare_exchange_strong(expected, this, std::memory_order_acq_rel)) {
+		synao_log("Error! Another job system already exists!\n");
+		return false;
+	}
+	if (count == 0) {
+		// Main and simulation threads are already busy, so leave them their cores.
+		const arch_t hardware = std::thread::hardware_concurrency();
+		count = hardware > kReservedThreads ? hardware - kReservedThreads : 1;
+	}
+	jobs = std::make_unique<job_t[]>(kJobCapacity);
+	available = std::make_unique<job_ring_t>();
+	for (arch_t it = 0; it < kJobCapacity; ++it) {
+		available->enqueue(static_cast<uint32_t>(it));
+	}
+	for (auto&& ring : injected) {
+		ring = std::make_unique<job_ring_t>();
+	}
+	deques.resize(count * job_priority_t::Total);
+	for (auto&& deque : deques) {
+		deque = std::make_unique<job_deque_t>();
+	}
+	running.store(true, std::memory_order_release);
+	threads.resize(count);
+	for (arch_t it = 0; it < count; ++it) {
+		threads[it] = std::thread(&job_system_t::work, this, it);
+	}
+	synao_info(General, "Job system started with %zu workers.\n", count);
+	return true;
+}
+
+void job_system_t::destroy() {
+	if (running.exchange(false)) {
+		{
+			std::lock_guard<std::mutex> lock{ sleep_mutex };
+		}
+		sleep_signal.notify_all();
+		for (auto&& thread : threads) {
+			if (thread.joinable()) {
+				thread.join();
+			}
+		}
+		// Anything left over still owes its counter, so finish it here.
+		uint32_t index = 0;
+		while (this->acquire(kNotWorker, index)) {
+			this->execute(index);
+		}
+		threads.clear();
+	}
+	job_system_t* expected = this;
+	device.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+}
+
+bool job_system_t::help() {
+	uint32_t index = 0;
+	const arch_t worker = current_system == this ? current_worker : kNotWorker;
+	if (this->acquire(worker, index)) {
+		this->execute(index);
+		return true;
+	}
+	return false;
+}
+
+arch_t job_system_t::get_worker_count() const {
+	return threads.size();
+}
+
+job_t* job_system_t::allocate() {
+	uint32_t index = 0;
+	if (!running.load(std::memory_order_acquire) or !available->dequeue(index)) {
+		return nullptr;
+	}
+	return &jobs[index];
+}
+
+void job_system_t::submit(job_priority_t priority, job_t* job) {
+	const uint32_t index = static_cast<uint32_t>(job - jobs.get());
+	// Work spawned by a job never outranks it, so background prefetching stays in the background.
+	priority = std::max(priority, current_priority);
+	job->priority = priority;
+	// Count it before publishing so a sleeping worker can't miss it.
+	queued.fetch_add(1, std::memory_order_seq_cst);
+	bool pushed = false;
+	if (current_system == this and current_worker != kNotWorker) {
+		pushed = deques[current_worker * job_priority_t::Total + priority]->push(index);
+	} else {
+		pushed = injected[priority]->enqueue(index);
+	}
+	if (!pushed) {
+		// Every queue can hold the whole pool, so this is a bug, but running it here beats dropping it.
+		synao_error(General, "Job queue is full! Running the job inline instead.\n");
+		queued.fetch_sub(1, std::memory_order_relaxed);
+		this->execute(index);
+		return;
+	}
+	if (sleeping.load(std::memory_order_seq_cst) > 0) {
+		{
+			std::lock_guard<std::mutex> lock{ sleep_mutex };
+		}
+		sleep_signal.notify_one();
+	}
+}
+
+void job_system_t::execute(uint32_t index) {
+	job_t& job = jobs[index];
+	const job_priority_t previous = current_priority;
+	current_priority = job.priority;
+	job.invoke(job.storage);
+	current_priority = previous;
+	job.destroy(job.storage);
+	job_counter_t* counter = job.counter;
+	available->enqueue(index);
+	this->complete(counter);
+}
+
+void job_system_t::complete(job_counter_t* counter) {
+	if (counter != nullptr) {
+		counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+	}
+}
+
+bool job_system_t::acquire(arch_t worker, uint32_t& index) {
+	const arch_t count = threads.size();
+	for (arch_t priority = 0; priority < job_priority_t::Total; ++priority) {
+		// Threads outside the pool only help with work someone is waiting on.
+		if (worker == kNotWorker and priority == job_priority_t::Background and running.load(std::memory_order_relaxed)) {
+			break;
+		}
+		bool found = false;
+		if (worker != kNotWorker) {
+			found = deques[worker * job_priority_t::Total + priority]->pop(index);
+		}
+		if (!found) {
+			found = injected[priority]->dequeue(index);
+		}
+		for (arch_t it = 1; !found and it <= count; ++it) {
+			const arch_t victim = worker == kNotWorker ? it - 1 : (worker + it) % count;
+			if (victim != worker) {
+				found = deques[victim * job_priority_t::Total + priority]->steal(index);
+			}
+		}
+		if (found) {
+			queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+void job_system_t::work(arch_t worker) {
+	synao_thread("job_system_t::worker");
+	current_system = this;
+	current_worker = worker;
+	uint32_t index = 0;
+	while (running.load(std::memory_order_acquire)) {
+		if (this->acquire(worker, index)) {
+			this->execute(index);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock{ sleep_mutex };
+		sleeping.fetch_add(1, std::memory_order_seq_cst);
+		while (running.load(std::memory_order_acquire) and queued.load(std::memory_order_seq_cst) == 0) {
+			sleep_signal.wait(lock);
+		}
+		sleeping.fetch_sub(1, std::memory_order_relaxed);
+	}
+	current_system = nullptr;
+	current_worker = kNotWorker;
+}
@@ -0,0 +1,122 @@
+#ifndef LEVIATHAN_INCLUDED_UTILITY_JOB_SYSTEM_HPP
+#define LEVIATHAN_INCLUDED_UTILITY_JOB_SYSTEM_HPP
+
+#include <new>
+#include <cstddef>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+#include "../types.hpp"
+
+namespace __enum_job_priority {
+	enum type : arch_t {
+		Urgent,
+		Normal,
+		Background,
+		Total
+	};
+}
+
+using job_priority_t = __enum_job_priority::type;
+
+struct job_system_t;
+struct job_deque_t;
+struct job_ring_t;
+
+// Counts unfinished jobs attached to it, so callers can fork work and join on it later.
+// Jobs keep a pointer to their counter, which therefore can't move while any are pending.
+struct job_counter_t : public not_copyable_t {
+public:
+	job_counter_t();
+	job_counter_t(job_counter_t&& that) noexcept;
+	job_counter_t& operator=(job_counter_t&& that) noexcept;
+	~job_counter_t();
+public:
+	bool valid() const;
+	bool finished() const;
+	void wait() const;
+	void reset();
+private:
+	friend struct job_system_t;
+	std::atomic<arch_t> pending;
+	std::atomic<bool> attached;
+};
+
+// Callables are stored inline, so pushing a job never touches the heap. That only
+// leaves room for a few pointers or indices, so anything bigger has to stay with
+// whoever pushed the job. Each slot fills exactly one cache line.
+struct alignas(64) job_t {
+public:
+	static constexpr arch_t Storage = 32;
+public:
+	void (*invoke)(byte_t*);
+	void (*destroy)(byte_t*);
+	job_counter_t* counter;
+	job_priority_t priority;
+	alignas(std::max_align_t) byte_t storage[Storage];
+};
+
+static_assert(sizeof(job_t) == 64, "Job slots must fill exactly one cache line!");
+
+struct job_system_t : public not_copyable_t {
+public:
+	job_system_t();
+	job_system_t(job_system_t&&) = delete;
+	job_system_t& operator=(job_system_t&&) = delete;
+	~job_system_t();
+public:
+	bool init(arch_t count);
+	void destroy();
+	bool help();
+	arch_t get_worker_count() const;
+	template<typename Func>
+	void push(job_priority_t priority, job_counter_t* counter, Func&& func) {
+		using callable_t = std::decay_t<Func>;
+		static_assert(sizeof(callable_t) <= job_t::Storage, "Job callable is too large for inline storage!");
+		static_assert(alignof(callable_t) <= alignof(std::max_align_t), "Job callable is overaligned!");
+		if (counter != nullptr) {
+			counter->pending.fetch_add(1, std::memory_order_relaxed);
+			counter->attached.store(true, std::memory_order_relaxed);
+		}
+		job_t* job = this->allocate();
+		if (job == nullptr) {
+			// Pool is exhausted or workers are gone, so run it here rather than block.
+			callable_t callable{ std::forward<Func>(func) };
+			callable();
+			this->complete(counter);
+			return;
+		}
+		new (job->storage) callable_t{ std::forward<Func>(func) };
+		job->invoke = [](byte_t* storage) {
+			(*std::launder(reinterpret_cast<callable_t*>(storage)))();
+		};
+		job->destroy = [](byte_t* storage) {
+			std::launder(reinterpret_cast<callable_t*>(storage))->~callable_t();
+		};
+		job->counter = counter;
+		this->submit(priority, job);
+	}
+private:
+	job_t* allocate();
+	void submit(job_priority_t priority, job_t* job);
+	void execute(uint32_t index);
+	void complete(job_counter_t* counter);
+	bool acquire(arch_t worker, uint32_t& index);
+	void work(arch_t worker);
+private:
+	std::unique_ptr<job_t[]> jobs;
+	std::unique_ptr<job_ring_t> available;
+	std::unique_ptr<job_ring_t> injected[job_priority_t::Total];
+	std::vector<std::unique_ptr<job_deque_t> > deques;
+	std::vector<std::thread> threads;
+	std::atomic<bool> running;
+	std::atomic<arch_t> queued, sleeping;
+	std::mutex sleep_mutex;
+	std::condition_variable sleep_signal;
+};
+
+#endif // LEVIATHAN_INCLUDED_UTILITY_JOB_SYSTEM_HPP
@@ -0,0 +1,227 @@
+#include "./logger.hpp"
+#include "./setup_file.hpp"
+#include "./vfs.hpp"
+
+#include <chrono>
+#include <cstring>
+
+static constexpr arch_t kRingLength 	= 1 << 10;
+static constexpr arch_t kSlotLength 	= 256;
+static constexpr arch_t kFileLimit 		= 1 << 20;
+static constexpr arch_t kFileCount 		= 3;
+static constexpr sint_t kDrainDelay 	= 4;
+static constexpr byte_t kLogName[] 		= "log";
+
+static_assert((kRingLength & (kRingLength - 1)) == 0, "Ring length must be a power of two!");
+
+static const byte_t* const kLevelNames[log_level_t::Total] = {
+	"DEBUG", "INFO", "WARN", "ERROR"
+};
+
+static const byte_t* const kCategoryNames[log_category_t::Total] = {
+	"general", "video", "audio", "music", "script", "field", "vfs", "input"
+};
+
+// A slot is free for the producer whose position equals its sequence,
+// and ready for the consumer once the sequence is one past that position.
+struct log_slot_t {
+	std::atomic<arch_t> sequence;
+	log_level_t level;
+	log_category_t category;
+	sint64_t timestamp;
+	byte_t text[kSlotLength];
+};
+
+static std::atomic<logger_t*> device{ nullptr };
+
+static sint64_t get_timestamp() {
+	static const auto epoch = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - epoch
+	).count();
+}
+
+static std::string get_rotated_path(const std::string& directory, arch_t index) {
+	if (index == 0) {
+		return directory + kLogName + ".txt";
+	}
+	return directory + kLogName + '.' + std::to_string(index) + ".txt";
+}
+
+logger_t::logger_t() :
+	slots(std::make_unique<log_slot_t[]>(kRingLength)),
+	enqueue(0),
+	dropped(0),
+	threshold(log_level_t::Debug),
+	running(false),
+	dequeue(0),
+	thread(),
+	sink_mutex(),
+	sink(stdout),
+	sink_path(),
+	sink_bytes(0)
+{
+	for (arch_t it = 0; it < kRingLength; ++it) {
+		slots[it].sequence.store(it, std::memory_order_relaxed);
+	}
+}
+
+logger_t::~logger_t() {
+	if (device.load(std::memory_order_acquire) == this) {
+		device.store(nullptr, std::memory_order_release);
+	}
+	if (running.exchange(false)) {
+		thread.join();
+	}
+	this->flush();
+	arch_t lost = dropped.load(std::memory_order_relaxed);
+	if (lost > 0) {
+		std::fprintf(sink, "Logger dropped %zu messages!\n", lost);
+	}
+	if (sink != stdout) {
+		std::fclose(sink);
+	}
+}
+
+bool logger_t::init() {
+	logger_t* expected = nullptr;
+	if (!device.compare_exchange_strong(expected, this, std::memory_order_acq_rel)) {
+		std::printf("Error! Another logger already exists!\n");
+		return false;
+	}
+	running.store(true, std::memory_order_release);
+	thread = std::thread(&logger_t::drain, this);
+	return true;
+}
+
+void logger_t::configure(const setup_file_t& config) {
+	sint_t level = log_level_t::Debug;
+	config.get("Setup", "LogLevel", level);
+	level = glm::clamp(level, 0, static_cast<sint_t>(log_level_t::Error));
+	threshold.store(static_cast<log_level_t>(level), std::memory_order_relaxed);
+	bool_t log_file = false;
+	config.get("Setup", "LogFile", log_file);
+	if (log_file) {
+		std::lock_guard<std::mutex> lock{ sink_mutex };
+		const std::string directory = vfs::resource_path(vfs_resource_path_t::Init);
+		if (!this->open(directory)) {
+			std::printf("Warning! Couldn't open log file in \"%s\"!\n", directory.c_str());
+		}
+	}
+}
+
+void logger_t::push(log_level_t level, log_category_t category, const byte_t* format, std::va_list args) {
+	if (level < threshold.load(std::memory_order_relaxed)) {
+		return;
+	}
+	log_slot_t* slot = nullptr;
+	arch_t position = enqueue.load(std::memory_order_relaxed);
+	while (true) {
+		slot = &slots[position & (kRingLength - 1)];
+		arch_t sequence = slot->sequence.load(std::memory_order_acquire);
+		sint64_t difference = static_cast<sint64_t>(sequence) - static_cast<sint64_t>(position);
+		if (difference == 0) {
+			if (enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if (difference < 0) {
+			// Ring is full, so dropping beats stalling the caller.
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		} else {
+			position = enqueue.load(std::memory_order_relaxed);
+		}
+	}
+	slot->level = level;
+	slot->category = category;
+	slot->timestamp = get_timestamp();
+	std::vsnprintf(slot->text, kSlotLength, format, args);
+	slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+void logger_t::drain() {
+	while (running.load(std::memory_order_acquire)) {
+		if (this->flush() == 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(kDrainDelay));
+		}
+	}
+}
+
+arch_t logger_t::flush() {
+	std::lock_guard<std::mutex> lock{ sink_mutex };
+	arch_t count = 0;
+	while (true) {
+		log_slot_t& slot = slots[dequeue & (kRingLength - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != dequeue + 1) {
+			break;
+		}
+		this->write(slot);
+		slot.sequence.store(dequeue + kRingLength, std::memory_order_release);
+		++dequeue;
+		++count;
+	}
+	if (count > 0) {
+		std::fflush(sink);
+	}
+	return count;
+}
+
+void logger_t::write(const log_slot_t& slot) {
+	const arch_t length = std::strlen(slot.text);
+	sint_t result = std::fprintf(
+		sink, "[%10.3f] %-5s %-7s: %s%s",
+		static_cast<real64_t>(slot.timestamp) / 1000000.0,
+		kLevelNames[slot.level],
+		kCategoryNames[slot.category],
+		slot.text,
+		(length > 0 and slot.text[length - 1] == '\n') ? "" : "\n"
+	);
+	if (sink != stdout and result > 0) {
+		sink_bytes += static_cast<arch_t>(result);
+		if (sink_bytes >= kFileLimit) {
+			this->rotate();
+		}
+	}
+}
+
+bool logger_t::open(const std::string& path) {
+	std::FILE* file = std::fopen(get_rotated_path(path, 0).c_str(), "w");
+	if (file == nullptr) {
+		return false;
+	}
+	if (sink != stdout) {
+		std::fclose(sink);
+	}
+	sink = file;
+	sink_path = path;
+	sink_bytes = 0;
+	return true;
+}
+
+void logger_t::rotate() {
+	std::fclose(sink);
+	sink = stdout;
+	std::remove(get_rotated_path(sink_path, kFileCount - 1).c_str());
+	for (arch_t it = kFileCount - 1; it > 0; --it) {
+		std::rename(
+			get_rotated_path(sink_path, it - 1).c_str(),
+			get_rotated_path(sink_path, it).c_str()
+		);
+	}
+	if (!this->open(sink_path)) {
+		std::printf("Warning! Couldn't rotate log file in \"%s\"!\n", sink_path.c_str());
+	}
+}
+
+void logger::push(log_level_t level, log_category_t category, const byte_t* format, ...) {
+	std::va_list args;
+	va_start(args, format);
+	logger_t* it = device.load(std::memory_order_acquire);
+	if (it != nullptr) {
+		it->push(level, category, format, args);
+	} else {
+		// Nothing drains the ring before init or after shutdown, so print directly.
+		std::vprintf(format, args);
+	}
+	va_end(args);
+}
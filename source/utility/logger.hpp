@@ -2,14 +2,102 @@
 #define LEVIATHAN_INCLUDED_UTILITY_LOGGER_HPP
 
 #include <cstdio>
+#include <cstdarg>
 #include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
 
 #include "../types.hpp"
 
+// Lets the compiler check synao_* arguments against their format string.
+#if defined(LEVIATHAN_COMPILER_GNUC) || defined(LEVIATHAN_COMPILER_LLVM)
+	#define LEVIATHAN_PRINTF_STRING
+	#define LEVIATHAN_PRINTF_FUNCTION(FORMAT, ARGUMENTS) __attribute__((format(printf, FORMAT, ARGUMENTS)))
+#elif defined(LEVIATHAN_COMPILER_MSVC)
+	#include <sal.h>
+	#define LEVIATHAN_PRINTF_STRING _Printf_format_string_
+	#define LEVIATHAN_PRINTF_FUNCTION(FORMAT, ARGUMENTS)
+#else
+	#define LEVIATHAN_PRINTF_STRING
+	#define LEVIATHAN_PRINTF_FUNCTION(FORMAT, ARGUMENTS)
+#endif
+
+namespace __enum_log_level {
+	enum type : arch_t {
+		Debug,
+		Info,
+		Warning,
+		Error,
+		Total
+	};
+}
+
+using log_level_t = __enum_log_level::type;
+
+namespace __enum_log_category {
+	enum type : arch_t {
+		General,
+		Video,
+		Audio,
+		Music,
+		Script,
+		Field,
+		Vfs,
+		Input,
+		Total
+	};
+}
+
+using log_category_t = __enum_log_category::type;
+
+struct setup_file_t;
+struct log_slot_t;
+
+struct logger_t : public not_copyable_t {
+public:
+	logger_t();
+	logger_t(logger_t&&) = delete;
+	logger_t& operator=(logger_t&&) = delete;
+	~logger_t();
+public:
+	bool init();
+	void configure(const setup_file_t& config);
+	void push(log_level_t level, log_category_t category, const byte_t* format, std::va_list args) LEVIATHAN_PRINTF_FUNCTION(4, 0);
+private:
+	void drain();
+	arch_t flush();
+	void write(const log_slot_t& slot);
+	bool open(const std::string& path);
+	void rotate();
+private:
+	std::unique_ptr<log_slot_t[]> slots;
+	std::atomic<arch_t> enqueue, dropped;
+	std::atomic<log_level_t> threshold;
+	std::atomic<bool> running;
+	arch_t dequeue;
+	std::thread thread;
+	std::mutex sink_mutex;
+	std::FILE* sink;
+	std::string sink_path;
+	arch_t sink_bytes;
+};
+
+namespace logger {
+	void push(log_level_t level, log_category_t category, LEVIATHAN_PRINTF_STRING const byte_t* format, ...) LEVIATHAN_PRINTF_FUNCTION(3, 4);
+}
+
+// Producers only claim a slot and format into it; the drain thread does the I/O.
+// Debug messages are stripped from release builds, everything else is kept.
 #ifdef LEVIATHAN_BUILD_DEBUG
-	#define synao_log(...) do { sint_t _r = std::printf(__VA_ARGS__); assert(_r >= 0); } while(false)
+	#define synao_log(...) logger::push(log_level_t::Debug, log_category_t::General, __VA_ARGS__)
 #else
 	#define synao_log(...)
 #endif
 
+#define synao_info(CATEGORY, ...) logger::push(log_level_t::Info, log_category_t::CATEGORY, __VA_ARGS__)
+#define synao_warn(CATEGORY, ...) logger::push(log_level_t::Warning, log_category_t::CATEGORY, __VA_ARGS__)
+#define synao_error(CATEGORY, ...) logger::push(log_level_t::Error, log_category_t::CATEGORY, __VA_ARGS__)
+
 #endif // LEVIATHAN_INCLUDED_UTILITY_LOGGER_HPP
@@ -0,0 +1,141 @@
+#include "./profiler.hpp"
+#include "./logger.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+
+static constexpr arch_t kRingLength = 1 << 15;
+
+static_assert((kRingLength & (kRingLength - 1)) == 0, "Ring length must be a power of two!");
+
+struct profiler_event_t {
+	const byte_t* name;
+	sint64_t begin, end;
+};
+
+// Each thread owns one ring and is its only writer, so its lock is only ever
+// contended while a dump copies the ring. Rings are kept alive by the registry
+// after their threads exit.
+struct profiler_ring_t : public not_copyable_t {
+public:
+	profiler_ring_t(arch_t identity) :
+		identity(identity),
+		name(nullptr),
+		head(0),
+		events(kRingLength),
+		mutex()
+	{
+
+	}
+public:
+	void push(const byte_t* name, sint64_t begin, sint64_t end) {
+		std::lock_guard<std::mutex> lock{ mutex };
+		events[head & (kRingLength - 1)] = { name, begin, end };
+		++head;
+	}
+	void rename(const byte_t* name) {
+		std::lock_guard<std::mutex> lock{ mutex };
+		this->name = name;
+	}
+	const byte_t* snapshot(std::vector<profiler_event_t>& output) {
+		std::lock_guard<std::mutex> lock{ mutex };
+		const arch_t count = std::min(head, kRingLength);
+		output.clear();
+		output.reserve(count);
+		for (arch_t it = head - count; it < head; ++it) {
+			output.push_back(events[it & (kRingLength - 1)]);
+		}
+		return name;
+	}
+public:
+	arch_t identity;
+private:
+	const byte_t* name;
+	arch_t head;
+	std::vector<profiler_event_t> events;
+	std::mutex mutex;
+};
+
+static std::mutex& get_registry_mutex() {
+	static std::mutex registry_mutex;
+	return registry_mutex;
+}
+
+static std::vector<std::unique_ptr<profiler_ring_t> >& get_registry() {
+	static std::vector<std::unique_ptr<profiler_ring_t> > registry;
+	return registry;
+}
+
+static profiler_ring_t* get_local_ring() {
+	thread_local profiler_ring_t* ring = nullptr;
+	if (ring == nullptr) {
+		std::lock_guard<std::mutex> lock{ get_registry_mutex() };
+		auto& registry = get_registry();
+		ring = registry.emplace_back(std::make_unique<profiler_ring_t>(registry.size())).get();
+	}
+	return ring;
+}
+
+profiler_zone_t::profiler_zone_t(const byte_t* name) :
+	name(name),
+	begin(profiler::timestamp())
+{
+
+}
+
+profiler_zone_t::~profiler_zone_t() {
+	get_local_ring()->push(name, begin, profiler::timestamp());
+}
+
+sint64_t profiler::timestamp() {
+	static const auto epoch = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - epoch
+	).count();
+}
+
+void profiler::thread_name(const byte_t* name) {
+	get_local_ring()->rename(name);
+}
+
+// Writes the Chrome "Trace Event" format, which Perfetto also reads.
+// Each ring is copied under its own lock, so threads that are still running only
+// wait for that copy, and never for the file to be written.
+bool profiler::dump(const std::string& path) {
+	std::ofstream ofs(path, std::ofstream::out);
+	if (!ofs.is_open()) {
+		synao_log("Failed to open profiler trace at %s!\n", path.c_str());
+		return false;
+	}
+	ofs << std::fixed << std::setprecision(3);
+	ofs << "{\"traceEvents\":[\n";
+	bool first = true;
+	arch_t total = 0;
+	std::vector<profiler_event_t> events;
+	std::lock_guard<std::mutex> lock{ get_registry_mutex() };
+	for (auto&& ring : get_registry()) {
+		const byte_t* name = ring->snapshot(events);
+		if (name != nullptr) {
+			ofs << (first ? "" : ",\n");
+			ofs << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << ring->identity;
+			ofs << ",\"args\":{\"name\":\"" << name << "\"}}";
+			first = false;
+		}
+		for (auto&& event : events) {
+			ofs << (first ? "" : ",\n");
+			ofs << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << ring->identity;
+			ofs << ",\"ts\":" << static_cast<real64_t>(event.begin) / 1000.0;
+			ofs << ",\"dur\":" << static_cast<real64_t>(event.end - event.begin) / 1000.0 << "}";
+			first = false;
+		}
+		total += events.size();
+	}
+	ofs << "\n]}\n";
+	synao_log("Dumped %zu profiler events to %s.\n", total, path.c_str());
+	return true;
+}
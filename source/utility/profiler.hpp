@@ -0,0 +1,36 @@
+#ifndef LEVIATHAN_INCLUDED_UTILITY_PROFILER_HPP
+#define LEVIATHAN_INCLUDED_UTILITY_PROFILER_HPP
+
+#include <string>
+
+#include "../types.hpp"
+
+struct profiler_zone_t : public not_copyable_t {
+public:
+	profiler_zone_t(const byte_t* name);
+	profiler_zone_t(profiler_zone_t&&) = delete;
+	profiler_zone_t& operator=(profiler_zone_t&&) = delete;
+	~profiler_zone_t();
+private:
+	const byte_t* name;
+	sint64_t begin;
+};
+
+namespace profiler {
+	sint64_t timestamp();
+	void thread_name(const byte_t* name);
+	bool dump(const std::string& path);
+}
+
+// Zone and thread names must be string literals, since only the pointer is stored.
+#ifdef LEVIATHAN_USES_PROFILER
+	#define SYNAO_ZONE_CONCAT_IMPL(A, B) A##B
+	#define SYNAO_ZONE_CONCAT(A, B) SYNAO_ZONE_CONCAT_IMPL(A, B)
+	#define synao_zone(NAME) profiler_zone_t SYNAO_ZONE_CONCAT(_synao_zone_, __LINE__)(NAME)
+	#define synao_thread(NAME) profiler::thread_name(NAME)
+#else
+	#define synao_zone(NAME)
+	#define synao_thread(NAME)
+#endif
+
+#endif // LEVIATHAN_INCLUDED_UTILITY_PROFILER_HPP
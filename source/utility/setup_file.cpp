@@ -1,19 +1,20 @@
 #include "./setup_file.hpp"
+#include "./vfs.hpp"
 
 #include <fstream>
 
 setup_chunk_t::setup_chunk_t(const std::string& title) : 
 	title(title),
-	data() 
+	data(),
+	indices()
 {
 
 }
 
 std::string setup_chunk_t::get(const std::string& key) const {
-	for (auto&& pair : data) {
-		if (pair.first == key) {
-			return pair.second;
-		}
+	const std::string* value = this->find(key);
+	if (value != nullptr) {
+		return *value;
 	}
 	return std::string();
 }
@@ -25,6 +26,14 @@ std::string setup_chunk_t::get(arch_t index) const {
 	return std::string();
 }
 
+const std::string* setup_chunk_t::find(const std::string& key) const {
+	auto iter = indices.find(key);
+	if (iter != indices.end()) {
+		return &data[iter->second].second;
+	}
+	return nullptr;
+}
+
 arch_t setup_chunk_t::get_length() const {
 	return data.size();
 }
@@ -34,37 +43,23 @@ const std::string& setup_chunk_t::get_title() const {
 }
 
 void setup_chunk_t::set(const std::string& key, const std::string& value) {
-	for (auto&& pair : data) {
-		if (pair.first == key) {
-			pair.second = value;
-			return;
-		}
+	auto result = indices.try_emplace(key, data.size());
+	if (result.second) {
+		data.emplace_back(key, value);
+	} else {
+		data[result.first->second].second = value;
 	}
-	data.emplace_back(key, value);
 }
 
 void setup_chunk_t::set(std::pair<std::string, std::string>& kvp) {
-	for (auto&& pair : data) {
-		if (pair.first == kvp.first) {
-			pair.second = kvp.second;
-			return;
-		}
-	}
-	data.push_back(kvp);
+	this->set(kvp.first, kvp.second);
 }
 
 bool setup_chunk_t::swap(const std::string& lhk, const std::string& rhk) {
-	std::pair<std::string, std::string>* lhp = nullptr;
-	std::pair<std::string, std::string>* rhp = nullptr;
-	for (auto&& pair : data) {
-		if (pair.first == lhk) {
-			lhp = &pair;
-		} else if (pair.first == rhk) {
-			rhp = &pair;
-		}
-	}
-	if (lhp != nullptr and rhp != nullptr) {
-		std::swap(lhp->second, rhp->second);
+	auto lhi = indices.find(lhk);
+	auto rhi = indices.find(rhk);
+	if (lhi != indices.end() and rhi != indices.end() and lhi != rhi) {
+		std::swap(data[lhi->second].second, data[rhi->second].second);
 		return true;
 	}
 	return false;
@@ -79,6 +74,7 @@ void setup_chunk_t::write_to(std::string& buffer) const {
 setup_file_t::setup_file_t() :
 	origin(),
 	data(),
+	indices(),
 	locale() 
 {
 	
@@ -86,10 +82,11 @@ setup_file_t::setup_file_t() :
 
 bool setup_file_t::load(const std::string& full_path) {
 	data.clear();
+	indices.clear();
 	origin = full_path;
-	std::ifstream file(full_path, std::ios::binary);
-	if (file.is_open()) {
-		return this->read(file);
+	const archive_blob_t blob = vfs::memory(full_path);
+	if (!blob.empty()) {
+		return this->read(std::string_view(blob.data(), blob.size()));
 	}
 	return false;
 }
@@ -109,6 +106,7 @@ bool setup_file_t::save(const std::string& full_path) {
 void setup_file_t::clear(const std::string& full_path) {
 	origin = full_path;
 	data.clear();
+	indices.clear();
 }
 
 void setup_file_t::clear() {
@@ -116,13 +114,12 @@ void setup_file_t::clear() {
 }
 
 bool setup_file_t::exists(const std::string& title) const {
-	for (auto&& chunk : data) {
-		if (title == chunk.get_title()) {
-			bool_t result = false;
-			std::stringstream ss(chunk.get(0));
-			ss >> result;
-			return result;
-		}
+	auto iter = indices.find(title);
+	if (iter != indices.end()) {
+		bool_t result = false;
+		std::stringstream ss(data[iter->second].get(0));
+		ss >> result;
+		return result;
 	}
 	return false;
 }
@@ -132,30 +129,44 @@ arch_t setup_file_t::size() const {
 }
 
 bool setup_file_t::swap(const std::string& title, const std::string& lhk, const std::string& rhk) {
-	for (auto&& chunk : data) {
-		if (chunk.get_title() == title) {
-			return chunk.swap(lhk, rhk);
-		}
+	auto iter = indices.find(title);
+	if (iter != indices.end()) {
+		return data[iter->second].swap(lhk, rhk);
 	}
 	return false;
 }
 
-bool setup_file_t::read(std::ifstream& file) {
-	std::string line;
-	std::string title = "NONE";
-	while (std::getline(file, line)) {
-		std::pair<std::string, std::string> kvp = parse(line);
-		if (!kvp.first.empty()) {
-			if (kvp.first[0] != '!') {
-				for (auto&& chunk : data) {
-					if (chunk.get_title() == title) {
-						chunk.set(kvp);
-					}
+// Keys before the first title have no chunk to go into, so they're dropped.
+// A repeated title starts a new chunk, but its keys also reach the first
+// chunk with that title, since that's the one lookups by title resolve to.
+bool setup_file_t::read(std::string_view source) {
+	arch_t first = data.size();
+	arch_t current = data.size();
+	arch_t position = 0;
+	while (position < source.size()) {
+		arch_t next = source.find('\n', position);
+		if (next == std::string_view::npos) {
+			next = source.size();
+		}
+		auto [key, value] = this->parse(source.substr(position, next - position));
+		position = next + 1;
+		if (key.empty()) {
+			continue;
+		}
+		if (key[0] != '!') {
+			if (current < data.size()) {
+				const std::string name{ key };
+				const std::string text{ value };
+				data[current].set(name, text);
+				if (first != current) {
+					data[first].set(name, text);
 				}
-			} else {
-				data.emplace_back(kvp.second);
-				title = kvp.second;
 			}
+		} else {
+			const std::string title{ value };
+			current = data.size();
+			data.emplace_back(title);
+			first = indices.try_emplace(title, current).first->second;
 		}
 	}
 	return true;
@@ -170,32 +181,53 @@ bool setup_file_t::write(std::ofstream& file) const {
 	return true;
 }
 
-std::pair<std::string, std::string> setup_file_t::parse(const std::string& line) const {
-	if (line.size() > 0 and line[0] != '#' and line[0] != ';' and line[0] != '[' and line[0] != '\r' and line[0] != '\n') {
+std::pair<std::string_view, std::string_view> setup_file_t::parse(std::string_view line) const {
+	if (line.empty()) {
+		return std::make_pair(std::string_view(), std::string_view());
+	}
+	if (line[0] != '#' and line[0] != ';' and line[0] != '[' and line[0] != '\r' and line[0] != '\n') {
 		arch_t index = 0;
-		while (std::isspace(line[index], locale)) {
+		while (index < line.size() and std::isspace(line[index], locale)) {
 			index++;
 		}
 		const arch_t begin = index;
-		while (!std::isspace(line[index], locale) and line[index] != '=') {
+		while (index < line.size() and !std::isspace(line[index], locale) and line[index] != '=') {
 			index++;
 		}
-		const std::string key = line.substr(begin, index - begin);
-		while (std::isspace(line[index], locale) or line[index] == '=') {
+		const std::string_view key = line.substr(begin, index - begin);
+		while (index < line.size() and (std::isspace(line[index], locale) or line[index] == '=')) {
 			index++;
 		}
-		const std::string value = line.substr(index, line.size() - index);
-		return std::make_pair(key, value);
-
+		return std::make_pair(key, line.substr(index));
 	} else if (line[0] == '[') {
 		arch_t index = 1;
-		const arch_t begin = index;
-		while (!std::isspace(line[index], locale) and line[index] != ']') {
+		while (index < line.size() and !std::isspace(line[index], locale) and line[index] != ']') {
 			index++;
 		}
-		const std::string title = line.substr(begin, index - begin);
-		return std::make_pair("!", title);
+		return std::make_pair(std::string_view("!"), line.substr(1, index - 1));
 	}
+	return std::make_pair(std::string_view(), std::string_view());
+}
 
-	return std::make_pair(std::string(), std::string());
-}
\ No newline at end of file
+const std::string* setup_file_t::find(const std::string& title, const std::string& key) const {
+	auto iter = indices.find(title);
+	if (iter != indices.end()) {
+		return data[iter->second].find(key);
+	}
+	return nullptr;
+}
+
+const std::string* setup_file_t::find(arch_t index, const std::string& key) const {
+	if (index < data.size()) {
+		return data[index].find(key);
+	}
+	return nullptr;
+}
+
+setup_chunk_t& setup_file_t::chunk(const std::string& title) {
+	auto result = indices.try_emplace(title, data.size());
+	if (result.second) {
+		data.emplace_back(title);
+	}
+	return data[result.first->second];
+}
@@ -4,6 +4,8 @@
 #include <array>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <iosfwd>
 #include <sstream>
 #include <locale>
@@ -24,6 +26,7 @@ public:
 	const std::string& get_title() const;
 	std::string get(const std::string& key) const;
 	std::string get(arch_t index) const;
+	const std::string* find(const std::string& key) const;
 	void set(const std::string& key, const std::string& value);
 	void set(std::pair<std::string, std::string>& kvp);
 	void write_to(std::string& buffer) const;
@@ -31,6 +34,7 @@ public:
 private:
 	std::string title;
 	std::vector<std::pair<std::string, std::string> > data;
+	std::unordered_map<std::string, arch_t> indices;
 };
 
 struct setup_file_t : public not_copyable_t {
@@ -46,9 +50,9 @@ public:
 	bool exists(const std::string& title) const;
 	arch_t size() const;
 	bool swap(const std::string& title, const std::string& lhk, const std::string& rhk);
-	bool read(std::ifstream& file);
+	bool read(std::string_view source);
 	bool write(std::ofstream& file) const;
-	std::pair<std::string, std::string> parse(const std::string& line) const;
+	std::pair<std::string_view, std::string_view> parse(std::string_view line) const;
 	template<typename T> void get(const std::string& title, const std::string& key, T& value) const;
 	template<typename T> void get(const std::string& title, const std::string& key, std::vector<T>& value) const;
 	template<typename T, arch_t L> void get(const std::string& title, const std::string& key, std::array<T, L>& value) const;
@@ -62,92 +66,77 @@ public:
 	template<typename T, glm::length_t L, glm::qualifier Q> void set(const std::string& title, const std::string& key, const glm::vec<L, T, Q>& value);
 	template<typename T> T convert_to(const std::string& input) const;
 	template<typename T> std::string make_string(T value) const;
+private:
+	const std::string* find(const std::string& title, const std::string& key) const;
+	const std::string* find(arch_t index, const std::string& key) const;
+	setup_chunk_t& chunk(const std::string& title);
 private:
 	std::string origin;
 	std::vector<setup_chunk_t> data;
+	std::unordered_map<std::string, arch_t> indices;
 	std::locale locale;
 };
 
 template<typename T>
 inline void setup_file_t::get(const std::string& title, const std::string& key, T& value) const {
-	for (auto&& chunk : data) {
-		if (chunk.get_title() == title) {
-			const std::string str = chunk.get(key);
-			if (!str.empty()) {
-				value = convert_to<T>(str);
-			}
-			break;
-		}
+	const std::string* str = this->find(title, key);
+	if (str != nullptr and !str->empty()) {
+		value = convert_to<T>(*str);
 	}
 }
 
 template<typename T>
 inline void setup_file_t::get(const std::string& title, const std::string& key, std::vector<T>& value) const {
-	for (auto&& chunk : data) {
-		if (chunk.get_title() == title) {
-			const std::string str = chunk.get(key);
-			if (!str.empty()) {
-				std::string output;
-				std::istringstream parser(str);
-				while (std::getline(parser, output, ',')) {
-					value.push_back(convert_to<T>(output));
-				}
-			}
-			break;
+	const std::string* str = this->find(title, key);
+	if (str != nullptr and !str->empty()) {
+		std::string output;
+		std::istringstream parser(*str);
+		while (std::getline(parser, output, ',')) {
+			value.push_back(convert_to<T>(output));
 		}
 	}
 }
 
 template<typename T, arch_t L>
 inline void setup_file_t::get(const std::string& title, const std::string& key, std::array<T, L>& value) const {
-	for (auto&& chunk : data) {
-		if (chunk.get_title() == title) {
-			const std::string str = chunk.get(key);
-			if (!str.empty()) {
-				std::string output;
-				std::istringstream parser(str);
-				arch_t n = 0;
-				while (std::getline(parser, output, ',') and n < L) {
-					value[n++] = convert_to<T>(output);
-				}
-			}
-			break;
+	const std::string* str = this->find(title, key);
+	if (str != nullptr and !str->empty()) {
+		std::string output;
+		std::istringstream parser(*str);
+		arch_t n = 0;
+		while (std::getline(parser, output, ',') and n < L) {
+			value[n++] = convert_to<T>(output);
 		}
 	}
 }
 
 template<typename T, glm::length_t L, glm::qualifier Q>
 inline void setup_file_t::get(const std::string& title, const std::string& key, glm::vec<L, T, Q>& value) const {
-	for (auto&& chunk : data) {
-		if (chunk.get_title() == title) {
-			const std::string str = chunk.get(key);
-			if (!str.empty()) {
-				std::string output;
-				std::istringstream parser(str);
-				glm::length_t n = 0;
-				while (std::getline(parser, output, ',') and n < L) {
-					value[n++] = convert_to<T>(output);
-				}
-			}
-			break;
+	const std::string* str = this->find(title, key);
+	if (str != nullptr and !str->empty()) {
+		std::string output;
+		std::istringstream parser(*str);
+		glm::length_t n = 0;
+		while (std::getline(parser, output, ',') and n < L) {
+			value[n++] = convert_to<T>(output);
 		}
 	}
 }
 
 template<typename T>
 inline void setup_file_t::get(arch_t index, const std::string& key, T& value) const {
-	const std::string str = data[index].get(key);
-	if (!str.empty()) {
-		value = convert_to<T>(str);
+	const std::string* str = this->find(index, key);
+	if (str != nullptr and !str->empty()) {
+		value = convert_to<T>(*str);
 	}
 }
 
 template<typename T>
 inline void setup_file_t::get(arch_t index, const std::string& key, std::vector<T>& value) const {
-	const std::string str = data[index].get(key);
-	if (!str.empty()) {
+	const std::string* str = this->find(index, key);
+	if (str != nullptr and !str->empty()) {
 		std::string output;
-		std::istringstream parser(str);
+		std::istringstream parser(*str);
 		while (std::getline(parser, output, ',')) {
 			value.push_back(convert_to<T>(output));
 		}
@@ -156,10 +145,10 @@ inline void setup_file_t::get(arch_t index, const std::string& key, std::vector<
 
 template<typename T, arch_t L>
 inline void setup_file_t::get(arch_t index, const std::string& key, std::array<T, L>& value) const {
-	const std::string str = data[index].get(key);
-	if (!str.empty()) {
+	const std::string* str = this->find(index, key);
+	if (str != nullptr and !str->empty()) {
 		std::string output;
-		std::istringstream parser(str);
+		std::istringstream parser(*str);
 		arch_t n = 0;
 		while (std::getline(parser, output, ',') and n < L) {
 			value[n++] = convert_to<T>(output);
@@ -169,10 +158,10 @@ inline void setup_file_t::get(arch_t index, const std::string& key, std::array<T
 
 template<typename T, glm::length_t L, glm::qualifier Q>
 inline void setup_file_t::get(arch_t index, const std::string& key, glm::vec<L, T, Q>& value) const {
-	const std::string str = data[index].get(key);
-	if (!str.empty()) {
+	const std::string* str = this->find(index, key);
+	if (str != nullptr and !str->empty()) {
 		std::string output;
-		std::istringstream parser(str);
+		std::istringstream parser(*str);
 		glm::length_t n = 0;
 		while (std::getline(parser, output, ',') and n < L) {
 			value[n++] = convert_to<T>(output);
@@ -182,69 +171,27 @@ inline void setup_file_t::get(arch_t index, const std::string& key, glm::vec<L,
 
 template<typename T>
 inline void setup_file_t::set(const std::string& title, const std::string& key, const T& value) {
-	// Find and set chunk key-value-pair if it exists
-	for (auto&& chunk : data) {
-		if (chunk.get_title() == title) {
-			chunk.set(key, make_string<T>(value));
-			return;
-		}
-	}
-	// If chunk doesn't exist, create it
-	setup_chunk_t chunk(title);
-	chunk.set(key, make_string<T>(value));
-	data.push_back(chunk);
+	this->chunk(title).set(key, make_string<T>(value));
 }
 
 template<typename T>
 inline void setup_file_t::set(const std::string& title, const std::string& key, const std::vector<T>& value) {
-	// Find and set chunk key-value-pair if it exists
-	for (auto&& chunk : data) {
-		if (chunk.get_title() == title) {
-			std::string buffer;
-			for (arch_t i = 0; i < value.size() - 1; ++i) {
-				buffer += make_string<T>(value.at(i)) + ", ";
-			}
-			buffer += make_string<T>(value.back());
-			chunk.set(key, buffer);
-			return;
-		}
-	}
-
-	// If chunk doesn't exist, create it
-	setup_chunk_t chunk(title);
 	std::string buffer;
 	for (arch_t i = 0; i < value.size() - 1; ++i) {
 		buffer += make_string<T>(value.at(i)) + ", ";
 	}
 	buffer += make_string<T>(value.back());
-	chunk.set(key, buffer);
-	data.push_back(chunk);
+	this->chunk(title).set(key, buffer);
 }
 
 template<typename T, glm::length_t L, glm::qualifier Q>
 inline void setup_file_t::set(const std::string& title, const std::string& key, const glm::vec<L, T, Q>& value) {
-	// Find and set chunk key-value-pair if it exists
-	for (auto&& chunk : data) {
-		if (chunk.get_title() == title) {
-			std::string buffer;
-			for (glm::length_t it = 0; it < L - 1; ++it) {
-				buffer += make_string<T>(value[it]) + ", ";
-			}
-			buffer += make_string<T>(value[L - 1]);
-			chunk.set(key, buffer);
-			return;
-		}
-	}
-
-	// If chunk doesn't exist, create it
-	setup_chunk_t chunk(title);
 	std::string buffer;
 	for (glm::length_t it = 0; it < L - 1; ++it) {
 		buffer += make_string<T>(value[it]) + ", ";
 	}
 	buffer += make_string<T>(value[L - 1]);
-	chunk.set(key, buffer);
-	data.push_back(chunk);
+	this->chunk(title).set(key, buffer);
 }
 
 template<>
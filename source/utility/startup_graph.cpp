@@ -0,0 +1,135 @@
+#include "./startup_graph.hpp"
+#include "./logger.hpp"
+#include "./profiler.hpp"
+#include "./vfs.hpp"
+
+#include <chrono>
+
+static constexpr arch_t kNoStep = ~static_cast<arch_t>(0);
+static constexpr std::chrono::milliseconds kWaitPeriod{ 1 };
+
+startup_graph_t::startup_graph_t(const watch_t& launch) :
+	launch(launch),
+	steps(),
+	completed(0),
+	failed(false),
+	mutex(),
+	signal(),
+	counter()
+{
+
+}
+
+arch_t startup_graph_t::add(const std::string& name, startup_thread_t thread, std::initializer_list<arch_t> dependencies, std::function<bool()> function) {
+	const arch_t index = steps.size();
+	for (auto&& dependency : dependencies) {
+		if (dependency >= index) {
+			synao_log("Error! Startup step \"%s\" depends on a step added after it!\n", name.c_str());
+		}
+	}
+	steps.push_back({
+		name, std::move(function), dependencies, thread,
+		0.0, 0.0, false, false, false
+	});
+	return index;
+}
+
+bool startup_graph_t::run() {
+	synao_zone("startup_graph_t::run");
+	while (true) {
+		// Worker steps that are ready before vfs_t creates the job system run here instead.
+		job_system_t* jobs = vfs::jobs();
+		std::vector<arch_t> workers;
+		arch_t current = kNoStep;
+		arch_t observed = 0;
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			arch_t running = 0;
+			for (arch_t it = 0; it < steps.size(); ++it) {
+				startup_step_t& step = steps[it];
+				if (step.launched) {
+					running += step.finished ? 0 : 1;
+				} else if (!failed and this->ready(step)) {
+					if (step.thread == startup_thread_t::Worker and jobs != nullptr) {
+						step.launched = true;
+						workers.push_back(it);
+						++running;
+					} else if (current == kNoStep) {
+						current = it;
+					}
+				}
+			}
+			if (current == kNoStep and running == 0) {
+				break;
+			}
+			if (current != kNoStep) {
+				steps[current].launched = true;
+			}
+			observed = completed;
+		}
+		// Pushing can run a job inline when the pool is exhausted, so the lock isn't held here.
+		for (auto&& index : workers) {
+			jobs->push(job_priority_t::Urgent, &counter, [this, index] {
+				this->execute(index);
+			});
+		}
+		if (current != kNoStep) {
+			this->execute(current);
+		} else if (workers.empty() and (jobs == nullptr or !jobs->help())) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			signal.wait_for(lock, kWaitPeriod, [this, observed] {
+				return completed != observed;
+			});
+		}
+	}
+	counter.wait();
+	return !failed and completed == steps.size();
+}
+
+void startup_graph_t::report() const {
+	synao_info(General, "Startup timeline:\n");
+	for (auto&& step : steps) {
+		if (step.finished) {
+			synao_info(
+				General, "\t%-12s %9.2f ms -> %9.2f ms (%8.2f ms) on %s thread%s\n",
+				step.name.c_str(),
+				step.start * 1000.0,
+				step.finish * 1000.0,
+				(step.finish - step.start) * 1000.0,
+				step.thread == startup_thread_t::Main ? "main" : "a job",
+				step.succeeded ? "" : ", failed"
+			);
+		} else {
+			synao_info(General, "\t%-12s skipped\n", step.name.c_str());
+		}
+	}
+}
+
+bool startup_graph_t::ready(const startup_step_t& step) const {
+	for (auto&& dependency : step.dependencies) {
+		if (dependency >= steps.size() or !steps[dependency].finished) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void startup_graph_t::execute(arch_t index) {
+	startup_step_t& step = steps[index];
+	const real64_t start = launch.elapsed();
+	const bool succeeded = std::invoke(step.function);
+	const real64_t finish = launch.elapsed();
+	if (!succeeded) {
+		synao_error(General, "Startup step \"%s\" failed!\n", step.name.c_str());
+	}
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		step.start = start;
+		step.finish = finish;
+		step.succeeded = succeeded;
+		step.finished = true;
+		failed = failed or !succeeded;
+		++completed;
+	}
+	signal.notify_all();
+}
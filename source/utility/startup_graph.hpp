@@ -0,0 +1,59 @@
+#ifndef LEVIATHAN_INCLUDED_UTILITY_STARTUP_GRAPH_HPP
+#define LEVIATHAN_INCLUDED_UTILITY_STARTUP_GRAPH_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <condition_variable>
+
+#include "./job_system.hpp"
+#include "./watch.hpp"
+
+namespace __enum_startup_thread {
+	enum type : arch_t {
+		Main,
+		Worker
+	};
+}
+
+using startup_thread_t = __enum_startup_thread::type;
+
+struct startup_step_t {
+	std::string name;
+	std::function<bool()> function;
+	std::vector<arch_t> dependencies;
+	startup_thread_t thread;
+	real64_t start, finish;
+	bool_t launched, finished, succeeded;
+};
+
+// Runs each subsystem's initialization once everything it depends on is done.
+// Main steps stay on the calling thread for the sake of SDL and OpenGL, while
+// worker steps go to the job system as soon as vfs_t has created it. Steps can
+// only depend on ones added before them, so the graph never has a cycle.
+struct startup_graph_t : public not_copyable_t {
+public:
+	startup_graph_t(const watch_t& launch);
+	startup_graph_t(startup_graph_t&&) = delete;
+	startup_graph_t& operator=(startup_graph_t&&) = delete;
+	~startup_graph_t() = default;
+public:
+	arch_t add(const std::string& name, startup_thread_t thread, std::initializer_list<arch_t> dependencies, std::function<bool()> function);
+	bool run();
+	void report() const;
+private:
+	bool ready(const startup_step_t& step) const;
+	void execute(arch_t index);
+private:
+	watch_t launch;
+	std::vector<startup_step_t> steps;
+	arch_t completed;
+	bool_t failed;
+	std::mutex mutex;
+	std::condition_variable signal;
+	job_counter_t counter;
+};
+
+#endif // LEVIATHAN_INCLUDED_UTILITY_STARTUP_GRAPH_HPP
@@ -1,14 +1,16 @@
 #include "./vfs.hpp"
 #include "./logger.hpp"
 #include "./setup_file.hpp"
-#include "./thread_pool.hpp"
+#include "./job_system.hpp"
+#include "./profiler.hpp"
 #include "../resource/tbl_entry.hpp"
 
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <streambuf>
-#include <nlohmann/json.hpp>
 
 #if defined(LEVIATHAN_PLATFORM_WINDOWS)
 	#include <windows.h>
@@ -42,22 +44,29 @@ static const byte_t kSavePath[]		= "./data/save/";
 static const byte_t kSpritePath[]	= "./data/sprite/";
 static const byte_t kTileKeyPath[]	= "./data/tilekey/";
 static const byte_t kTunePath[]		= "./data/tune/";
+static const byte_t kArchivePath[]	= "./data.pak";
 
 static constexpr byte_t kDefaultLang[] 	= "english";
-static constexpr arch_t kTotalThreads 	= 4;
 static constexpr arch_t kDebugFontIndex = 4;
+static constexpr arch_t kPageLength 	= 4096;
+static constexpr arch_t kMegabyte 		= 1 << 20;
+static constexpr arch_t kUnlimited 		= ~static_cast<arch_t>(0);
+
+// Mapped once at mount and never moved, so blobs pointing into it stay valid.
+static archive_t archive;
 
 vfs_t::vfs_t() :
-	thread_pool(),
-	storage_mutex(),
+	job_system(),
 	language(kDefaultLang),
-	i18n(),
+	i18n(std::make_unique<i18n_table_t>()),
 	noises(),
 	textures(),
 	palettes(),
 	shaders(),
 	fonts(),
-	animations()
+	animations(),
+	budgets(),
+	residents()
 {
 
 }
@@ -73,6 +82,11 @@ vfs_t::~vfs_t() {
 }
 
 bool vfs_t::init(const setup_file_t& config) {
+	return this->init_device(config) and this->init_language();
+}
+
+// The language is loaded separately, so startup can parse it on a job thread.
+bool vfs_t::init_device(const setup_file_t& config) {
 	if (vfs::device == this) {
 		synao_log("Error! This virtual file system already exists!\n");
 		return false;
@@ -82,21 +96,35 @@ bool vfs_t::init(const setup_file_t& config) {
 	}
 	vfs::device = this;
 	config.get("Setup", "Language", language);
-	if (!vfs::try_language(language)) {
-		synao_log("Error! Could not load first language: %s\n", language.c_str());
+	arch_t job_threads = 0;
+	config.get("Setup", "JobThreads", job_threads);
+	job_system = std::make_unique<job_system_t>();
+	if (!job_system->init(job_threads)) {
+		synao_error(General, "Couldn't create job system!\n");
 		return false;
 	}
-	vfs::device->thread_pool = std::make_unique<thread_pool_t>(kTotalThreads);
-	if (vfs::device->thread_pool == nullptr) {
-		synao_log("Error! Couldn't create thread pool!\n");
-		return false;
+	// Fonts are only handed out as raw pointers, so they're measured but never evicted.
+	const byte_t* categories[vfs_budget_t::Font] = { "Texture", "Palette", "Animation", "Noise" };
+	budgets.fill(kUnlimited);
+	for (arch_t it = 0; it < vfs_budget_t::Font; ++it) {
+		arch_t megabytes = 0;
+		config.get("Memory", categories[it], megabytes);
+		budgets[it] = megabytes != 0 ? megabytes * kMegabyte : kUnlimited;
 	}
 	synao_log("Virtual filesystem initialized.\n");
 	return true;
 }
 
+bool vfs_t::init_language() {
+	if (!vfs::try_language(language)) {
+		synao_error(Vfs, "Could not load first language: %s\n", language.c_str());
+		return false;
+	}
+	return true;
+}
+
 // Copied from SFML
-static std::string::const_iterator decode(std::string::const_iterator begin, std::string::const_iterator end, uint_t& output, uint_t replacement = 0) {
+static const byte_t* decode(const byte_t* begin, const byte_t* end, uint_t& output, uint_t replacement = 0) {
 	static const sint_t trailing[256] = {
 		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
@@ -134,9 +162,10 @@ static std::string::const_iterator decode(std::string::const_iterator begin, std
 }
 
 std::back_insert_iterator<std::u32string> vfs::to_utf32(
-	std::string::const_iterator begin,
-	std::string::const_iterator end,
+	std::string_view words,
 	std::back_insert_iterator<std::u32string> output) {
+	const byte_t* begin = words.data();
+	const byte_t* end = words.data() + words.size();
 	while (begin < end) {
 		uint_t point;
 		begin = ::decode(begin, end, point);
@@ -170,6 +199,9 @@ bool vfs::mount(const std::string& directory, bool_t print) {
 		return false;
 	}
 #endif
+	if (archive.open(kArchivePath)) {
+		return true;
+	}
 	bool problem = true;
 	for (arch_t it = 0; it < SYNAO_SIZEOF_ARRAY(kDirList); ++it) {
 		if (!vfs::directory_exists(kDirList[it], print)) {
@@ -366,60 +398,85 @@ std::vector<std::string> vfs::file_list(const std::string& path) {
 	return result;
 }
 
-std::string vfs::string_buffer(const std::string& path) {
-	std::ifstream ifs(path);
+archive_blob_t vfs::memory(const std::string& path) {
+	if (archive.valid()) {
+		archive_blob_t blob = archive.find(path);
+		if (!blob.empty()) {
+			return blob;
+		}
+	}
+	std::ifstream ifs(path, std::ios::binary);
 	if (ifs.is_open()) {
 		ifs.seekg(0, std::ios_base::end);
 		arch_t length = static_cast<arch_t>(ifs.tellg());
 		if (length > 0) {
 			ifs.seekg(0, std::ios_base::beg);
-			std::string buffer;
+			std::vector<byte_t> buffer;
 			buffer.resize(length);
-			ifs.read(reinterpret_cast<byte_t*>(buffer.data()), length);
-			return buffer;
+			ifs.read(buffer.data(), length);
+			return archive_blob_t(std::move(buffer));
 		}
 	}
-	synao_log("Failed to open file: %s!\n", path.c_str());
+	return archive_blob_t();
+}
+
+bool vfs::contains(const std::string& path) {
+	if (archive.valid() and archive.contains(path)) {
+		return true;
+	}
+	return vfs::file_exists(path, false);
+}
+
+// Faults in every page of a resource so its first real read doesn't wait on the disk.
+void vfs::warm(const std::string& path) {
+	const archive_blob_t blob = vfs::memory(path);
+	volatile byte_t sink = 0;
+	for (arch_t it = 0; it < blob.size(); it += kPageLength) {
+		sink = blob.data()[it];
+	}
+	static_cast<void>(sink);
+}
+
+job_system_t* vfs::jobs() {
+	if (vfs::device == nullptr) {
+		return nullptr;
+	}
+	return vfs::device->job_system.get();
+}
+
+std::string vfs::string_buffer(const std::string& path) {
+	const archive_blob_t blob = vfs::memory(path);
+	if (!blob.empty()) {
+		return std::string(blob.data(), blob.size());
+	}
+	synao_warn(Vfs, "Failed to open file: %s!\n", path.c_str());
 	return std::string();
 }
 
 std::vector<byte_t> vfs::byte_buffer(const std::string& path) {
-	std::ifstream ifs(path, std::ios::binary);
-	if (ifs.is_open()) {
-		ifs.seekg(0, std::ios_base::end);
-		arch_t length = static_cast<arch_t>(ifs.tellg());
-		if (length > 0) {
-			ifs.seekg(0, std::ios_base::beg);
-			std::vector<byte_t> buffer;
-			buffer.resize(length);
-			ifs.read(reinterpret_cast<byte_t*>(buffer.data()), length);
-			return buffer;
-		}
+	const archive_blob_t blob = vfs::memory(path);
+	if (!blob.empty()) {
+		return std::vector<byte_t>(blob.data(), blob.data() + blob.size());
 	}
-	synao_log("Failed to open file: %s!\n", path.c_str());
+	synao_warn(Vfs, "Failed to open file: %s!\n", path.c_str());
 	return std::vector<byte_t>();
 }
 
 std::vector<sint_t> vfs::sint_buffer(const std::string& path) {
-	std::ifstream ifs(path, std::ios::binary);
-	if (ifs.is_open()) {
-		ifs.seekg(0, std::ios_base::end);
-		arch_t length = static_cast<arch_t>(ifs.tellg());
-		if (length > 0) {
-			ifs.seekg(0, std::ios_base::beg);
-			std::vector<sint_t> buffer;
-			buffer.resize(length / sizeof(sint_t));
-			ifs.read(reinterpret_cast<byte_t*>(buffer.data()), length);
-			return buffer;
-		}
-	}
-	synao_log("Failed to open file: %s!\n", path.c_str());
+	const archive_blob_t blob = vfs::memory(path);
+	if (!blob.empty()) {
+		std::vector<sint_t> buffer;
+		buffer.resize(blob.size() / sizeof(sint_t));
+		std::memcpy(buffer.data(), blob.data(), buffer.size() * sizeof(sint_t));
+		return buffer;
+	}
+	synao_warn(Vfs, "Failed to open file: %s!\n", path.c_str());
 	return std::vector<sint_t>();
 }
 
 std::string vfs::event_path(const std::string& name, rec_loading_t flags) {
 	if (vfs::device == nullptr) {
-		synao_log("Couldn't find path for event: %s!\n", name.c_str());
+		synao_warn(Vfs, "Couldn't find path for event: %s!\n", name.c_str());
 		return std::string();
 	}
 	if (flags & rec_loading_t::Global) {
@@ -428,104 +485,101 @@ std::string vfs::event_path(const std::string& name, rec_loading_t flags) {
 	return kEventPath + vfs::device->language + '/' + name + ".cc";
 }
 
-std::string vfs::i18n_find(const std::string& segment, arch_t index) {
+std::string_view vfs::i18n_find(std::string_view segment, arch_t index) {
 	if (vfs::device == nullptr) {
-		return std::string();
+		return std::string_view();
 	}
-	auto it = vfs::device->i18n.find(segment);
-	if (it == vfs::device->i18n.end()) {
-		return std::string();
-	}
-	std::string result;
-	if (index < it->second.size()) {
-		result = it->second[index];
-	}
-	return result;
+	return vfs::device->i18n->find(segment, index);
 }
 
-std::string vfs::i18n_find(const std::string& segment, arch_t first, arch_t last) {
+std::string_view vfs::i18n_find(std::string_view segment, arch_t first, arch_t last) {
 	if (vfs::device == nullptr) {
-		return std::string();
-	}
-	auto it = vfs::device->i18n.find(segment);
-	if (it == vfs::device->i18n.end()) {
-		return std::string();
+		return std::string_view();
 	}
-	std::string result;
-	if (first < it->second.size() and last < it->second.size()) {
-		for (arch_t index = first; index <= last; ++index) {
-			result += it->second[index];
-		}
+	return vfs::device->i18n->find(segment, first, last);
+}
+
+std::u32string_view vfs::i18n_utf32(std::string_view segment, arch_t index) {
+	if (vfs::device == nullptr) {
+		return std::u32string_view();
 	}
-	return result;
+	return vfs::device->i18n->utf32(segment, index);
 }
 
-arch_t vfs::i18n_size(const std::string& segment) {
+std::u32string_view vfs::i18n_utf32(std::string_view segment, arch_t first, arch_t last) {
 	if (vfs::device == nullptr) {
-		return 0;
+		return std::u32string_view();
 	}
-	auto it = vfs::device->i18n.find(segment);
-	if (it == vfs::device->i18n.end()) {
+	return vfs::device->i18n->utf32(segment, first, last);
+}
+
+arch_t vfs::i18n_size(std::string_view segment) {
+	if (vfs::device == nullptr) {
 		return 0;
 	}
-	return it->second.size();
+	return vfs::device->i18n->size(segment);
 }
 
+// The new table is built off to the side, so switching over is just a pointer swap.
 bool vfs::try_language(const std::string& language) {
 	if (vfs::device == nullptr) {
 		return false;
 	}
-	const std::string full_path = kI18NPath + language + ".json";
-	std::unordered_map<std::string, std::vector<std::string> > i18n;
-	std::ifstream ifs(full_path, std::ios::binary);
-	if (ifs.is_open()) {
-		nlohmann::json file = nlohmann::json::parse(ifs);
-		for (auto it = file.begin(); it != file.end(); ++it) {
-			std::vector<std::string>& vec = i18n[it.key()];
-			for (auto&& s : it.value()) {
-				vec.push_back(s.get<std::string>());
-			}
-		}
+	const std::string full_path = kI18NPath + language;
+	auto i18n = std::make_unique<i18n_table_t>();
+	if (i18n->load(full_path)) {
 		vfs::device->language = language;
-		vfs::device->i18n = std::move(i18n);
+		std::swap(vfs::device->i18n, i18n);
 		vfs::device->fonts.clear();
 		return true;
 	}
-	synao_log("Error! Couldn't load language file: %s\n", full_path.c_str());
+	synao_error(Vfs, "Couldn't load language file: %s\n", full_path.c_str());
 	return false;
 }
 
-const noise_t* vfs::noise(const std::string& name) {
-	const tbl_entry_t entry = tbl_entry_t(name.c_str());
-	return vfs::noise(entry);
+static auto noise_loader(const tbl_entry_t& entry) {
+	return [&entry](noise_t& noise) {
+		noise.load(kNoisePath + std::string(entry.name) + ".wav", *vfs::device->job_system);
+	};
 }
 
-const noise_t* vfs::noise(const tbl_entry_t& entry) {
-	if (vfs::device == nullptr) {
-		return nullptr;
-	}
-	// auto it = vfs::device->noises.find(entry.hash);
-	auto it = vfs::device->search_safely(entry.hash, vfs::device->noises);
-	if (it == vfs::device->noises.end()) {
-		noise_t& ref = vfs::device->emplace_safely(entry.hash, vfs::device->noises);
-		ref.load(kNoisePath + std::string(entry.name) + ".wav", *vfs::device->thread_pool);
-		return &ref;
-	}
-	return &it->second;
+static auto animation_loader(const tbl_entry_t& entry) {
+	return [&entry](animation_t& animation) {
+		animation.load(kSpritePath + std::string(entry.name) + ".cfg", *vfs::device->job_system);
+	};
+}
+
+static auto texture_loader(const std::vector<std::string>& names, const std::string& directory) {
+	return [&names, &directory](texture_t& texture) {
+		auto generate_full_paths = [&directory](std::vector<std::string> names) {
+			for (auto&& name : names) {
+				name = directory + name + ".png";
+			}
+			return names;
+		};
+		texture.load(
+			std::invoke(generate_full_paths, names),
+			pixel_format_t::R8G8B8A8,
+			*vfs::device->job_system
+		);
+	};
+}
+
+static auto palette_loader(const std::string& name, const std::string& directory) {
+	return [&name, &directory](palette_t& palette) {
+		palette.load(
+			directory + name + ".png",
+			pixel_format_t::R2G2B2A2,
+			*vfs::device->job_system
+		);
+	};
 }
 
 const animation_t* vfs::animation(const tbl_entry_t& entry) {
 	if (vfs::device == nullptr) {
 		return nullptr;
 	}
-	// auto it = vfs::device->animations.find(entry.hash);
-	auto it = vfs::device->search_safely(entry.hash, vfs::device->animations);
-	if (it == vfs::device->animations.end()) {
-		animation_t& ref = vfs::device->emplace_safely(entry.hash, vfs::device->animations);
-		ref.load(kSpritePath + std::string(entry.name) + ".cfg", *vfs::device->thread_pool);
-		return &ref;
-	}
-	return &it->second;
+	return &vfs::device->animations.fetch(entry.hash, animation_loader(entry));
 }
 
 const animation_t* vfs::animation(const std::string& name) {
@@ -540,24 +594,7 @@ const texture_t* vfs::texture(const std::vector<std::string>& names, const std::
 	if (names.size() == 0 or names.size() > 4) {
 		return nullptr;
 	}
-	// auto it = vfs::device->textures.find(names[0]);
-	auto it = vfs::device->search_safely(names[0], vfs::device->textures);
-	if (it == vfs::device->textures.end()) {
-		texture_t& ref = vfs::device->emplace_safely(names[0], vfs::device->textures);
-		auto generate_full_paths = [&directory](std::vector<std::string> names) {
-			for (auto&& name : names) {
-				name = directory + name + ".png";
-			}
-			return names;
-		};
-		ref.load(
-			std::invoke(generate_full_paths, names),
-			pixel_format_t::R8G8B8A8,
-			*vfs::device->thread_pool
-		);
-		return &ref;
-	}
-	return &it->second;
+	return &vfs::device->textures.fetch(names[0], texture_loader(names, directory));
 }
 
 const texture_t* vfs::texture(const std::vector<std::string>& names) {
@@ -573,18 +610,7 @@ const palette_t* vfs::palette(const std::string& name, const std::string& direct
 	if (vfs::device == nullptr) {
 		return nullptr;
 	}
-	// auto it = vfs::device->palettes.find(name);
-	auto it = vfs::device->search_safely(name, vfs::device->palettes);
-	if (it == vfs::device->palettes.end()) {
-		palette_t& ref = vfs::device->emplace_safely(name, vfs::device->palettes);
-		ref.load(
-			directory + name + ".png",
-			pixel_format_t::R2G2B2A2,
-			*vfs::device->thread_pool
-		);
-		return &ref;
-	}
-	return &it->second;
+	return &vfs::device->palettes.fetch(name, palette_loader(name, directory));
 }
 
 const palette_t* vfs::palette(const std::string& name) {
@@ -595,41 +621,39 @@ const shader_t* vfs::shader(const std::string& name, const std::string& source,
 	if (vfs::device == nullptr) {
 		return nullptr;
 	}
-	auto it = vfs::device->shaders.find(name);
-	if (it == vfs::device->shaders.end()) {
-		shader_t& ref = vfs::device->shaders[name];
-		if (!ref.from(source, stage)) {
-			synao_log("Failed to create shader from %s!\n", name.c_str());
+	bool created = false;
+	shader_t& ref = vfs::device->shaders.fetch(name, [&](shader_t& shader) {
+		created = true;
+		if (!shader.from(source, stage)) {
+			synao_error(Video, "Failed to create shader from %s!\n", name.c_str());
 		}
+	});
+	if (created) {
 		return &ref;
-	} else if (!it->second.matches(stage)) {
+	} else if (!ref.matches(stage)) {
 		synao_log("Found shader %s should have different stage!\n", name.c_str());
 		return nullptr;
 	}
 	synao_log("Tried to create shader twice from source named %s!\n", name.c_str());
-	return &it->second;
+	return &ref;
 }
 
 const font_t* vfs::font(const std::string& name) {
 	if (vfs::device == nullptr) {
 		return nullptr;
 	}
-	auto it = vfs::device->fonts.find(name);
-	if (it == vfs::device->fonts.end()) {
-		font_t& ref = vfs::device->fonts[name];
-		ref.load(kFontPath, name + ".fnt");
-		return &ref;
-	}
-	return &it->second;
+	return &vfs::device->fonts.fetch(name, [&name](font_t& font) {
+		font.load(kFontPath, name + ".fnt");
+	});
 }
 
 const font_t* vfs::font(arch_t index) {
 	if (vfs::device == nullptr) {
 		return nullptr;
 	}
-	auto& i18n_fonts = vfs::device->i18n["Fonts"];
-	if (index < i18n_fonts.size()) {
-		return vfs::font(i18n_fonts[index]);
+	const std::string_view name = vfs::device->i18n->find("Fonts", index);
+	if (!name.empty()) {
+		return vfs::font(std::string(name));
 	}
 	return nullptr;
 }
@@ -637,3 +661,83 @@ const font_t* vfs::font(arch_t index) {
 const font_t* vfs::debug_font() {
 	return vfs::font(kDebugFontIndex);
 }
+
+vfs_handle_t<noise_t> vfs::acquire_noise(const std::string& name) {
+	const tbl_entry_t entry = tbl_entry_t(name.c_str());
+	return vfs::acquire_noise(entry);
+}
+
+vfs_handle_t<noise_t> vfs::acquire_noise(const tbl_entry_t& entry) {
+	if (vfs::device == nullptr) {
+		return nullptr;
+	}
+	return vfs::device->noises.acquire(entry.hash, noise_loader(entry));
+}
+
+vfs_handle_t<animation_t> vfs::acquire_animation(const std::string& name) {
+	const tbl_entry_t entry = tbl_entry_t(name.c_str());
+	return vfs::acquire_animation(entry);
+}
+
+vfs_handle_t<animation_t> vfs::acquire_animation(const tbl_entry_t& entry) {
+	if (vfs::device == nullptr) {
+		return nullptr;
+	}
+	return vfs::device->animations.acquire(entry.hash, animation_loader(entry));
+}
+
+vfs_handle_t<texture_t> vfs::acquire_texture(const std::vector<std::string>& names) {
+	if (vfs::device == nullptr) {
+		return nullptr;
+	}
+	if (names.size() == 0 or names.size() > 4) {
+		return nullptr;
+	}
+	const std::string directory = kImagePath;
+	return vfs::device->textures.acquire(names[0], texture_loader(names, directory));
+}
+
+vfs_handle_t<texture_t> vfs::acquire_texture(const std::string& name) {
+	const std::vector<std::string> names = { name };
+	return vfs::acquire_texture(names);
+}
+
+vfs_handle_t<palette_t> vfs::acquire_palette(const std::string& name) {
+	if (vfs::device == nullptr) {
+		return nullptr;
+	}
+	const std::string directory = kPalettePath;
+	return vfs::device->palettes.acquire(name, palette_loader(name, directory));
+}
+
+void vfs::measure() {
+	if (vfs::device != nullptr) {
+		auto& residents = vfs::device->residents;
+		residents[vfs_budget_t::Texture].store(vfs::device->textures.measure(), std::memory_order_relaxed);
+		residents[vfs_budget_t::Palette].store(vfs::device->palettes.measure(), std::memory_order_relaxed);
+		residents[vfs_budget_t::Animation].store(vfs::device->animations.measure(), std::memory_order_relaxed);
+		residents[vfs_budget_t::Noise].store(vfs::device->noises.measure(), std::memory_order_relaxed);
+		residents[vfs_budget_t::Font].store(vfs::device->fonts.measure(), std::memory_order_relaxed);
+	}
+}
+
+// Animations go first, since dropping one releases its hold on a texture and palette.
+// Must run on the thread owning the graphics context, while nothing is drawing.
+void vfs::evict() {
+	if (vfs::device != nullptr) {
+		synao_zone("vfs::evict");
+		auto& budgets = vfs::device->budgets;
+		auto& residents = vfs::device->residents;
+		residents[vfs_budget_t::Animation].store(vfs::device->animations.evict(budgets[vfs_budget_t::Animation]), std::memory_order_relaxed);
+		residents[vfs_budget_t::Texture].store(vfs::device->textures.evict(budgets[vfs_budget_t::Texture]), std::memory_order_relaxed);
+		residents[vfs_budget_t::Palette].store(vfs::device->palettes.evict(budgets[vfs_budget_t::Palette]), std::memory_order_relaxed);
+		residents[vfs_budget_t::Noise].store(vfs::device->noises.evict(budgets[vfs_budget_t::Noise]), std::memory_order_relaxed);
+	}
+}
+
+arch_t vfs::resident(vfs_budget_t category) {
+	if (vfs::device == nullptr or category >= vfs_budget_t::Total) {
+		return 0;
+	}
+	return vfs::device->residents[category].load(std::memory_order_relaxed);
+}
@@ -1,11 +1,17 @@
 #ifndef LEVIATHAN_INCLUDED_UTILITY_VFS_HPP
 #define LEVIATHAN_INCLUDED_UTILITY_VFS_HPP
 
+#include <array>
+#include <atomic>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
-#include "./thread_pool.hpp"
+#include "./archive.hpp"
+#include "./i18n_table.hpp"
+#include "./job_system.hpp"
+#include "./vfs_cache.hpp"
 #include "../audio/noise.hpp"
 #include "../video/texture.hpp"
 #include "../video/palette.hpp"
@@ -37,11 +43,23 @@ namespace __enum_vfs_resource_path {
 
 using vfs_resource_path_t = __enum_vfs_resource_path::type;
 
+namespace __enum_vfs_budget {
+	enum type : arch_t {
+		Texture,
+		Palette,
+		Animation,
+		Noise,
+		Font,
+		Total
+	};
+}
+
+using vfs_budget_t = __enum_vfs_budget::type;
+
 namespace vfs {
 	static vfs_t* device = nullptr;
 	std::back_insert_iterator<std::u32string> to_utf32(
-		std::string::const_iterator begin,
-		std::string::const_iterator end,
+		std::string_view words,
 		std::back_insert_iterator<std::u32string> output
 	);
 	bool mount(const std::string& directory, bool_t print = true);
@@ -52,16 +70,20 @@ namespace vfs {
 	std::string executable_directory();
 	std::string resource_path(vfs_resource_path_t path);
 	std::vector<std::string> file_list(const std::string& directory);
+	archive_blob_t memory(const std::string& path);
+	bool contains(const std::string& path);
+	void warm(const std::string& path);
+	job_system_t* jobs();
 	std::string string_buffer(const std::string& path);
 	std::vector<byte_t> byte_buffer(const std::string& path);
 	std::vector<sint_t> sint_buffer(const std::string& path);
 	std::string event_path(const std::string& name, rec_loading_t flags);
-	std::string i18n_find(const std::string& segment, arch_t index);
-	std::string i18n_find(const std::string& segment, arch_t first, arch_t last);
-	arch_t i18n_size(const std::string& segment);
+	std::string_view i18n_find(std::string_view segment, arch_t index);
+	std::string_view i18n_find(std::string_view segment, arch_t first, arch_t last);
+	std::u32string_view i18n_utf32(std::string_view segment, arch_t index);
+	std::u32string_view i18n_utf32(std::string_view segment, arch_t first, arch_t last);
+	arch_t i18n_size(std::string_view segment);
 	bool try_language(const std::string& language);
-	const noise_t* noise(const std::string& name);
-	const noise_t* noise(const tbl_entry_t& entry);
 	const animation_t* animation(const std::string& name);
 	const animation_t* animation(const tbl_entry_t& entry);
 	const texture_t* texture(const std::vector<std::string>& names, const std::string& directory);
@@ -73,6 +95,16 @@ namespace vfs {
 	const font_t* font(const std::string& name);
 	const font_t* font(arch_t index);
 	const font_t* debug_font();
+	vfs_handle_t<noise_t> acquire_noise(const std::string& name);
+	vfs_handle_t<noise_t> acquire_noise(const tbl_entry_t& entry);
+	vfs_handle_t<animation_t> acquire_animation(const std::string& name);
+	vfs_handle_t<animation_t> acquire_animation(const tbl_entry_t& entry);
+	vfs_handle_t<texture_t> acquire_texture(const std::vector<std::string>& names);
+	vfs_handle_t<texture_t> acquire_texture(const std::string& name);
+	vfs_handle_t<palette_t> acquire_palette(const std::string& name);
+	void measure();
+	void evict();
+	arch_t resident(vfs_budget_t category);
 }
 
 struct vfs_t : public not_copyable_t {
@@ -82,28 +114,20 @@ public:
 	vfs_t& operator=(vfs_t&&) = delete;
 	~vfs_t();
 	bool init(const setup_file_t& config);
-	template<typename K, typename T>
-	T& emplace_safely(const K& key, std::unordered_map<K, T>& map) {
-		std::lock_guard<std::mutex> lock{this->storage_mutex};
-		auto result = map.try_emplace(key);
-		return result.first->second;
-	}
-	template<typename K, typename T>
-	auto search_safely(const K& key, const std::unordered_map<K, T>& map) {
-		std::lock_guard<std::mutex> lock{this->storage_mutex};
-		return map.find(key);
-	}
+	bool init_device(const setup_file_t& config);
+	bool init_language();
 public:
-	std::unique_ptr<thread_pool_t> thread_pool;
-	std::mutex storage_mutex;
+	std::unique_ptr<job_system_t> job_system;
 	std::string language;
-	std::unordered_map<std::string, std::vector<std::string> > i18n;
-	std::unordered_map<arch_t, noise_t> noises;
-	std::unordered_map<arch_t, animation_t> animations;
-	std::unordered_map<std::string, texture_t> textures;
-	std::unordered_map<std::string, palette_t> palettes;
-	std::unordered_map<std::string, shader_t> shaders;
-	std::unordered_map<std::string, font_t> fonts;
+	std::unique_ptr<i18n_table_t> i18n;
+	vfs_cache_t<arch_t, noise_t> noises;
+	vfs_cache_t<arch_t, animation_t> animations;
+	vfs_cache_t<std::string, texture_t> textures;
+	vfs_cache_t<std::string, palette_t> palettes;
+	vfs_cache_t<std::string, shader_t> shaders;
+	vfs_cache_t<std::string, font_t> fonts;
+	std::array<arch_t, vfs_budget_t::Total> budgets;
+	std::array<std::atomic<arch_t>, vfs_budget_t::Total> residents;
 };
 
 #endif // LEVIATHAN_INCLUDED_UTILITY_VFS_HPP
@@ -0,0 +1,269 @@
+#ifndef LEVIATHAN_INCLUDED_UTILITY_VFS_CACHE_HPP
+#define LEVIATHAN_INCLUDED_UTILITY_VFS_CACHE_HPP
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+#include "../types.hpp"
+
+// Bookkeeping is kept apart from the resource, so handles work on incomplete types.
+struct vfs_usage_t : public not_copyable_t {
+public:
+	vfs_usage_t() :
+		references(0),
+		pinned(false),
+		last_used(vfs_usage_t::now())
+	{
+
+	}
+	vfs_usage_t(vfs_usage_t&&) = delete;
+	vfs_usage_t& operator=(vfs_usage_t&&) = delete;
+	~vfs_usage_t() = default;
+public:
+	static sint64_t now() {
+		return std::chrono::steady_clock::now().time_since_epoch().count();
+	}
+	void touch() {
+		last_used.store(vfs_usage_t::now(), std::memory_order_relaxed);
+	}
+public:
+	std::atomic<sint_t> references;
+	std::atomic<bool> pinned;
+	std::atomic<sint64_t> last_used;
+};
+
+template<typename T>
+struct vfs_entry_t : public not_copyable_t {
+public:
+	vfs_entry_t() :
+		once(),
+		loaded(false),
+		usage(),
+		value()
+	{
+
+	}
+	vfs_entry_t(vfs_entry_t&&) = delete;
+	vfs_entry_t& operator=(vfs_entry_t&&) = delete;
+	~vfs_entry_t() = default;
+public:
+	std::once_flag once;
+	std::atomic<bool> loaded;
+	vfs_usage_t usage;
+	T value;
+};
+
+// Keeps its entry out of eviction for as long as it lives.
+template<typename T>
+struct vfs_handle_t {
+public:
+	vfs_handle_t(vfs_usage_t* usage, const T* value) :
+		usage(usage),
+		value(value)
+	{
+		if (usage != nullptr) {
+			usage->references.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	vfs_handle_t(std::nullptr_t) : vfs_handle_t() {}
+	vfs_handle_t() :
+		usage(nullptr),
+		value(nullptr)
+	{
+
+	}
+	vfs_handle_t(const vfs_handle_t& that) : vfs_handle_t(that.usage, that.value) {}
+	vfs_handle_t(vfs_handle_t&& that) noexcept : vfs_handle_t() {
+		std::swap(usage, that.usage);
+		std::swap(value, that.value);
+	}
+	vfs_handle_t& operator=(const vfs_handle_t& that) {
+		if (this != &that) {
+			vfs_handle_t copy{ that };
+			std::swap(usage, copy.usage);
+			std::swap(value, copy.value);
+		}
+		return *this;
+	}
+	vfs_handle_t& operator=(vfs_handle_t&& that) noexcept {
+		if (this != &that) {
+			std::swap(usage, that.usage);
+			std::swap(value, that.value);
+		}
+		return *this;
+	}
+	~vfs_handle_t() {
+		this->reset();
+	}
+public:
+	void reset() {
+		if (usage != nullptr) {
+			usage->touch();
+			usage->references.fetch_sub(1, std::memory_order_release);
+		}
+		usage = nullptr;
+		value = nullptr;
+	}
+	const T* get() const {
+		return value;
+	}
+	const T* operator->() const {
+		return value;
+	}
+	operator const T*() const {
+		return value;
+	}
+private:
+	vfs_usage_t* usage;
+	const T* value;
+};
+
+// Resources live in node based maps, so their addresses never change after insertion.
+// Lookups only lock the shard owning the key, and the first requester of a key runs
+// its loader exactly once while any other requesters of that key wait on it.
+// Entries handed out as raw pointers are pinned, since nothing tracks who holds them.
+template<typename K, typename T, arch_t N = 16>
+struct vfs_cache_t : public not_copyable_t {
+public:
+	vfs_cache_t() = default;
+	vfs_cache_t(vfs_cache_t&&) = delete;
+	vfs_cache_t& operator=(vfs_cache_t&&) = delete;
+	~vfs_cache_t() = default;
+public:
+	template<typename L>
+	T& fetch(const K& key, L&& loader) {
+		vfs_entry_t<T>* entry = nullptr;
+		{
+			shard_t& shard = this->get_shard(key);
+			std::lock_guard<std::mutex> lock{ shard.mutex };
+			entry = &shard.entries.try_emplace(key).first->second;
+			entry->usage.pinned.store(true, std::memory_order_relaxed);
+		}
+		this->load(entry, loader);
+		return entry->value;
+	}
+	template<typename L>
+	vfs_handle_t<T> acquire(const K& key, L&& loader) {
+		vfs_handle_t<T> handle;
+		vfs_entry_t<T>* entry = nullptr;
+		{
+			// The reference has to be taken under the lock, or evict() could take the entry first.
+			shard_t& shard = this->get_shard(key);
+			std::lock_guard<std::mutex> lock{ shard.mutex };
+			entry = &shard.entries.try_emplace(key).first->second;
+			handle = vfs_handle_t<T>(&entry->usage, &entry->value);
+		}
+		entry->usage.touch();
+		this->load(entry, loader);
+		return handle;
+	}
+	const T* find(const K& key) const {
+		const shard_t& shard = this->get_shard(key);
+		std::lock_guard<std::mutex> lock{ shard.mutex };
+		auto it = shard.entries.find(key);
+		if (it == shard.entries.end()) {
+			return nullptr;
+		}
+		return &it->second.value;
+	}
+	void clear() {
+		for (auto&& shard : shards) {
+			std::lock_guard<std::mutex> lock{ shard.mutex };
+			shard.entries.clear();
+		}
+	}
+	arch_t size() const {
+		arch_t result = 0;
+		for (auto&& shard : shards) {
+			std::lock_guard<std::mutex> lock{ shard.mutex };
+			result += shard.entries.size();
+		}
+		return result;
+	}
+	arch_t measure() const {
+		arch_t result = 0;
+		for (auto&& shard : shards) {
+			std::lock_guard<std::mutex> lock{ shard.mutex };
+			for (auto&& [key, entry] : shard.entries) {
+				if (entry.loaded.load(std::memory_order_acquire)) {
+					result += entry.value.get_footprint();
+				}
+			}
+		}
+		return result;
+	}
+	// Drops unreferenced, unpinned entries least recently used first until the
+	// footprint fits the budget. Returns the footprint left afterwards.
+	arch_t evict(arch_t budget) {
+		struct candidate_t {
+			sint64_t last_used;
+			arch_t shard, bytes;
+			K key;
+		};
+		std::vector<candidate_t> candidates;
+		arch_t total = 0;
+		for (arch_t it = 0; it < N; ++it) {
+			std::lock_guard<std::mutex> lock{ shards[it].mutex };
+			for (auto&& [key, entry] : shards[it].entries) {
+				if (!entry.loaded.load(std::memory_order_acquire)) {
+					continue;
+				}
+				const arch_t bytes = entry.value.get_footprint();
+				total += bytes;
+				if (bytes > 0 and !entry.usage.pinned.load(std::memory_order_relaxed) and entry.usage.references.load(std::memory_order_acquire) == 0) {
+					candidates.push_back({ entry.usage.last_used.load(std::memory_order_relaxed), it, bytes, key });
+				}
+			}
+		}
+		if (total <= budget) {
+			return total;
+		}
+		std::sort(candidates.begin(), candidates.end(), [](const candidate_t& lhv, const candidate_t& rhv) {
+			return lhv.last_used < rhv.last_used;
+		});
+		for (auto&& candidate : candidates) {
+			if (total <= budget) {
+				break;
+			}
+			shard_t& shard = shards[candidate.shard];
+			std::lock_guard<std::mutex> lock{ shard.mutex };
+			auto found = shard.entries.find(candidate.key);
+			if (found == shard.entries.end()) {
+				continue;
+			}
+			const vfs_usage_t& usage = found->second.usage;
+			if (!usage.pinned.load(std::memory_order_relaxed) and usage.references.load(std::memory_order_acquire) == 0) {
+				shard.entries.erase(found);
+				total -= candidate.bytes;
+			}
+		}
+		return total;
+	}
+private:
+	template<typename L>
+	void load(vfs_entry_t<T>* entry, L& loader) {
+		std::call_once(entry->once, [&loader, entry] {
+			loader(entry->value);
+			entry->loaded.store(true, std::memory_order_release);
+		});
+	}
+	struct alignas(64) shard_t {
+		mutable std::mutex mutex;
+		std::unordered_map<K, vfs_entry_t<T> > entries;
+	};
+	shard_t& get_shard(const K& key) {
+		return shards[std::hash<K>{}(key) % N];
+	}
+	const shard_t& get_shard(const K& key) const {
+		return shards[std::hash<K>{}(key) % N];
+	}
+private:
+	std::array<shard_t, N> shards;
+};
+
+#endif // LEVIATHAN_INCLUDED_UTILITY_VFS_CACHE_HPP
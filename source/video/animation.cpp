@@ -1,14 +1,62 @@
 #include "./animation.hpp"
 
-#include "../utility/thread_pool.hpp"
+#include "../utility/archive.hpp"
 #include "../utility/setup_file.hpp"
 #include "../utility/logger.hpp"
 #include "../utility/vfs.hpp"
 #include "../system/renderer.hpp"
 
+static const byte_t kCookedExtension[] = ".anm";
+
+// Written by scripts/cook_animations.py. The header is followed by the material names,
+// then every sequence record, each trailed by its variations' action points and frames.
+struct animation_header_t {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t sequences;
+	uint32_t materials;
+	real_t inverter[2];
+	archive_string_t palette;
+	uint32_t strings;
+	uint32_t reserved;
+};
+
+struct animation_record_t {
+	real_t starts[2];
+	real_t dimensions[2];
+	real64_t delay;
+	uint32_t frames;
+	uint32_t variations;
+	uint32_t repeat;
+	uint32_t reflect;
+};
+
+static_assert(sizeof(animation_header_t) == 40, "Cooked animation header must stay 40 bytes!");
+static_assert(sizeof(animation_record_t) == 40, "Cooked animation records must stay 40 bytes!");
+
+// Sheets in the atlas are drawn from its pages, with the page standing in for the palette row.
+// Each pipeline has an instanced twin, used whenever the renderer could create it.
+static const atlas_entry_t* select_sheet(renderer_t& renderer, layer_t layer, const palette_t* palette, const texture_t*& sheet, pipeline_t& pipeline, real_t& index) {
+	const bool instanced = renderer.instanced();
+	pipeline = instanced ? pipeline_t::VtxSpriteSprites : pipeline_t::VtxMajorSprites;
+	if (palette != nullptr) {
+		pipeline = instanced ? pipeline_t::VtxSpriteIndexed : pipeline_t::VtxMajorIndexed;
+		index = palette->convert(index);
+		return nullptr;
+	}
+	const atlas_entry_t* entry = renderer.get_atlas_entry(sheet, layer);
+	if (entry != nullptr) {
+		pipeline = instanced ? pipeline_t::VtxSpriteAtlas : pipeline_t::VtxMajorAtlas;
+		index = entry->layer;
+		sheet = renderer.get_atlas();
+	}
+	return entry;
+}
+
 animation_t::animation_t() :
 	ready(false),
-	future(),
+	counter(),
+	path(),
 	sequences(),
 	inverts(1.0f),
 	texture(nullptr),
@@ -23,7 +71,8 @@ animation_t::animation_t(animation_t&& that) noexcept : animation_t() {
 		ready.store(that.ready.load());
 		that.ready.store(temp.load());
 
-		std::swap(future, that.future);
+		std::swap(counter, that.counter);
+		std::swap(path, that.path);
 		std::swap(sequences, that.sequences);
 		std::swap(inverts, that.inverts);
 		std::swap(texture, that.texture);
@@ -37,7 +86,8 @@ animation_t& animation_t::operator=(animation_t&& that) noexcept {
 		ready.store(that.ready.load());
 		that.ready.store(temp.load());
 
-		std::swap(future, that.future);
+		std::swap(counter, that.counter);
+		std::swap(path, that.path);
 		std::swap(sequences, that.sequences);
 		std::swap(inverts, that.inverts);
 		std::swap(texture, that.texture);
@@ -46,6 +96,10 @@ animation_t& animation_t::operator=(animation_t&& that) noexcept {
 	return *this;
 }
 
+animation_t::~animation_t() {
+	counter.wait();
+}
+
 void animation_t::update(real64_t delta, bool_t& amend, arch_t state, real64_t& timer, arch_t& frame) const {
 	this->assure();
 	if (state < sequences.size()) {
@@ -60,20 +114,30 @@ void animation_t::render(renderer_t& renderer, const rect_t& viewport, bool_t pa
 		glm::vec2 sequorig = sequences[state].get_origin(frame, variation, mirroring);
 		if (viewport.overlaps(position - sequorig, sequsize * scale)) {
 			rect_t seququad = sequences[state].get_quad(inverts, frame, variation);
+			const texture_t* sheet = texture;
 			pipeline_t pipeline = pipeline_t::VtxMajorSprites;
-			if (palette != nullptr) {
-				pipeline = pipeline_t::VtxMajorIndexed;
-				index = palette->convert(index);
+			const atlas_entry_t* entry = select_sheet(renderer, layer, palette, sheet, pipeline, index);
+			if (entry != nullptr) {
+				seququad = entry->convert(seququad);
 			}
 			auto& list = renderer.get_normal_quads(
 				layer,
 				blend_mode_t::Alpha,
 				buffer_usage_t::Dynamic,
 				pipeline,
-				texture,
+				sheet,
 				palette
 			);
-			if (amend or panic) {
+			if (renderer.instanced()) {
+				if (amend or panic or renderer.repacked()) {
+					amend = false;
+					list.begin(display_list_t::SingleSprite)
+						.vtx_sprite_write(seququad, sequsize, index, alpha, mirroring, position - sequorig, scale, pivot, angle)
+					.end();
+				} else {
+					list.skip(display_list_t::SingleSprite);
+				}
+			} else if (amend or panic or renderer.repacked()) {
 				amend = false;
 				list.begin(display_list_t::SingleQuad)
 					.vtx_major_write(seququad, sequsize, index, alpha, mirroring)
@@ -93,20 +157,30 @@ void animation_t::render(renderer_t& renderer, const rect_t& viewport, bool_t pa
 		glm::vec2 sequorig = sequences[state].get_origin(frame, variation, mirroring);
 		if (viewport.overlaps(position - sequorig, sequsize * scale)) {
 			rect_t seququad = sequences[state].get_quad(inverts, frame, variation);
+			const texture_t* sheet = texture;
 			pipeline_t pipeline = pipeline_t::VtxMajorSprites;
-			if (palette != nullptr) {
-				pipeline = pipeline_t::VtxMajorIndexed;
-				index = palette->convert(index);
+			const atlas_entry_t* entry = select_sheet(renderer, layer, palette, sheet, pipeline, index);
+			if (entry != nullptr) {
+				seququad = entry->convert(seququad);
 			}
 			auto& list = renderer.get_normal_quads(
 				layer,
 				blend_mode_t::Alpha,
 				buffer_usage_t::Dynamic,
 				pipeline,
-				texture,
+				sheet,
 				palette
 			);
-			if (amend or panic) {
+			if (renderer.instanced()) {
+				if (amend or panic or renderer.repacked()) {
+					amend = false;
+					list.begin(display_list_t::SingleSprite)
+						.vtx_sprite_write(seququad, sequsize, index, alpha, mirroring, position - sequorig, scale, glm::zero<glm::vec2>(), 0.0f)
+					.end();
+				} else {
+					list.skip(display_list_t::SingleSprite);
+				}
+			} else if (amend or panic or renderer.repacked()) {
 				amend = false;
 				list.begin(display_list_t::SingleQuad)
 					.vtx_major_write(seququad, sequsize, index, alpha, mirroring)
@@ -122,30 +196,37 @@ void animation_t::render(renderer_t& renderer, const rect_t& viewport, bool_t pa
 void animation_t::render(renderer_t& renderer, bool_t& amend, arch_t state, arch_t frame, arch_t variation, real_t index, glm::vec2 position) const {
 	this->assure();
 	if (state < sequences.size()) {
+		const texture_t* sheet = texture;
 		pipeline_t pipeline = pipeline_t::VtxMajorSprites;
-		if (palette != nullptr) {
-			pipeline = pipeline_t::VtxMajorIndexed;
-			index = palette->convert(index);
-		}
+		const atlas_entry_t* entry = select_sheet(renderer, layer_value::HeadsUp, palette, sheet, pipeline, index);
 		auto& list = renderer.get_overlay_quads(
 			layer_value::HeadsUp,
 			blend_mode_t::Alpha,
 			buffer_usage_t::Dynamic,
 			pipeline,
-			texture,
+			sheet,
 			palette
 		);
-		if (amend) {
+		if (amend or renderer.repacked()) {
 			amend = false;
 			glm::vec2 sequsize = sequences[state].get_dimensions();
 			glm::vec2 sequorig = sequences[state].get_origin(frame, variation, mirroring_t::None);
 			rect_t seququads   = sequences[state].get_quad(inverts, frame, variation);
-			list.begin(display_list_t::SingleQuad)
-				.vtx_major_write(seququads, sequsize, index, 1.0f, mirroring_t::None)
-				.vtx_transform_write(position - sequorig)
-			.end();
+			if (entry != nullptr) {
+				seququads = entry->convert(seququads);
+			}
+			if (renderer.instanced()) {
+				list.begin(display_list_t::SingleSprite)
+					.vtx_sprite_write(seququads, sequsize, index, 1.0f, mirroring_t::None, position - sequorig, glm::one<glm::vec2>(), glm::zero<glm::vec2>(), 0.0f)
+				.end();
+			} else {
+				list.begin(display_list_t::SingleQuad)
+					.vtx_major_write(seququads, sequsize, index, 1.0f, mirroring_t::None)
+					.vtx_transform_write(position - sequorig)
+				.end();
+			}
 		} else {
-			list.skip(display_list_t::SingleQuad);
+			list.skip(renderer.instanced() ? display_list_t::SingleSprite : display_list_t::SingleQuad);
 		}
 	}
 }
@@ -155,29 +236,28 @@ void animation_t::load(const std::string& full_path) {
 		synao_log("Warning! Tried to overwrite animation!\n");
 		return;
 	}
+	const std::string cooked_path = full_path.substr(0, full_path.find_last_of('.')) + kCookedExtension;
+	if (vfs::contains(cooked_path)) {
+		if (this->cooked(cooked_path)) {
+			ready = true;
+			return;
+		}
+		synao_warn(Video, "Cooked animation at %s is invalid! Falling back to its cfg file.\n", cooked_path.c_str());
+		sequences.clear();
+	}
 	setup_file_t setup;
 	if (setup.load(full_path)) {
 		std::vector<std::string> matfile;
 		std::string palfile;
+		glm::vec2 inverter = glm::one<glm::vec2>();
 		setup.get("Main", "Material", matfile);
 		setup.get("Main", "Palettes", palfile);
-		setup.get("Main", "Inverter", inverts);
-
-		if (inverts.x == 0.0f or inverts.y == 0.0f) {
-			inverts = glm::one<glm::vec2>();
-		} else {
-			inverts = 1.0f / inverts;
-		}
-
-		if (!matfile.empty()) {
-			texture = vfs::texture(matfile);
-		}
-		if (!palfile.empty()) {
-			palette = vfs::palette(palfile);
-		}
+		setup.get("Main", "Inverter", inverter);
+		this->prepare(matfile, palfile, inverter);
 
 		glm::vec4 points = glm::zero<glm::vec4>();
 		glm::vec2 axnpnt = glm::zero<glm::vec2>();
+		std::string key;
 
 		for (arch_t chunk = 1; chunk < setup.size(); ++chunk) {
 			glm::vec2 starts = glm::zero<glm::vec2>();
@@ -197,36 +277,113 @@ void animation_t::load(const std::string& full_path) {
 
 			auto& sequence = sequences.emplace_back(vksize, tdelay, frames, repeat, reflect);
 			for (arch_t d = 0; d < hvtype; ++d) {
+				// Keys are "<variation>-X" and "<variation>-<frame>", so the prefix is shared.
+				key = std::to_string(d);
+				key += '-';
+				const arch_t prefix = key.size();
 				axnpnt = glm::zero<glm::vec2>();
-				setup.get(chunk, std::to_string(d) + "-X", axnpnt);
+				key += 'X';
+				setup.get(chunk, key, axnpnt);
 				sequence.append(axnpnt);
 				for (arch_t f = 0; f < frames; ++f) {
 					points = glm::zero<glm::vec4>();
-					setup.get(
-						chunk,
-						std::to_string(d) + '-' + std::to_string(f),
-						points
-					);
+					key.resize(prefix);
+					key += std::to_string(f);
+					setup.get(chunk, key, points);
 					sequence.append(inverts, starts, points);
 				}
 			}
 		}
 		ready = true;
 	} else {
-		synao_log("Failed to load animation from %s!\n", full_path.c_str());
+		synao_warn(Video, "Failed to load animation from %s!\n", full_path.c_str());
 	}
 }
 
-void animation_t::load(const std::string& full_path, thread_pool_t& thread_pool) {
+bool animation_t::cooked(const std::string& full_path) {
+	const archive_blob_t blob = vfs::memory(full_path);
+	archive_reader_t reader{ blob };
+	animation_header_t header;
+	if (!reader.take(header) or header.magic != animation_t::Magic or header.version != animation_t::Version) {
+		return false;
+	}
+	if (!reader.strings(header.strings)) {
+		return false;
+	}
+	std::vector<std::string> matfile;
+	std::string palfile;
+	for (uint32_t it = 0; it < header.materials; ++it) {
+		archive_string_t material;
+		if (!reader.take(material) or !reader.resolve(material, matfile.emplace_back())) {
+			return false;
+		}
+	}
+	if (!reader.resolve(header.palette, palfile)) {
+		return false;
+	}
+	// Sequences are validated in full before any textures get requested for them.
+	const glm::vec2 inverter = glm::vec2(header.inverter[0], header.inverter[1]);
+	const glm::vec2 inverse = (inverter.x == 0.0f or inverter.y == 0.0f) ?
+		glm::one<glm::vec2>() :
+		1.0f / inverter;
+	for (uint32_t it = 0; it < header.sequences; ++it) {
+		animation_record_t record;
+		if (!reader.take(record)) {
+			return false;
+		}
+		const glm::vec2 starts = glm::vec2(record.starts[0], record.starts[1]);
+		auto& sequence = sequences.emplace_back(
+			glm::vec2(record.dimensions[0], record.dimensions[1]),
+			record.delay,
+			static_cast<arch_t>(record.frames),
+			static_cast<bool_t>(record.repeat),
+			static_cast<bool_t>(record.reflect)
+		);
+		for (uint32_t d = 0; d < record.variations; ++d) {
+			real_t axnpnt[2];
+			if (!reader.take(axnpnt)) {
+				return false;
+			}
+			sequence.append(glm::vec2(axnpnt[0], axnpnt[1]));
+			for (uint32_t f = 0; f < record.frames; ++f) {
+				real_t points[4];
+				if (!reader.take(points)) {
+					return false;
+				}
+				sequence.append(inverse, starts, glm::vec4(points[0], points[1], points[2], points[3]));
+			}
+		}
+	}
+	this->prepare(matfile, palfile, inverter);
+	return true;
+}
+
+void animation_t::prepare(const std::vector<std::string>& matfile, const std::string& palfile, glm::vec2 inverter) {
+	if (inverter.x == 0.0f or inverter.y == 0.0f) {
+		inverts = glm::one<glm::vec2>();
+	} else {
+		inverts = 1.0f / inverter;
+	}
+	if (!matfile.empty()) {
+		texture = vfs::acquire_texture(matfile);
+	}
+	if (!palfile.empty()) {
+		palette = vfs::acquire_palette(palfile);
+	}
+}
+
+void animation_t::load(const std::string& full_path, job_system_t& job_system) {
 	assert(!ready);
-	this->future = thread_pool.push([this](const std::string& full_path) -> void {
-		this->load(full_path);
-	}, full_path);
+	path = full_path;
+	job_system.push(job_priority_t::Urgent, &counter, [this] {
+		this->load(this->path);
+		this->path.clear();
+	});
 }
 
 void animation_t::assure() const {
-	if (!ready and future.valid()) {
-		future.wait();
+	if (!ready and counter.valid()) {
+		counter.wait();
 	}
 }
 
@@ -266,3 +423,14 @@ glm::vec2 animation_t::get_action_point(arch_t state, arch_t variation, mirrorin
 	}
 	return glm::zero<glm::vec2>();
 }
+
+arch_t animation_t::get_footprint() const {
+	if (!ready.load(std::memory_order_acquire)) {
+		return 0;
+	}
+	arch_t result = 0;
+	for (auto&& sequence : sequences) {
+		result += sequence.get_footprint();
+	}
+	return result;
+}
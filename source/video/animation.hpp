@@ -1,12 +1,11 @@
 #ifndef LEVIATHAN_INCLUDED_VIDEO_ANIMATION_HPP
 #define LEVIATHAN_INCLUDED_VIDEO_ANIMATION_HPP
 
-#include <future>
-
 #include "./animation_sequence.hpp"
 #include "../utility/enums.hpp"
+#include "../utility/job_system.hpp"
+#include "../utility/vfs_cache.hpp"
 
-struct thread_pool_t;
 struct texture_t;
 struct palette_t;
 struct renderer_t;
@@ -16,26 +15,34 @@ public:
 	animation_t();
 	animation_t(animation_t&& that) noexcept;
 	animation_t& operator=(animation_t&& that) noexcept;
-	~animation_t() = default;
+	~animation_t();
 public:
 	void update(real64_t delta, bool_t& amend, arch_t state, real64_t& timer, arch_t& frame) const;
 	void render(renderer_t& renderer, const rect_t& viewport, bool_t panic, bool_t& amend, arch_t state, arch_t frame, arch_t variation, mirroring_t mirroring, layer_t layer, real_t alpha, real_t index, glm::vec2 position, glm::vec2 scale, real_t angle, glm::vec2 pivot) const;
 	void render(renderer_t& renderer, const rect_t& viewport, bool_t panic, bool_t& amend, arch_t state, arch_t frame, arch_t variation, mirroring_t mirroring, layer_t layer, real_t alpha, real_t index, glm::vec2 position, glm::vec2 scale) const;
 	void render(renderer_t& renderer, bool_t& amend, arch_t state, arch_t frame, arch_t variation, real_t index, glm::vec2 position) const;
 	void load(const std::string& full_path);
-	void load(const std::string& full_path, thread_pool_t& thread_pool);
+	void load(const std::string& full_path, job_system_t& job_system);
 	void assure() const;
 	bool visible(const rect_t& viewport, arch_t state, arch_t frame, arch_t variation, layer_t layer, glm::vec2 position, glm::vec2 scale) const;
 	bool is_finished(arch_t state, arch_t frame, real64_t timer) const;
 	glm::vec2 get_origin(arch_t state, arch_t frame, arch_t variation, mirroring_t mirroring) const;
 	glm::vec2 get_action_point(arch_t state, arch_t variation, mirroring_t mirroring) const;
+	arch_t get_footprint() const;
+public:
+	static constexpr uint32_t Magic = 0x4D4E414C;
+	static constexpr uint32_t Version = 1;
+private:
+	bool cooked(const std::string& full_path);
+	void prepare(const std::vector<std::string>& matfile, const std::string& palfile, glm::vec2 inverter);
 private:
 	std::atomic<bool> ready;
-	std::future<void> future;
+	job_counter_t counter;
+	std::string path;
 	std::vector<animation_sequence_t> sequences;
 	glm::vec2 inverts;
-	const texture_t* texture;
-	const palette_t* palette;
+	vfs_handle_t<texture_t> texture;
+	vfs_handle_t<palette_t> palette;
 };
 
 #endif // LEVIATHAN_INCLUDED_VIDEO_ANIMATION_HPP
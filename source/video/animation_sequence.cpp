@@ -159,4 +159,10 @@ bool animation_sequence_t::is_finished(arch_t frame, real64_t timer) const {
 		return timer > delay;
 	}
 	return false;
+}
+
+arch_t animation_sequence_t::get_footprint() const {
+	return sizeof(animation_sequence_t) +
+		frames.capacity() * sizeof(sequence_frame_t) +
+		action_points.capacity() * sizeof(glm::vec2);
 }
\ No newline at end of file
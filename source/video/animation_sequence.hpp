@@ -40,6 +40,7 @@ public:
 	glm::vec2 get_origin(arch_t frame, arch_t variation, mirroring_t mirroring) const;
 	glm::vec2 get_action_point(arch_t variation, mirroring_t mirroring) const;
 	bool is_finished(arch_t frame, real64_t timer) const;
+	arch_t get_footprint() const;
 private:
 	std::vector<sequence_frame_t> frames;
 	std::vector<glm::vec2> action_points;
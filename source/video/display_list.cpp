@@ -1,10 +1,13 @@
 #include "./display_list.hpp"
 #include "./program.hpp"
+#include "./texture.hpp"
+#include "./palette.hpp"
 
 #include "../utility/watch.hpp"
 #include "../utility/rect.hpp"
 
-display_list_t::display_list_t(layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, const texture_t* texture, const palette_t* palette, const program_t* program, const quad_buffer_allocator_t* allocator) :
+display_list_t::display_list_t(layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, const texture_t* texture, const palette_t* palette, const program_t* program, uint64_t key, const quad_buffer_allocator_t* allocator, vertex_stream_t* ring) :
+	key(key),
 	layer(layer),
 	blend_mode(blend_mode),
 	texture(texture),
@@ -23,10 +26,11 @@ display_list_t::display_list_t(layer_t layer, blend_mode_t blend_mode, buffer_us
 		specify = program->get_specify();
 	}
 	quad_pool.setup(specify);
-	quad_buffer.setup(allocator, usage, specify);
+	quad_buffer.setup(allocator, ring, usage, specify);
 }
 
 display_list_t::display_list_t() :
+	key(0),
 	layer(layer_value::Automatic),
 	blend_mode(blend_mode_t::None),
 	texture(nullptr),
@@ -45,6 +49,7 @@ display_list_t::display_list_t() :
 
 display_list_t::display_list_t(display_list_t&& that) noexcept : display_list_t() {
 	if (this != &that) {
+		std::swap(key, that.key);
 		std::swap(layer, that.layer);
 		std::swap(blend_mode, that.blend_mode);
 		std::swap(texture, that.texture);
@@ -62,6 +67,7 @@ display_list_t::display_list_t(display_list_t&& that) noexcept : display_list_t(
 
 display_list_t& display_list_t::operator=(display_list_t&& that) noexcept {
 	if (this != &that) {
+		std::swap(key, that.key);
 		std::swap(layer, that.layer);
 		std::swap(blend_mode, that.blend_mode);
 		std::swap(texture, that.texture);
@@ -141,6 +147,27 @@ display_list_t& display_list_t::vtx_blank_write(rect_t raster_rect, glm::vec4 vt
 	return *this;
 }
 
+// Mirroring swaps the corners of the texture rectangle, which the vertex shader interpolates between.
+display_list_t& display_list_t::vtx_sprite_write(rect_t texture_rect, glm::vec2 raster_dimensions, real_t table_index, real_t alpha_color, mirroring_t mirroring, glm::vec2 position, glm::vec2 scale, glm::vec2 axis, real_t rotation) {
+	auto vtx = quad_pool.at<vtx_sprite_t>(current);
+	glm::vec4 uvcoords = glm::vec4(texture_rect.left_top(), texture_rect.right_bottom());
+	if (mirroring == mirroring_t::Horizontal or mirroring == mirroring_t::Both) {
+		std::swap(uvcoords.x, uvcoords.z);
+	}
+	if (mirroring == mirroring_t::Vertical or mirroring == mirroring_t::Both) {
+		std::swap(uvcoords.y, uvcoords.w);
+	}
+	vtx->position 	= position;
+	vtx->dimensions = raster_dimensions;
+	vtx->uvcoords 	= uvcoords;
+	vtx->scale 		= scale;
+	vtx->axis 		= axis;
+	vtx->rotation 	= rotation;
+	vtx->table 		= table_index;
+	vtx->alpha 		= alpha_color;
+	return *this;
+}
+
 display_list_t& display_list_t::vtx_transform_write(glm::vec2 position, glm::vec2 scale, glm::vec2 axis, real_t rotation) {
 	auto vtx = reinterpret_cast<vtx_minor_t*>(quad_pool[current]);
 	glm::vec2 left_top = position + (scale * vtx->position);
@@ -199,10 +226,16 @@ void display_list_t::skip() {
 	account = 0;
 }
 
+// Lists sampling something still in the upload queue are skipped until it's resident.
 void display_list_t::flush(gfx_t& gfx) {
-	visible = current != 0;
+	visible = current != 0 and
+		(texture == nullptr or texture->assure()) and
+		(palette == nullptr or palette->assure());
 	if (visible) {
-		if (amend) {
+		// Streamed lists leave their own buffer behind, so it's refreshed if the ring ever fills up.
+		if (quad_buffer.stream(quad_pool[0], current)) {
+			amend = true;
+		} else if (amend) {
 			amend = false;
 			if (current > quad_buffer.get_length()) {
 				quad_buffer.create(current);
@@ -257,23 +290,24 @@ bool display_list_t::persists() const {
 	return timestamp != 0;
 }
 
-bool operator<(const display_list_t& lhv, const display_list_t& rhv) {
-	if (layer_value::equal(lhv.layer, rhv.layer)) {
-		if (lhv.blend_mode == rhv.blend_mode) {
-			buffer_usage_t lhu = lhv.quad_buffer.get_usage();
-			buffer_usage_t rhu = rhv.quad_buffer.get_usage();
-			if (lhu == rhu) {
-				if (lhv.texture == rhv.texture) {
-					if (lhv.palette == rhv.palette) {
-						return lhv.program < rhv.program;
-					}
-					return lhv.palette < rhv.palette;
-				}
-				return lhv.texture < rhv.texture;
-			}
-			return lhu < rhu;
-		}
-		return lhv.blend_mode < rhv.blend_mode;
-	}
-	return lhv.layer < rhv.layer;
+uint64_t display_list_t::get_key() const {
+	return key;
+}
+
+// From the most significant bits down: the layer rounded to tenths, the blend mode,
+// the usage, and then the texture, palette and program ids the renderer hands out.
+// Ids past their limit share a key, so lookups still have to check matches().
+uint64_t display_list_t::pack(layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, uint64_t texture, uint64_t palette, uint64_t program) {
+	const sint_t tenths = glm::clamp(
+		layer_value::quantize(layer),
+		static_cast<sint_t>(INT16_MIN),
+		static_cast<sint_t>(INT16_MAX)
+	);
+	return
+		(static_cast<uint64_t>(tenths - INT16_MIN) << 48) |
+		(static_cast<uint64_t>(blend_mode) << 45) |
+		(static_cast<uint64_t>(usage) << 43) |
+		(glm::min(texture, TextureLimit) << 23) |
+		(glm::min(palette, PaletteLimit) << 5) |
+		glm::min(program, ProgramLimit);
 }
@@ -11,10 +11,11 @@ struct texture_t;
 struct palette_t;
 struct program_t;
 struct rect_t;
+struct vertex_stream_t;
 
 struct display_list_t : public not_copyable_t {
 public:
-	display_list_t(layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, const texture_t* texture, const palette_t* palette, const program_t* program, const quad_buffer_allocator_t* allocator);
+	display_list_t(layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, const texture_t* texture, const palette_t* palette, const program_t* program, uint64_t key, const quad_buffer_allocator_t* allocator, vertex_stream_t* ring);
 	display_list_t();
 	display_list_t(display_list_t&& that) noexcept;
 	display_list_t& operator=(display_list_t&& that) noexcept;
@@ -24,6 +25,7 @@ public:
 	display_list_t& vtx_pool_write(const vertex_pool_t& that_pool);
 	display_list_t& vtx_major_write(rect_t texture_rect, glm::vec2 raster_dimensions, real_t table_index, real_t alpha_color, mirroring_t mirroring);
 	display_list_t& vtx_blank_write(rect_t raster_rect, glm::vec4 vtx_color);
+	display_list_t& vtx_sprite_write(rect_t texture_rect, glm::vec2 raster_dimensions, real_t table_index, real_t alpha_color, mirroring_t mirroring, glm::vec2 position, glm::vec2 scale, glm::vec2 axis, real_t rotation);
 	display_list_t& vtx_transform_write(glm::vec2 position, glm::vec2 scale, glm::vec2 axis, real_t rotation);
 	display_list_t& vtx_transform_write(glm::vec2 position, glm::vec2 axis, real_t rotation);
 	display_list_t& vtx_transform_write(glm::vec2 position, glm::vec2 scale);
@@ -39,10 +41,17 @@ public:
 	bool matches(sint64_t timestamp) const;
 	bool rendered() const;
 	bool persists() const;
-	friend bool operator<(const display_list_t& lhv, const display_list_t& rhv);
+	uint64_t get_key() const;
+	static uint64_t pack(layer_t layer, blend_mode_t blend_mode, buffer_usage_t usage, uint64_t texture, uint64_t palette, uint64_t program);
 public:
 	static constexpr arch_t SingleQuad = 4;
+	static constexpr arch_t SingleSprite = 1;
+	static constexpr uint64_t TextureLimit = (1 << 20) - 1;
+	static constexpr uint64_t PaletteLimit = (1 << 18) - 1;
+	static constexpr uint64_t ProgramLimit = (1 << 5) - 1;
 private:
+	friend struct renderer_t;
+	uint64_t key;
 	layer_t layer;
 	blend_mode_t blend_mode;
 	const texture_t* texture;
@@ -55,6 +64,4 @@ private:
 	quad_buffer_t quad_buffer;
 };
 
-bool operator<(const display_list_t& lhv, const display_list_t& rhv);
-
 #endif // LEVIATHAN_INCLUDED_VIDEO_DISPLAY_LIST_HPP
@@ -2,24 +2,71 @@
 #include "./texture.hpp"
 #include "./palette.hpp"
 
+#include "../utility/archive.hpp"
 #include "../utility/vfs.hpp"
 #include "../utility/logger.hpp"
 
-#include <fstream>
+#include <algorithm>
 #include <nlohmann/json.hpp>
 
+static const byte_t kCookedExtension[] = ".gly";
+
+static constexpr arch_t kDensePage = 32;
+static constexpr uint16_t kNoPage = 0;
+
+// Written by scripts/cook_fonts.py. The header is followed by every glyph record,
+// then every kerning record, and the texture and palette names come last.
+struct font_header_t {
+	uint32_t magic;
+	uint32_t version;
+	real_t dimensions[2];
+	uint32_t glyphs;
+	uint32_t kernings;
+	archive_string_t texture;
+	archive_string_t palette;
+	uint32_t strings;
+	uint32_t reserved;
+};
+
+struct font_glyph_record_t {
+	uint32_t code_point;
+	real_t bounds[4];
+	real_t offsets[2];
+	real_t advance;
+};
+
+struct font_kerning_record_t {
+	uint32_t first;
+	uint32_t second;
+	real_t amount;
+};
+
+static_assert(sizeof(font_header_t) == 48, "Cooked font header must stay 48 bytes!");
+static_assert(sizeof(font_glyph_record_t) == 32, "Cooked font glyphs must stay 32 bytes!");
+static_assert(sizeof(font_kerning_record_t) == 12, "Cooked font kernings must stay 12 bytes!");
+
+static uint64_t kerning_pair(char32_t first, char32_t second) {
+	return (static_cast<uint64_t>(first) << 32) | static_cast<uint64_t>(second);
+}
+
 font_t::font_t() :
-	glyphs(),
+	page_table(),
+	pages(),
+	sparse(),
+	kernings(),
 	dimensions(0.0f),
 	texture(nullptr),
 	palette(nullptr)
 {
-
+	page_table.fill(kNoPage);
 }
 
 font_t::font_t(font_t&& that) noexcept : font_t() {
 	if (this != &that) {
-		std::swap(glyphs, that.glyphs);
+		std::swap(page_table, that.page_table);
+		std::swap(pages, that.pages);
+		std::swap(sparse, that.sparse);
+		std::swap(kernings, that.kernings);
 		std::swap(dimensions, that.dimensions);
 		std::swap(texture, that.texture);
 		std::swap(palette, that.palette);
@@ -28,7 +75,10 @@ font_t::font_t(font_t&& that) noexcept : font_t() {
 
 font_t& font_t::operator=(font_t&& that) noexcept {
 	if (this != &that) {
-		std::swap(glyphs, that.glyphs);
+		std::swap(page_table, that.page_table);
+		std::swap(pages, that.pages);
+		std::swap(sparse, that.sparse);
+		std::swap(kernings, that.kernings);
 		std::swap(dimensions, that.dimensions);
 		std::swap(texture, that.texture);
 		std::swap(palette, that.palette);
@@ -37,43 +87,52 @@ font_t& font_t::operator=(font_t&& that) noexcept {
 }
 
 void font_t::load(const std::string& directory, const std::string& name) {
-	if (glyphs.size() > 0) {
+	if (!pages.empty() or !sparse.empty()) {
 		synao_log("Warning! Tried to overwrite font!\n");
 		return;
 	}
 	const std::string full_path = directory + name;
-	std::ifstream ifs(full_path, std::ios::binary);
-	if (ifs.is_open()) {
-		nlohmann::json file = nlohmann::json::parse(ifs);
-		dimensions.x = std::stof(file["font"]["common"]["-base"].get<std::string>());
-		dimensions.y = std::stof(file["font"]["common"]["-lineHeight"].get<std::string>());
-		texture = vfs::texture({ file["font"]["pages"]["page"]["-file"].get<std::string>() }, directory);
-		palette = vfs::palette(file["font"]["pages"]["page"]["-pllt"].get<std::string>(), directory);
-		for (auto ot : file["font"]["chars"]["char"]) {
-			char32_t id = std::stoi(ot["-id"].get<std::string>());
-			const font_glyph_t glyph(
-				std::stof(ot["-x"].get<std::string>()),
-				std::stof(ot["-y"].get<std::string>()),
-				std::stof(ot["-width"].get<std::string>()),
-				std::stof(ot["-height"].get<std::string>()),
-				std::stof(ot["-xoffset"].get<std::string>()),
-				std::stof(ot["-yoffset"].get<std::string>()),
-				std::stof(ot["-xadvance"].get<std::string>())
-			);
-			glyphs[id] = glyph;
+	const std::string cooked_path = full_path.substr(0, full_path.find_last_of('.')) + kCookedExtension;
+	if (vfs::contains(cooked_path)) {
+		if (this->cooked(directory, cooked_path)) {
+			return;
 		}
-	} else {
-		synao_log("Failed to load font from %s!\n", full_path.c_str());
+		synao_warn(Video, "Cooked font at %s is invalid! Falling back to its fnt file.\n", cooked_path.c_str());
+		kernings.clear();
+	}
+	if (!this->parse(directory, full_path)) {
+		synao_warn(Video, "Failed to load font from %s!\n", full_path.c_str());
 	}
 }
 
 const font_glyph_t& font_t::glyph(char32_t code_point) const {
 	static const font_glyph_t kInvalidGlyph = font_glyph_t();
-	auto it = glyphs.find(code_point);
-	if (it == glyphs.end()) {
-		return kInvalidGlyph;
+	const arch_t page = static_cast<arch_t>(code_point) / PageLength;
+	if (page < PageCount and page_table[page] != kNoPage) {
+		return pages[page_table[page] - 1][code_point % PageLength];
 	}
-	return it->second;
+	if (!sparse.empty()) {
+		auto it = sparse.find(code_point);
+		if (it != sparse.end()) {
+			return it->second;
+		}
+	}
+	return kInvalidGlyph;
+}
+
+real_t font_t::kerning(char32_t first, char32_t second) const {
+	if (kernings.empty()) {
+		return 0.0f;
+	}
+	const uint64_t key = kerning_pair(first, second);
+	auto it = std::lower_bound(
+		kernings.begin(), kernings.end(), key,
+		[](const font_kerning_t& entry, uint64_t value) { return entry.pair < value; }
+	);
+	if (it == kernings.end() or it->pair != key) {
+		return 0.0f;
+	}
+	return it->amount;
 }
 
 const texture_t* font_t::get_texture() const {
@@ -101,3 +160,123 @@ real_t font_t::convert_table(real_t index) const {
 	}
 	return 0.0f;
 }
+
+arch_t font_t::get_footprint() const {
+	return
+		pages.size() * sizeof(font_glyph_t) * PageLength +
+		sparse.size() * (sizeof(char32_t) + sizeof(font_glyph_t)) +
+		kernings.size() * sizeof(font_kerning_t);
+}
+
+bool font_t::cooked(const std::string& directory, const std::string& full_path) {
+	const archive_blob_t blob = vfs::memory(full_path);
+	archive_reader_t reader{ blob };
+	font_header_t header;
+	if (!reader.take(header) or header.magic != font_t::Magic or header.version != font_t::Version) {
+		return false;
+	}
+	if (!reader.strings(header.strings)) {
+		return false;
+	}
+	std::string texture_name, palette_name;
+	if (!reader.resolve(header.texture, texture_name) or !reader.resolve(header.palette, palette_name)) {
+		return false;
+	}
+	std::vector<std::pair<char32_t, font_glyph_t> > entries;
+	for (uint32_t it = 0; it < header.glyphs; ++it) {
+		font_glyph_record_t record;
+		if (!reader.take(record)) {
+			return false;
+		}
+		entries.emplace_back(
+			static_cast<char32_t>(record.code_point),
+			font_glyph_t(
+				record.bounds[0], record.bounds[1],
+				record.bounds[2], record.bounds[3],
+				record.offsets[0], record.offsets[1],
+				record.advance
+			)
+		);
+	}
+	for (uint32_t it = 0; it < header.kernings; ++it) {
+		font_kerning_record_t record;
+		if (!reader.take(record)) {
+			return false;
+		}
+		kernings.push_back({ kerning_pair(record.first, record.second), record.amount });
+	}
+	if (!std::is_sorted(kernings.begin(), kernings.end(), [](const font_kerning_t& lhv, const font_kerning_t& rhv) {
+		return lhv.pair < rhv.pair;
+	})) {
+		return false;
+	}
+	dimensions = glm::vec2(header.dimensions[0], header.dimensions[1]);
+	texture = vfs::texture({ texture_name }, directory);
+	palette = vfs::palette(palette_name, directory);
+	this->index(entries);
+	return true;
+}
+
+bool font_t::parse(const std::string& directory, const std::string& full_path) {
+	const archive_blob_t blob = vfs::memory(full_path);
+	if (blob.empty()) {
+		return false;
+	}
+	nlohmann::json file = nlohmann::json::parse(blob.data(), blob.data() + blob.size());
+	dimensions.x = std::stof(file["font"]["common"]["-base"].get<std::string>());
+	dimensions.y = std::stof(file["font"]["common"]["-lineHeight"].get<std::string>());
+	texture = vfs::texture({ file["font"]["pages"]["page"]["-file"].get<std::string>() }, directory);
+	palette = vfs::palette(file["font"]["pages"]["page"]["-pllt"].get<std::string>(), directory);
+	std::vector<std::pair<char32_t, font_glyph_t> > entries;
+	for (auto ot : file["font"]["chars"]["char"]) {
+		char32_t id = std::stoi(ot["-id"].get<std::string>());
+		entries.emplace_back(id, font_glyph_t(
+			std::stof(ot["-x"].get<std::string>()),
+			std::stof(ot["-y"].get<std::string>()),
+			std::stof(ot["-width"].get<std::string>()),
+			std::stof(ot["-height"].get<std::string>()),
+			std::stof(ot["-xoffset"].get<std::string>()),
+			std::stof(ot["-yoffset"].get<std::string>()),
+			std::stof(ot["-xadvance"].get<std::string>())
+		));
+	}
+	auto kerning_list = file["font"].find("kernings");
+	if (kerning_list != file["font"].end()) {
+		for (auto ot : (*kerning_list)["kerning"]) {
+			const char32_t first = std::stoi(ot["-first"].get<std::string>());
+			const char32_t second = std::stoi(ot["-second"].get<std::string>());
+			kernings.push_back({ kerning_pair(first, second), std::stof(ot["-amount"].get<std::string>()) });
+		}
+		std::stable_sort(kernings.begin(), kernings.end(), [](const font_kerning_t& lhv, const font_kerning_t& rhv) {
+			return lhv.pair < rhv.pair;
+		});
+	}
+	this->index(entries);
+	return true;
+}
+
+// Later entries win, just like repeated ids used to overwrite each other in the map.
+void font_t::index(const std::vector<std::pair<char32_t, font_glyph_t> >& entries) {
+	std::array<arch_t, PageCount> counts;
+	counts.fill(0);
+	for (auto&& entry : entries) {
+		const arch_t page = static_cast<arch_t>(entry.first) / PageLength;
+		if (page < PageCount) {
+			++counts[page];
+		}
+	}
+	for (arch_t page = 0; page < PageCount; ++page) {
+		if (counts[page] >= kDensePage) {
+			pages.emplace_back();
+			page_table[page] = static_cast<uint16_t>(pages.size());
+		}
+	}
+	for (auto&& entry : entries) {
+		const arch_t page = static_cast<arch_t>(entry.first) / PageLength;
+		if (page < PageCount and page_table[page] != kNoPage) {
+			pages[page_table[page] - 1][entry.first % PageLength] = entry.second;
+		} else {
+			sparse[entry.first] = entry.second;
+		}
+	}
+}
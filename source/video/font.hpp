@@ -1,6 +1,8 @@
 #ifndef LEVIATHAN_INCLUDED_VIDEO_FONT_HPP
 #define LEVIATHAN_INCLUDED_VIDEO_FONT_HPP
 
+#include <array>
+#include <vector>
 #include <string>
 #include <unordered_map>
 
@@ -30,6 +32,13 @@ public:
 	~font_glyph_t() = default;
 };
 
+struct font_kerning_t {
+	uint64_t pair;
+	real_t amount;
+};
+
+// Glyphs on well populated pages of the basic multilingual plane are indexed
+// directly, while stragglers and anything above it go in a hash map instead.
 struct font_t : public not_copyable_t {
 public:
 	font_t();
@@ -37,15 +46,29 @@ public:
 	font_t& operator=(font_t&& that) noexcept;
 	~font_t() = default;
 public:
-	void load(const std::string& directory, const std::string& full_path);
+	void load(const std::string& directory, const std::string& name);
 	const font_glyph_t& glyph(char32_t code_point) const;
+	real_t kerning(char32_t first, char32_t second) const;
 	const texture_t* get_texture() const;
 	const palette_t* get_palette() const;
 	glm::vec2 get_dimensions() const;
 	glm::vec2 get_inverse_dimensions() const;
 	real_t convert_table(real_t index) const;
+	arch_t get_footprint() const;
+public:
+	static constexpr uint32_t Magic = 0x594C474C;
+	static constexpr uint32_t Version = 1;
+	static constexpr arch_t PageLength = 256;
+	static constexpr arch_t PageCount = 256;
+private:
+	bool cooked(const std::string& directory, const std::string& full_path);
+	bool parse(const std::string& directory, const std::string& full_path);
+	void index(const std::vector<std::pair<char32_t, font_glyph_t> >& entries);
 private:
-	std::unordered_map<char32_t, font_glyph_t> glyphs;
+	std::array<uint16_t, PageCount> page_table;
+	std::vector<std::array<font_glyph_t, PageLength> > pages;
+	std::unordered_map<char32_t, font_glyph_t> sparse;
+	std::vector<font_kerning_t> kernings;
 	glm::vec2 dimensions;
 	const texture_t* texture;
 	const palette_t* palette;
@@ -85,8 +85,11 @@ void gfx_t::set_sampler(const texture_t* texture, arch_t index) {
 		if (this->samplers[index] != texture) {
 			this->samplers[index] = texture;
 			glCheck(glActiveTexture(GL_TEXTURE0 + static_cast<uint_t>(index)));
+			// Unready textures bind nothing and aren't cached, so they get bound once resident.
 			if (texture != nullptr) {
-				texture->assure();
+				if (!texture->assure()) {
+					this->samplers[index] = nullptr;
+				}
 				if (texture->layers > 1) {
 					glCheck(glBindTexture(GL_TEXTURE_2D_ARRAY, texture->handle));
 				} else {
@@ -103,7 +106,9 @@ void gfx_t::set_sampler(const palette_t* palette, arch_t index) {
 			this->samplers[index] = palette;
 			glCheck(glActiveTexture(GL_TEXTURE0 + static_cast<uint_t>(index)));
 			if (palette != nullptr) {
-				palette->assure();
+				if (!palette->assure()) {
+					this->samplers[index] = nullptr;
+				}
 				glCheck(glBindTexture(GL_TEXTURE_2D, palette->handle));
 			}
 		}
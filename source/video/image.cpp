@@ -1,13 +1,41 @@
 #include "./image.hpp"
 #include "../utility/logger.hpp"
+#include "../utility/vfs.hpp"
 
 #include <cstring>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+static const byte_t kCookedExtension[] = ".tex";
+
+// Written by scripts/cook_textures.py, followed by every level's pixels, largest first.
+struct image_header_t {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t layers;
+	uint32_t levels;
+	uint32_t format;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(image_header_t) == 32, "Cooked image header must stay 32 bytes!");
+
+static glm::ivec2 get_level_extent(glm::ivec2 dimensions, arch_t level) {
+	return glm::max(glm::ivec2(dimensions.x >> level, dimensions.y >> level), glm::ivec2(1));
+}
+
+static arch_t get_level_length(glm::ivec2 dimensions, arch_t level) {
+	const glm::ivec2 extent = get_level_extent(dimensions, level);
+	return static_cast<arch_t>(extent.x) * static_cast<arch_t>(extent.y) * sizeof(uint_t);
+}
+
 image_t::image_t() :
 	dimensions(0),
+	levels(0),
+	offset(0),
 	pixels()
 {
 
@@ -16,6 +44,8 @@ image_t::image_t() :
 image_t::image_t(image_t&& that) noexcept : image_t() {
 	if (this != &that) {
 		std::swap(dimensions, that.dimensions);
+		std::swap(levels, that.levels);
+		std::swap(offset, that.offset);
 		std::swap(pixels, that.pixels);
 	}
 }
@@ -23,42 +53,101 @@ image_t::image_t(image_t&& that) noexcept : image_t() {
 image_t& image_t::operator=(image_t&& that) noexcept {
 	if (this != &that) {
 		std::swap(dimensions, that.dimensions);
+		std::swap(levels, that.levels);
+		std::swap(offset, that.offset);
 		std::swap(pixels, that.pixels);
 	}
 	return *this;
 }
 
-image_t image_t::generate(const std::string& full_path) {
-	image_t image;
+image_t image_t::generate(const std::string& full_path, pixel_format_t format) {
+	image_t image = image_t::cooked(full_path, format);
+	if (!image.empty()) {
+		return image;
+	}
 	sint_t width = 0;
 	sint_t height = 0;
 	sint_t channels = 0;
 
-	stbi_uc* data = stbi_load(
-		full_path.c_str(),
+	const archive_blob_t blob = vfs::memory(full_path);
+	if (blob.empty()) {
+		synao_warn(Video, "Failed to open image from %s!\n", full_path.c_str());
+		return image;
+	}
+	stbi_uc* data = stbi_load_from_memory(
+		reinterpret_cast<const stbi_uc*>(blob.data()),
+		static_cast<sint_t>(blob.size()),
 		&width, &height,
 		&channels,
 		STBI_rgb_alpha
 	);
 	if (data != nullptr) {
-		image.dimensions = glm::ivec2(width, height);
-		image.pixels.resize(
+		std::vector<byte_t> storage(
 			static_cast<arch_t>(width) *
 			static_cast<arch_t>(height) *
 			sizeof(uint_t)
 		);
-		std::memcpy(&image.pixels[0], data, image.pixels.size());
+		std::memcpy(&storage[0], data, storage.size());
 		stbi_image_free(data);
+		image.dimensions = glm::ivec2(width, height);
+		image.levels = 1;
+		image.pixels = archive_blob_t(std::move(storage));
 	} else {
-		synao_log("Failed to load image from %s!\n", full_path.c_str());
+		synao_warn(Video, "Failed to load image from %s!\n", full_path.c_str());
+	}
+	return image;
+}
+
+// Cooked blobs sit next to their png. Inside the archive they're used in place.
+// Ones cooked for another format are ignored, so the png gets decoded instead.
+image_t image_t::cooked(const std::string& full_path, pixel_format_t format) {
+	image_t image;
+	const std::string cooked_path = full_path.substr(0, full_path.rfind('.')) + kCookedExtension;
+	if (!vfs::contains(cooked_path)) {
+		return image;
+	}
+	archive_blob_t blob = vfs::memory(cooked_path);
+	image_header_t header;
+	if (blob.size() < sizeof(image_header_t)) {
+		synao_warn(Video, "Cooked image at %s is truncated!\n", cooked_path.c_str());
+		return image;
+	}
+	std::memcpy(&header, blob.data(), sizeof(image_header_t));
+	if (header.magic != image_t::Magic or header.version != image_t::Version) {
+		synao_warn(Video, "Cooked image at %s has the wrong version!\n", cooked_path.c_str());
+		return image;
+	}
+	if (header.width == 0 or header.height == 0 or header.layers != 1 or header.levels == 0 or header.levels > image_t::MaximumLevels) {
+		synao_warn(Video, "Cooked image at %s has a bad header!\n", cooked_path.c_str());
+		return image;
+	}
+	if (header.format != static_cast<uint32_t>(format)) {
+		synao_warn(Video, "Cooked image at %s has the wrong format! Falling back to its png.\n", cooked_path.c_str());
+		return image;
+	}
+	const glm::ivec2 dimensions = glm::ivec2(
+		static_cast<sint_t>(header.width),
+		static_cast<sint_t>(header.height)
+	);
+	arch_t length = 0;
+	for (arch_t level = 0; level < header.levels; ++level) {
+		length += get_level_length(dimensions, level);
+	}
+	if (blob.size() < sizeof(image_header_t) + length) {
+		synao_warn(Video, "Cooked image at %s is truncated!\n", cooked_path.c_str());
+		return image;
 	}
+	image.dimensions = dimensions;
+	image.levels = header.levels;
+	image.offset = sizeof(image_header_t);
+	image.pixels = std::move(blob);
 	return image;
 }
 
-std::vector<image_t> image_t::generate(const std::vector<std::string>& full_paths) {
+std::vector<image_t> image_t::generate(const std::vector<std::string>& full_paths, pixel_format_t format) {
 	std::vector<image_t> images;
 	for (auto&& full_path : full_paths) {
-		image_t image = image_t::generate(full_path);
+		image_t image = image_t::generate(full_path, format);
 		if (image.empty()) {
 			break;
 		}
@@ -69,15 +158,29 @@ std::vector<image_t> image_t::generate(const std::vector<std::string>& full_path
 
 void image_t::clear() {
 	dimensions = glm::zero<glm::ivec2>();
-	pixels.clear();
+	levels = 0;
+	offset = 0;
+	pixels = archive_blob_t();
 }
 
-byte_t& image_t::operator[](arch_t index) {
-	return pixels[index];
+const byte_t& image_t::operator[](arch_t index) const {
+	return pixels.data()[offset + index];
 }
 
-const byte_t& image_t::operator[](arch_t index) const {
-	return pixels[index];
+const byte_t* image_t::get_level(arch_t level) const {
+	arch_t position = offset;
+	for (arch_t it = 0; it < level; ++it) {
+		position += get_level_length(dimensions, it);
+	}
+	return pixels.data() + position;
+}
+
+glm::ivec2 image_t::get_level_dimensions(arch_t level) const {
+	return get_level_extent(dimensions, level);
+}
+
+arch_t image_t::get_levels() const {
+	return levels;
 }
 
 glm::ivec2 image_t::get_dimensions() const {
@@ -85,9 +188,13 @@ glm::ivec2 image_t::get_dimensions() const {
 }
 
 arch_t image_t::size() const {
-	return pixels.size();
+	arch_t result = 0;
+	for (arch_t level = 0; level < levels; ++level) {
+		result += get_level_length(dimensions, level);
+	}
+	return result;
 }
 
 bool image_t::empty() const {
-	return pixels.empty();
+	return levels == 0 or pixels.size() <= offset;
 }
@@ -4,8 +4,11 @@
 #include <string>
 #include <vector>
 
-#include "../types.hpp"
+#include "./gfx.hpp"
+#include "../utility/archive.hpp"
 
+// Pixels are either decoded from a png, or viewed straight out of a blob that
+// scripts/cook_textures.py prepared, in which case the whole mip chain comes along.
 struct image_t : public not_copyable_t {
 public:
 	image_t();
@@ -14,16 +17,25 @@ public:
 	~image_t() = default;
 public:
 	void clear();
-	byte_t& operator[](arch_t index);
 	const byte_t& operator[](arch_t index) const;
+	const byte_t* get_level(arch_t level) const;
+	glm::ivec2 get_level_dimensions(arch_t level) const;
+	arch_t get_levels() const;
 	glm::ivec2 get_dimensions() const;
 	arch_t size() const;
 	bool empty() const;
-	static image_t generate(const std::string& full_path);
-	static std::vector<image_t> generate(const std::vector<std::string>& full_paths);
+	static image_t generate(const std::string& full_path, pixel_format_t format);
+	static std::vector<image_t> generate(const std::vector<std::string>& full_paths, pixel_format_t format);
+public:
+	static constexpr uint32_t Magic = 0x5854564C;
+	static constexpr uint32_t Version = 1;
+	static constexpr arch_t MaximumLevels = 4;
+private:
+	static image_t cooked(const std::string& full_path, pixel_format_t format);
 private:
 	glm::ivec2 dimensions;
-	std::vector<byte_t> pixels;
+	arch_t levels, offset;
+	archive_blob_t pixels;
 };
 
 #endif // LEVIATHAN_INCLUDED_VIDEO_IMAGE_HPP
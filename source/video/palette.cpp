@@ -1,12 +1,21 @@
 #include "./palette.hpp"
 #include "./glcheck.hpp"
+#include "./upload_queue.hpp"
 
+#include "../utility/frame_stats.hpp"
 #include "../utility/logger.hpp"
-#include "../utility/thread_pool.hpp"
+
+#include <thread>
+#include <cstring>
 
 palette_t::palette_t() :
 	ready(false),
-	future(),
+	resolved(false),
+	resolving(false),
+	counter(),
+	path(),
+	image(),
+	queued(false),
 	handle(0),
 	dimensions(0),
 	format(pixel_format_t::Invalid)
@@ -20,7 +29,21 @@ palette_t::palette_t(palette_t&& that) noexcept : palette_t() {
 		ready.store(that.ready.load());
 		that.ready.store(temp.load());
 
-		std::swap(future, that.future);
+		temp.store(resolved.load());
+		resolved.store(that.resolved.load());
+		that.resolved.store(temp.load());
+
+		temp.store(resolving.load());
+		resolving.store(that.resolving.load());
+		that.resolving.store(temp.load());
+
+		temp.store(queued.load());
+		queued.store(that.queued.load());
+		that.queued.store(temp.load());
+
+		std::swap(counter, that.counter);
+		std::swap(path, that.path);
+		std::swap(image, that.image);
 		std::swap(handle, that.handle);
 		std::swap(dimensions, that.dimensions);
 		std::swap(format, that.format);
@@ -33,7 +56,21 @@ palette_t& palette_t::operator=(palette_t&& that) noexcept {
 		ready.store(that.ready.load());
 		that.ready.store(temp.load());
 
-		std::swap(future, that.future);
+		temp.store(resolved.load());
+		resolved.store(that.resolved.load());
+		that.resolved.store(temp.load());
+
+		temp.store(resolving.load());
+		resolving.store(that.resolving.load());
+		that.resolving.store(temp.load());
+
+		temp.store(queued.load());
+		queued.store(that.queued.load());
+		that.queued.store(temp.load());
+
+		std::swap(counter, that.counter);
+		std::swap(path, that.path);
+		std::swap(image, that.image);
 		std::swap(handle, that.handle);
 		std::swap(dimensions, that.dimensions);
 		std::swap(format, that.format);
@@ -45,12 +82,17 @@ palette_t::~palette_t() {
 	this->destroy();
 }
 
-void palette_t::load(const std::string& full_path, pixel_format_t format, thread_pool_t& thread_pool) {
+void palette_t::load(const std::string& full_path, pixel_format_t format, job_system_t& job_system) {
 	assert(!ready);
 	this->format = format;
-	this->future = thread_pool.push([](const std::string& full_path) -> image_t {
-		return image_t::generate(full_path);
-	}, full_path);
+	this->path = full_path;
+	job_system.push(job_priority_t::Urgent, &counter, [this] {
+		this->image = image_t::generate(this->path, this->format);
+		this->path.clear();
+		if (sampler_t::has_device() and !this->image.empty()) {
+			this->queued.store(upload_queue_t::submit(this), std::memory_order_release);
+		}
+	});
 }
 
 bool palette_t::create(glm::ivec2 dimensions, pixel_format_t format) {
@@ -80,10 +122,16 @@ bool palette_t::create(glm::ivec2 dimensions, pixel_format_t format) {
 }
 
 void palette_t::destroy() {
-	if (future.valid()) {
-		auto result = future.get();
+	counter.reset();
+	if (queued) {
+		upload_queue_t::cancel(this);
+		queued = false;
 	}
+	path.clear();
+	image = image_t();
 	ready = false;
+	resolved = false;
+	resolving = false;
 	if (handle != 0) {
 		glCheck(glDeleteTextures(1, &handle));
 		handle = 0;
@@ -92,38 +140,84 @@ void palette_t::destroy() {
 	format		= pixel_format_t::Invalid;
 }
 
-void palette_t::assure() {
-	if (!ready and future.valid()) {
-		// Do palette loading now
-		const image_t image = future.get();
-		if (!image.empty()) {
-			if (this->create(image.get_dimensions(), format)) {
-				glCheck(glTexSubImage2D(
-					GL_TEXTURE_2D, 0, 0, 0,
-					dimensions.x, dimensions.y,
-					GL_RGBA, GL_UNSIGNED_BYTE, &image[0]
-				));
-				glCheck(glGenerateMipmap(GL_TEXTURE_2D));
-			}
-			glCheck(glBindTexture(GL_TEXTURE_2D, 0));
+bool palette_t::assure() {
+	if (!ready) {
+		if (counter.valid() and !counter.finished()) {
+			return false;
+		}
+		this->resolve();
+		if (!resolved or queued) {
+			return false;
+		}
+		if (!sampler_t::has_device()) {
+			// Headless, so only keep what the simulation can query
+			image = image_t();
+		} else {
+			this->upload(false, 0);
 		}
 		ready = true;
 	}
+	return true;
 }
 
-void palette_t::assure() const {
+bool palette_t::assure() const {
 	if (!ready) {
-		const_cast<palette_t*>(this)->assure();
+		return const_cast<palette_t*>(this)->assure();
+	}
+	return true;
+}
+
+arch_t palette_t::get_staging_size() const {
+	const glm::ivec2 extent = image.get_dimensions();
+	return static_cast<arch_t>(extent.x) * static_cast<arch_t>(extent.y) * 4;
+}
+
+void palette_t::stage(byte_t* destination) const {
+	std::memcpy(destination, &image[0], this->get_staging_size());
+}
+
+void palette_t::upload(bool_t staged, arch_t offset) {
+	this->resolve();
+	if (!image.empty()) {
+		if (this->create(image.get_dimensions(), format)) {
+			const void* pixels = staged ? reinterpret_cast<const void*>(offset) : &image[0];
+			glCheck(glTexSubImage2D(
+				GL_TEXTURE_2D, 0, 0, 0,
+				dimensions.x, dimensions.y,
+				GL_RGBA, GL_UNSIGNED_BYTE, pixels
+			));
+			glCheck(glGenerateMipmap(GL_TEXTURE_2D));
+			frame_stats::add_upload_bytes(image.size());
+		}
+		glCheck(glBindTexture(GL_TEXTURE_2D, 0));
+	}
+	image = image_t();
+}
+
+// Same split as texture_t, so the simulation thread never touches the context.
+void palette_t::resolve() const {
+	if (!ready and !resolved.load(std::memory_order_acquire) and counter.valid()) {
+		counter.wait();
+		palette_t* self = const_cast<palette_t*>(this);
+		if (!self->resolving.exchange(true, std::memory_order_acq_rel)) {
+			self->dimensions = self->image.get_dimensions();
+			self->resolved.store(true, std::memory_order_release);
+			self->counter.reset();
+		} else {
+			while (!resolved.load(std::memory_order_acquire)) {
+				std::this_thread::yield();
+			}
+		}
 	}
 }
 
 glm::vec2 palette_t::get_dimensions() const {
-	this->assure();
+	this->resolve();
 	return glm::vec2(dimensions);
 }
 
 glm::vec2 palette_t::get_inverse_dimensions() const {
-	this->assure();
+	this->resolve();
 	if (dimensions.x != 0.0f and dimensions.y != 0.0f) {
 		return 1.0f / glm::vec2(dimensions);
 	}
@@ -131,14 +225,27 @@ glm::vec2 palette_t::get_inverse_dimensions() const {
 }
 
 glm::ivec2 palette_t::get_integral_dimensions() const {
-	this->assure();
+	this->resolve();
 	return dimensions;
 }
 
 real_t palette_t::convert(real_t index) const {
-	this->assure();
+	this->resolve();
 	if (dimensions.y > 0) {
 		return index / static_cast<real_t>(dimensions.y);
 	}
 	return 0.0f;
 }
+
+arch_t palette_t::get_footprint() const {
+	if (ready.load(std::memory_order_acquire) or handle != 0) {
+		if (handle == 0) {
+			return 0;
+		}
+		return static_cast<arch_t>(dimensions.x) * static_cast<arch_t>(dimensions.y) * 4;
+	}
+	if (resolved.load(std::memory_order_acquire) or (counter.valid() and counter.finished())) {
+		return image.size();
+	}
+	return 0;
+}
@@ -10,19 +10,29 @@ public:
 	palette_t& operator=(palette_t&& that) noexcept;
 	~palette_t();
 public:
-	void load(const std::string& full_path, pixel_format_t format, thread_pool_t& thread_pool);
+	void load(const std::string& full_path, pixel_format_t format, job_system_t& job_system);
 	bool create(glm::ivec2 dimensions, pixel_format_t format);
 	void destroy();
-	void assure();
-	void assure() const;
+	bool assure();
+	bool assure() const;
 	glm::vec2 get_dimensions() const;
 	glm::vec2 get_inverse_dimensions() const;
 	glm::ivec2 get_integral_dimensions() const;
 	real_t convert(real_t index) const;
+	arch_t get_footprint() const;
+private:
+	void resolve() const;
+	arch_t get_staging_size() const;
+	void stage(byte_t* destination) const;
+	void upload(bool_t staged, arch_t offset);
 private:
 	friend struct gfx_t;
-	std::atomic<bool> ready;
-	std::future<image_t> future;
+	friend struct upload_queue_t;
+	std::atomic<bool> ready, resolved, resolving;
+	job_counter_t counter;
+	std::string path;
+	image_t image;
+	std::atomic<bool> queued;
 	uint_t handle;
 	glm::ivec2 dimensions;
 	pixel_format_t format;
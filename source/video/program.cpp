@@ -1,5 +1,6 @@
 #include "./program.hpp"
 #include "./glcheck.hpp"
+#include "./program_cache.hpp"
 
 #include "../utility/logger.hpp"
 #include "../utility/vfs.hpp"
@@ -11,11 +12,14 @@
 	If separable programs are not available:
 	- shader_t's handle is an OGL shader object.
 	- program_t's handle is an OGL program object.
+	Whichever handle is an OGL program object gets restored
+	from the program cache instead of linked when it can be.
 */
 
 shader_t::shader_t() :
 	handle(0),
-	stage(shader_stage_t::Vertex)
+	stage(shader_stage_t::Vertex),
+	key(0)
 {
 
 }
@@ -24,6 +28,7 @@ shader_t::shader_t(shader_t&& that) noexcept : shader_t() {
 	if (this != &that) {
 		std::swap(handle, that.handle);
 		std::swap(stage, that.stage);
+		std::swap(key, that.key);
 	}
 }
 
@@ -31,6 +36,7 @@ shader_t& shader_t::operator=(shader_t&& that) noexcept {
 	if (this != &that) {
 		std::swap(handle, that.handle);
 		std::swap(stage, that.stage);
+		std::swap(key, that.key);
 	}
 	return *this;
 }
@@ -45,8 +51,43 @@ bool shader_t::from(const std::string& source, shader_stage_t stage) {
 		const byte_t* source_pointer = source.c_str();
 
 		uint_t gl_enum = gfx_t::get_shader_stage_gl_enum(stage);
+		this->key = program_cache_t::hash(source, gl_enum);
 
-		if (program_t::has_separable()) {
+		if (program_t::has_separable() and program_cache_t::enabled()) {
+			// Same as glCreateShaderProgramv, except the binary is retrievable afterwards.
+			glCheck(handle = glCreateProgram());
+			glCheck(glProgramParameteri(handle, GL_PROGRAM_SEPARABLE, GL_TRUE));
+			if (!program_cache_t::restore(key, handle)) {
+				uint_t object = 0;
+				sint_t success = 0;
+				glCheck(object = glCreateShader(gl_enum));
+				glCheck(glShaderSource(object, 1, &source_pointer, NULL));
+				glCheck(glCompileShader(object));
+				glCheck(glGetShaderiv(object, GL_COMPILE_STATUS, &success));
+				if (!success) {
+					byte_t log[1024];
+					glCheck(glGetShaderInfoLog(object, sizeof(log), 0, log));
+					synao_log("Failed to compile separable shader: %s\n", log);
+					glCheck(glDeleteShader(object));
+					this->destroy();
+					return false;
+				}
+				glCheck(glProgramParameteri(handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+				glCheck(glAttachShader(handle, object));
+				glCheck(glLinkProgram(handle));
+				glCheck(glDetachShader(handle, object));
+				glCheck(glDeleteShader(object));
+				glCheck(glGetProgramiv(handle, GL_LINK_STATUS, &success));
+				if (!success) {
+					byte_t log[1024];
+					glCheck(glGetProgramInfoLog(handle, sizeof(log), 0, log));
+					synao_log("Failed to create separable program! Error: %s", log);
+					this->destroy();
+					return false;
+				}
+				program_cache_t::store(key, handle);
+			}
+		} else if (program_t::has_separable()) {
 			glCheck(handle = glCreateShaderProgramv(gl_enum, 1, &source_pointer));
 			glCheck(glValidateProgram(handle));
 			sint_t length = 0;
@@ -95,6 +136,7 @@ void shader_t::destroy() {
 		}
 		handle = 0;
 		stage = shader_stage_t::Vertex;
+		key = 0;
 	}
 }
 
@@ -191,6 +233,20 @@ bool program_t::create(const shader_t* vert, const shader_t* frag, const shader_
 			sint_t success = 0;
 			glCheck(handle = glCreateProgram());
 
+			const uint64_t keys[] = {
+				vert != nullptr ? vert->key : 0,
+				frag != nullptr ? frag->key : 0,
+				geom != nullptr ? geom->key : 0
+			};
+			const uint64_t key = program_cache_t::hash(
+				std::string_view(reinterpret_cast<const byte_t*>(keys), sizeof(keys)),
+				GL_PROGRAM
+			);
+			if (program_cache_t::restore(key, handle)) {
+				specify = shader_t::attributes(handle);
+				return specify.length != 0;
+			}
+
 			if (vert != nullptr and vert->stage == shader_stage_t::Vertex) {
 				glCheck(glAttachShader(handle, vert->handle));
 			}
@@ -203,6 +259,9 @@ bool program_t::create(const shader_t* vert, const shader_t* frag, const shader_
 				glCheck(glAttachShader(handle, geom->handle));
 			}
 
+			if (program_cache_t::enabled()) {
+				glCheck(glProgramParameteri(handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+			}
 			glCheck(glLinkProgram(handle));
 			glCheck(glGetProgramiv(handle, GL_LINK_STATUS, &success));
 
@@ -213,6 +272,7 @@ bool program_t::create(const shader_t* vert, const shader_t* frag, const shader_
 				this->destroy();
 				return false;
 			}
+			program_cache_t::store(key, handle);
 			specify = shader_t::attributes(handle);
 		}
 	}
@@ -23,6 +23,7 @@ private:
 	friend struct program_t;
 	uint_t handle;
 	shader_stage_t stage;
+	uint64_t key;
 };
 
 struct program_t : public not_copyable_t {
@@ -0,0 +1,237 @@
+#include "./program_cache.hpp"
+#include "./glcheck.hpp"
+
+#include "../utility/logger.hpp"
+#include "../utility/setup_file.hpp"
+
+#include <fstream>
+
+static constexpr uint64_t kHashBasis = 0xCBF29CE484222325ULL;
+static constexpr uint64_t kHashPrime = 0x00000100000001B3ULL;
+
+// Programs are only built on the context thread, so this needs no lock.
+static program_cache_t* device = nullptr;
+
+struct program_cache_header_t {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t driver;
+	uint32_t count;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(program_cache_header_t) == 24, "Program cache header must stay 24 bytes!");
+
+struct program_cache_record_t {
+	uint64_t key;
+	uint32_t format;
+	uint32_t length;
+};
+
+static_assert(sizeof(program_cache_record_t) == 16, "Program cache records must stay 16 bytes!");
+
+program_cache_t::program_cache_t() :
+	path(),
+	driver(0),
+	entries(),
+	restored(0),
+	dirty(false)
+{
+
+}
+
+program_cache_t::~program_cache_t() {
+	this->destroy();
+}
+
+bool program_cache_t::init(const setup_file_t& config, const std::string& full_path) {
+	if (device != nullptr) {
+		synao_log("Error! Another program cache already exists!\n");
+		return false;
+	}
+	bool_t use = true;
+	config.get("Video", "ProgramCache", use);
+	if (!use or !program_cache_t::has_binary_option()) {
+		return true;
+	}
+	const GLubyte* strings[3] = { nullptr, nullptr, nullptr };
+	glCheck(strings[0] = glGetString(GL_VENDOR));
+	glCheck(strings[1] = glGetString(GL_RENDERER));
+	glCheck(strings[2] = glGetString(GL_VERSION));
+	driver = kHashBasis;
+	for (auto&& string : strings) {
+		if (string == nullptr) {
+			synao_warn(Video, "Couldn't query driver strings! Program cache is disabled.\n");
+			return true;
+		}
+		driver = program_cache_t::hash(reinterpret_cast<const byte_t*>(string), driver);
+		driver = program_cache_t::hash("\n", driver);
+	}
+	path = full_path;
+	if (!this->read()) {
+		entries.clear();
+		dirty = true;
+	}
+	device = this;
+	return true;
+}
+
+bool program_cache_t::save() {
+	if (!dirty or path.empty()) {
+		return true;
+	}
+	std::ofstream ofs(path, std::ofstream::binary);
+	if (!ofs.is_open()) {
+		synao_warn(Video, "Couldn't save program cache to \"%s\"!\n", path.c_str());
+		return false;
+	}
+	const program_cache_header_t header = {
+		Magic, Version, driver,
+		static_cast<uint32_t>(entries.size()), 0
+	};
+	ofs.write(reinterpret_cast<const byte_t*>(&header), sizeof(header));
+	for (auto&& [key, entry] : entries) {
+		const program_cache_record_t record = {
+			key, entry.format,
+			static_cast<uint32_t>(entry.payload.size())
+		};
+		ofs.write(reinterpret_cast<const byte_t*>(&record), sizeof(record));
+		ofs.write(entry.payload.data(), entry.payload.size());
+	}
+	dirty = false;
+	synao_log("Saved %zu program binaries.\n", entries.size());
+	return ofs.good();
+}
+
+void program_cache_t::destroy() {
+	if (device == this) {
+		device = nullptr;
+	}
+	path.clear();
+	driver = 0;
+	entries.clear();
+	restored = 0;
+	dirty = false;
+}
+
+arch_t program_cache_t::get_restored() const {
+	return restored;
+}
+
+// A rejected binary is dropped, so the caller's fresh link replaces it on the next save.
+bool program_cache_t::restore(uint64_t key, uint_t program) {
+	if (device == nullptr or program == 0) {
+		return false;
+	}
+	auto iter = device->entries.find(key);
+	if (iter == device->entries.end()) {
+		return false;
+	}
+	const program_binary_t& entry = iter->second;
+	sint_t success = 0;
+	glCheck(glProgramBinary(
+		program, entry.format,
+		entry.payload.data(),
+		static_cast<sint_t>(entry.payload.size())
+	));
+	glCheck(glGetProgramiv(program, GL_LINK_STATUS, &success));
+	if (!success) {
+		synao_warn(Video, "Driver rejected cached program binary! Compiling it again.\n");
+		device->entries.erase(iter);
+		device->dirty = true;
+		return false;
+	}
+	device->restored++;
+	return true;
+}
+
+void program_cache_t::store(uint64_t key, uint_t program) {
+	if (device == nullptr or program == 0) {
+		return;
+	}
+	sint_t length = 0;
+	glCheck(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+	if (length <= 0) {
+		return;
+	}
+	program_binary_t entry = { 0, std::vector<byte_t>(static_cast<arch_t>(length)) };
+	sint_t written = 0;
+	glCheck(glGetProgramBinary(program, length, &written, &entry.format, entry.payload.data()));
+	if (written <= 0) {
+		return;
+	}
+	entry.payload.resize(static_cast<arch_t>(written));
+	device->entries[key] = std::move(entry);
+	device->dirty = true;
+}
+
+bool program_cache_t::enabled() {
+	return device != nullptr;
+}
+
+uint64_t program_cache_t::hash(std::string_view source, uint64_t seed) {
+	uint64_t result = seed;
+	for (auto&& character : source) {
+		result ^= static_cast<uint8_t>(character);
+		result *= kHashPrime;
+	}
+	return result;
+}
+
+bool program_cache_t::has_binary_option() {
+	if (glProgramBinary == nullptr or glGetProgramBinary == nullptr) {
+		return false;
+	}
+	// Drivers may expose the entry points while supporting no formats at all.
+	sint_t formats = 0;
+	glCheck(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+	return formats > 0;
+}
+
+// Lengths are checked against what's left of the file before anything gets allocated,
+// so a corrupt cache is just a miss.
+bool program_cache_t::read() {
+	std::ifstream ifs(path, std::ifstream::binary | std::ifstream::ate);
+	if (!ifs.is_open()) {
+		return false;
+	}
+	const std::streamoff size = ifs.tellg();
+	ifs.seekg(0, std::ifstream::beg);
+	if (size < static_cast<std::streamoff>(sizeof(program_cache_header_t))) {
+		synao_warn(Video, "Program cache at \"%s\" is invalid!\n", path.c_str());
+		return false;
+	}
+	arch_t remaining = static_cast<arch_t>(size) - sizeof(program_cache_header_t);
+	program_cache_header_t header = {};
+	ifs.read(reinterpret_cast<byte_t*>(&header), sizeof(header));
+	if (!ifs.good() or header.magic != Magic or header.version != Version) {
+		synao_warn(Video, "Program cache at \"%s\" is invalid!\n", path.c_str());
+		return false;
+	}
+	if (header.driver != driver) {
+		synao_log("Graphics driver changed since the program cache was saved.\n");
+		return false;
+	}
+	for (uint32_t it = 0; it < header.count; ++it) {
+		program_cache_record_t record = {};
+		if (remaining < sizeof(record)) {
+			synao_warn(Video, "Program cache at \"%s\" is truncated!\n", path.c_str());
+			return false;
+		}
+		ifs.read(reinterpret_cast<byte_t*>(&record), sizeof(record));
+		remaining -= sizeof(record);
+		if (!ifs.good() or record.length == 0 or record.length > remaining) {
+			synao_warn(Video, "Program cache at \"%s\" is truncated!\n", path.c_str());
+			return false;
+		}
+		remaining -= record.length;
+		program_binary_t entry = { record.format, std::vector<byte_t>(record.length) };
+		ifs.read(entry.payload.data(), record.length);
+		if (!ifs.good()) {
+			synao_warn(Video, "Program cache at \"%s\" is truncated!\n", path.c_str());
+			return false;
+		}
+		entries[record.key] = std::move(entry);
+	}
+	return true;
+}
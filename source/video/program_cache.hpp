@@ -0,0 +1,50 @@
+#ifndef LEVIATHAN_INCLUDED_VIDEO_PROGRAM_CACHE_HPP
+#define LEVIATHAN_INCLUDED_VIDEO_PROGRAM_CACHE_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+
+#include "../types.hpp"
+
+struct setup_file_t;
+
+struct program_binary_t {
+	uint_t format;
+	std::vector<byte_t> payload;
+};
+
+// Linked program binaries from the last launch, so shaders don't get compiled again
+// while the driver stays the same. Entries are keyed by a hash of their sources and
+// the whole file is thrown out when the vendor, renderer or version strings change.
+struct program_cache_t : public not_copyable_t {
+public:
+	program_cache_t();
+	program_cache_t(program_cache_t&&) = delete;
+	program_cache_t& operator=(program_cache_t&&) = delete;
+	~program_cache_t();
+public:
+	bool init(const setup_file_t& config, const std::string& full_path);
+	bool save();
+	void destroy();
+	arch_t get_restored() const;
+	static bool restore(uint64_t key, uint_t program);
+	static void store(uint64_t key, uint_t program);
+	static bool enabled();
+	static uint64_t hash(std::string_view source, uint64_t seed);
+	static bool has_binary_option();
+public:
+	static constexpr uint32_t Magic = 0x4D47504C;
+	static constexpr uint32_t Version = 1;
+private:
+	bool read();
+private:
+	std::string path;
+	uint64_t driver;
+	std::unordered_map<uint64_t, program_binary_t> entries;
+	arch_t restored;
+	bool_t dirty;
+};
+
+#endif // LEVIATHAN_INCLUDED_VIDEO_PROGRAM_CACHE_HPP
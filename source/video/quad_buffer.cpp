@@ -1,7 +1,10 @@
 #include "./quad_buffer.hpp"
 #include "./const_buffer.hpp"
+#include "./vertex_stream.hpp"
 #include "./glcheck.hpp"
 
+#include "../utility/frame_stats.hpp"
+
 #include <limits>
 
 quad_buffer_allocator_t::quad_buffer_allocator_t() :
@@ -40,6 +43,8 @@ bool quad_buffer_allocator_t::create(primitive_t primitive, arch_t length) {
 	if (primitive != primitive_t::Triangles and primitive != primitive_t::TriangleStrip) {
 		return false;
 	}
+	// Chunks have to end on a whole quad, so the leftover vertices are dropped.
+	length -= length % 4;
 	if (length == 0 or length > UINT16_MAX) {
 		return false;
 	}
@@ -168,11 +173,15 @@ std::vector<uint16_t> quad_buffer_allocator_t::generate(arch_t length, arch_t of
 
 quad_buffer_t::quad_buffer_t() :
 	allocator(nullptr),
+	ring(nullptr),
 	usage(buffer_usage_t::Static),
 	specify(),
 	arrays(0),
 	buffer(0),
-	length(0)
+	ring_arrays(0),
+	length(0),
+	base(0),
+	streamed(false)
 {
 
 }
@@ -180,22 +189,30 @@ quad_buffer_t::quad_buffer_t() :
 quad_buffer_t::quad_buffer_t(quad_buffer_t&& that) noexcept : quad_buffer_t() {
 	if (this != &that) {
 		std::swap(allocator, that.allocator);
+		std::swap(ring, that.ring);
 		std::swap(usage, that.usage);
 		std::swap(specify, that.specify);
 		std::swap(arrays, that.arrays);
 		std::swap(buffer, that.buffer);
+		std::swap(ring_arrays, that.ring_arrays);
 		std::swap(length, that.length);
+		std::swap(base, that.base);
+		std::swap(streamed, that.streamed);
 	}
 }
 
 quad_buffer_t& quad_buffer_t::operator=(quad_buffer_t&& that) noexcept {
 	if (this != &that) {
 		std::swap(allocator, that.allocator);
+		std::swap(ring, that.ring);
 		std::swap(usage, that.usage);
 		std::swap(specify, that.specify);
 		std::swap(arrays, that.arrays);
 		std::swap(buffer, that.buffer);
+		std::swap(ring_arrays, that.ring_arrays);
 		std::swap(length, that.length);
+		std::swap(base, that.base);
+		std::swap(streamed, that.streamed);
 	}
 	return *this;
 }
@@ -204,12 +221,26 @@ quad_buffer_t::~quad_buffer_t() {
 	this->destroy();
 }
 
-void quad_buffer_t::setup(const quad_buffer_allocator_t* allocator, buffer_usage_t usage, vertex_spec_t specify) {
+void quad_buffer_t::setup(const quad_buffer_allocator_t* allocator, vertex_stream_t* ring, buffer_usage_t usage, vertex_spec_t specify) {
 	if (allocator != nullptr and allocator->valid()) {
 		this->destroy();
 		this->allocator = allocator;
 		this->usage = usage;
 		this->specify = specify;
+		// The second vertex array reads from the ring, so lists can switch between the two every frame.
+		if (ring != nullptr and ring->valid()) {
+			this->ring = ring;
+			glCheck(glGenVertexArrays(1, &ring_arrays));
+			glCheck(glBindVertexArray(ring_arrays));
+			ring->bind(true);
+			allocator->bind(true);
+			if (specify.detail != nullptr) {
+				specify.detail();
+			}
+			glCheck(glBindVertexArray(0));
+			ring->bind(false);
+			allocator->bind(false);
+		}
 		if (!arrays) {
 			glCheck(glGenVertexArrays(1, &arrays));
 		}
@@ -230,6 +261,10 @@ void quad_buffer_t::setup(const quad_buffer_allocator_t* allocator, buffer_usage
 	}
 }
 
+void quad_buffer_t::setup(const quad_buffer_allocator_t* allocator, buffer_usage_t usage, vertex_spec_t specify) {
+	this->setup(allocator, nullptr, usage, specify);
+}
+
 void quad_buffer_t::create(arch_t length) {
 	if (allocator != nullptr and allocator->valid() and arrays != 0) {
 		this->length = length;
@@ -244,17 +279,34 @@ void quad_buffer_t::create(arch_t length) {
 
 void quad_buffer_t::destroy() {
 	allocator = nullptr;
+	ring = nullptr;
 	if (arrays != 0) {
 		glCheck(glBindVertexArray(0));
 		glCheck(glDeleteVertexArrays(1, &arrays));
 		arrays = 0;
 	}
+	if (ring_arrays != 0) {
+		glCheck(glBindVertexArray(0));
+		glCheck(glDeleteVertexArrays(1, &ring_arrays));
+		ring_arrays = 0;
+	}
 	if (buffer != 0) {
 		glCheck(glBindBuffer(GL_ARRAY_BUFFER, 0));
 		glCheck(glDeleteBuffers(1, &buffer));
 		buffer = 0;
 	}
 	length = 0;
+	base = 0;
+	streamed = false;
+}
+
+// Holds for the current frame only, since the ring reuses the region afterwards.
+bool quad_buffer_t::stream(const vertex_t* vertices, arch_t count) {
+	streamed = false;
+	if (ring != nullptr and ring_arrays != 0) {
+		streamed = ring->write(vertices, count, specify.length, base);
+	}
+	return streamed;
 }
 
 bool quad_buffer_t::update(const vertex_t* vertices, arch_t count, arch_t offset) {
@@ -270,8 +322,14 @@ bool quad_buffer_t::update(const vertex_t* vertices, arch_t count, arch_t offset
 		return false;
 	}
 	glCheck(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+	// Orphaning the old storage keeps the driver from waiting on draws that still read it.
+	if (offset == 0 and usage != buffer_usage_t::Static) {
+		uint_t gl_enum = gfx_t::get_buffer_usage_gl_enum(usage);
+		glCheck(glBufferData(GL_ARRAY_BUFFER, specify.length * length, nullptr, gl_enum));
+	}
 	glCheck(glBufferSubData(GL_ARRAY_BUFFER, specify.length * offset, specify.length * count, vertices));
 	glCheck(glBindBuffer(GL_ARRAY_BUFFER, 0));
+	frame_stats::add_upload_bytes(specify.length * count);
 	return true;
 }
 
@@ -283,16 +341,37 @@ bool quad_buffer_t::update(const vertex_t* vertices) {
 	return this->update(vertices, length, 0);
 }
 
+// Lists longer than the shared index buffer are drawn in chunks of it, each one
+// starting at its own base vertex, so indices never need more than 16 bits.
+// Instanced lists only ever index one quad, and start at a base instance instead.
 void quad_buffer_t::draw(arch_t count) const {
-	if (allocator != nullptr and allocator->valid() and arrays != 0) {
-		count = quad_buffer_allocator_t::convert(count);
-		glCheck(glBindVertexArray(arrays));
-		glCheck(glDrawElements(
-			gfx_t::get_primitive_gl_enum(allocator->get_primitive()),
-			static_cast<uint_t>(count),
-			GL_UNSIGNED_SHORT,
-			nullptr
-		));
+	const uint_t handle = streamed ? ring_arrays : arrays;
+	if (allocator != nullptr and allocator->valid() and handle != 0) {
+		const uint_t primitive = gfx_t::get_primitive_gl_enum(allocator->get_primitive());
+		const arch_t chunk = allocator->get_length();
+		const arch_t first = streamed ? static_cast<arch_t>(base) : 0;
+		glCheck(glBindVertexArray(handle));
+		if (specify.instanced) {
+			glCheck(glDrawElementsInstancedBaseInstance(
+				primitive,
+				static_cast<uint_t>(quad_buffer_allocator_t::convert(4)),
+				GL_UNSIGNED_SHORT,
+				nullptr,
+				static_cast<uint_t>(count),
+				static_cast<uint_t>(first)
+			));
+		} else {
+			for (arch_t offset = 0; offset < count; offset += chunk) {
+				const arch_t amount = quad_buffer_allocator_t::convert(glm::min(count - offset, chunk));
+				glCheck(glDrawElementsBaseVertex(
+					primitive,
+					static_cast<uint_t>(amount),
+					GL_UNSIGNED_SHORT,
+					nullptr,
+					static_cast<sint_t>(first + offset)
+				));
+			}
+		}
 		glCheck(glBindVertexArray(0));
 	}
 }
@@ -308,3 +387,9 @@ buffer_usage_t quad_buffer_t::get_usage() const {
 arch_t quad_buffer_t::get_length() const {
 	return length;
 }
+
+bool quad_buffer_t::has_instanced_option() {
+	return
+		glDrawElementsInstancedBaseInstance != nullptr and
+		glVertexAttribDivisor != nullptr;
+}
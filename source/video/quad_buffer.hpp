@@ -7,6 +7,7 @@
 #include "./vertex.hpp"
 
 struct quad_buffer_t;
+struct vertex_stream_t;
 
 struct quad_buffer_allocator_t : public not_copyable_t {
 public:
@@ -43,9 +44,11 @@ public:
 		vertex_spec_t specify = vertex_spec_t::from(typeid(V));
 		this->setup(allocator, usage, specify);
 	}
+	void setup(const quad_buffer_allocator_t* allocator, vertex_stream_t* ring, buffer_usage_t usage, vertex_spec_t specify);
 	void setup(const quad_buffer_allocator_t* allocator, buffer_usage_t usage, vertex_spec_t specify);
 	void create(arch_t length);
 	void destroy();
+	bool stream(const vertex_t* vertices, arch_t count);
 	bool update(const vertex_t* vertices, arch_t count, arch_t offset);
 	bool update(const vertex_t* vertices, arch_t count);
 	bool update(const vertex_t* vertices);
@@ -53,13 +56,17 @@ public:
 	void draw() const;
 	buffer_usage_t get_usage() const;
 	arch_t get_length() const;
+	static bool has_instanced_option();
 private:
 	friend struct gfx_t;
 	const quad_buffer_allocator_t* allocator;
+	vertex_stream_t* ring;
 	buffer_usage_t usage;
 	vertex_spec_t specify;
-	uint_t arrays, buffer;
+	uint_t arrays, buffer, ring_arrays;
 	arch_t length;
+	sint_t base;
+	bool_t streamed;
 };
 
 #endif // LEVIATHAN_INCLUDED_VIDEO_QUAD_BUFFER_HPP
@@ -1,8 +1,17 @@
 #include "./texture.hpp"
 #include "./glcheck.hpp"
+#include "./upload_queue.hpp"
 
+#include "../utility/frame_stats.hpp"
 #include "../utility/logger.hpp"
-#include "../utility/thread_pool.hpp"
+#include "../utility/profiler.hpp"
+
+#include <thread>
+#include <cstring>
+
+bool sampler_t::has_device() {
+	return glGenTextures != nullptr;
+}
 
 bool sampler_t::has_immutable_option() {
 	return glTexStorage2D != nullptr;
@@ -14,7 +23,12 @@ bool sampler_t::has_azdo() {
 
 texture_t::texture_t() :
 	ready(false),
-	future(),
+	resolved(false),
+	resolving(false),
+	counter(),
+	paths(),
+	images(),
+	queued(false),
 	handle(0),
 	dimensions(0),
 	layers(0),
@@ -29,7 +43,21 @@ texture_t::texture_t(texture_t&& that) noexcept : texture_t() {
 		ready.store(that.ready.load());
 		that.ready.store(temp.load());
 
-		std::swap(future, that.future);
+		temp.store(resolved.load());
+		resolved.store(that.resolved.load());
+		that.resolved.store(temp.load());
+
+		temp.store(resolving.load());
+		resolving.store(that.resolving.load());
+		that.resolving.store(temp.load());
+
+		temp.store(queued.load());
+		queued.store(that.queued.load());
+		that.queued.store(temp.load());
+
+		std::swap(counter, that.counter);
+		std::swap(paths, that.paths);
+		std::swap(images, that.images);
 		std::swap(handle, that.handle);
 		std::swap(dimensions, that.dimensions);
 		std::swap(layers, that.layers);
@@ -43,7 +71,21 @@ texture_t& texture_t::operator=(texture_t&& that) noexcept {
 		ready.store(that.ready.load());
 		that.ready.store(temp.load());
 
-		std::swap(future, that.future);
+		temp.store(resolved.load());
+		resolved.store(that.resolved.load());
+		that.resolved.store(temp.load());
+
+		temp.store(resolving.load());
+		resolving.store(that.resolving.load());
+		that.resolving.store(temp.load());
+
+		temp.store(queued.load());
+		queued.store(that.queued.load());
+		that.queued.store(temp.load());
+
+		std::swap(counter, that.counter);
+		std::swap(paths, that.paths);
+		std::swap(images, that.images);
 		std::swap(handle, that.handle);
 		std::swap(dimensions, that.dimensions);
 		std::swap(layers, that.layers);
@@ -56,12 +98,17 @@ texture_t::~texture_t() {
 	this->destroy();
 }
 
-void texture_t::load(const std::vector<std::string>& full_paths, pixel_format_t format, thread_pool_t& thread_pool) {
+void texture_t::load(const std::vector<std::string>& full_paths, pixel_format_t format, job_system_t& job_system) {
 	assert(!ready);
 	this->format = format;
-	this->future = thread_pool.push([](const std::vector<std::string>& full_paths) -> std::vector<image_t> {
-		return image_t::generate(full_paths);
-	}, full_paths);
+	this->paths = full_paths;
+	job_system.push(job_priority_t::Urgent, &counter, [this] {
+		this->images = image_t::generate(this->paths, this->format);
+		this->paths.clear();
+		if (sampler_t::has_device() and !this->images.empty()) {
+			this->queued.store(upload_queue_t::submit(this), std::memory_order_release);
+		}
+	});
 }
 
 bool texture_t::create(glm::ivec2 dimensions, arch_t layers, pixel_format_t format) {
@@ -76,7 +123,7 @@ bool texture_t::create(glm::ivec2 dimensions, arch_t layers, pixel_format_t form
 		if (layers > 1) {
 			glCheck(glBindTexture(GL_TEXTURE_2D_ARRAY, handle));
 			if (sampler_t::has_immutable_option()) {
-				glCheck(glTexStorage3D(GL_TEXTURE_2D_ARRAY, 4, gl_enum, dimensions.x, dimensions.y, static_cast<uint_t>(layers)));
+				glCheck(glTexStorage3D(GL_TEXTURE_2D_ARRAY, static_cast<uint_t>(image_t::MaximumLevels), gl_enum, dimensions.x, dimensions.y, static_cast<uint_t>(layers)));
 			} else {
 				glCheck(glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, gl_enum, dimensions.x, dimensions.y, static_cast<uint_t>(layers), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
 			}
@@ -88,7 +135,7 @@ bool texture_t::create(glm::ivec2 dimensions, arch_t layers, pixel_format_t form
 		} else {
 			glCheck(glBindTexture(GL_TEXTURE_2D, handle));
 			if (sampler_t::has_immutable_option()) {
-				glCheck(glTexStorage2D(GL_TEXTURE_2D, 4, gl_enum, dimensions.x, dimensions.y));
+				glCheck(glTexStorage2D(GL_TEXTURE_2D, static_cast<uint_t>(image_t::MaximumLevels), gl_enum, dimensions.x, dimensions.y));
 			} else {
 				glCheck(glTexImage2D(GL_TEXTURE_2D, 0, gl_enum, dimensions.x, dimensions.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
 			}
@@ -136,10 +183,16 @@ bool texture_t::color_buffer_at(glm::ivec2 dimensions, pixel_format_t format, ar
 }
 
 void texture_t::destroy() {
-	if (future.valid()) {
-		auto result = future.get();
+	counter.reset();
+	if (queued) {
+		upload_queue_t::cancel(this);
+		queued = false;
 	}
+	paths.clear();
+	images.clear();
 	ready = false;
+	resolved = false;
+	resolving = false;
 	if (handle != 0) {
 		glCheck(glDeleteTextures(1, &handle));
 		handle = 0;
@@ -149,44 +202,153 @@ void texture_t::destroy() {
 	format		= pixel_format_t::Invalid;
 }
 
-void texture_t::assure() {
-	if (!ready and future.valid()) {
-		// Do texture loading now
-		const std::vector<image_t> images = future.get();
+// Queued textures are left to the upload queue, so this only uploads synchronously
+// for ones loaded while no queue existed. It never waits on the decode or a fence,
+// so callers just skip the texture until it's ready.
+bool texture_t::assure() {
+	if (!ready) {
+		if (counter.valid() and !counter.finished()) {
+			return false;
+		}
+		this->resolve();
+		if (!resolved or queued) {
+			return false;
+		}
+		if (!sampler_t::has_device() or images.empty()) {
+			// Headless, so only keep what the simulation can query
+			images.clear();
+			images.shrink_to_fit();
+		} else {
+			synao_zone("texture_t::assure");
+			this->upload(false, 0);
+		}
+		ready = true;
+	}
+	return true;
+}
+
+bool texture_t::assure() const {
+	if (!ready) {
+		return const_cast<texture_t*>(this)->assure();
+	}
+	return true;
+}
+
+arch_t texture_t::get_staging_size() const {
+	const arch_t levels = texture_t::get_cooked_levels(images);
+	arch_t result = 0;
+	for (auto&& image : images) {
+		for (arch_t level = 0; level < levels; ++level) {
+			const glm::ivec2 extent = image.get_level_dimensions(level);
+			result += static_cast<arch_t>(extent.x) * static_cast<arch_t>(extent.y) * 4;
+		}
+	}
+	return result;
+}
+
+// Levels are packed back to back in the order upload() reads them.
+void texture_t::stage(byte_t* destination) const {
+	const arch_t levels = texture_t::get_cooked_levels(images);
+	for (auto&& image : images) {
+		for (arch_t level = 0; level < levels; ++level) {
+			const glm::ivec2 extent = image.get_level_dimensions(level);
+			const arch_t length = static_cast<arch_t>(extent.x) * static_cast<arch_t>(extent.y) * 4;
+			std::memcpy(destination, image.get_level(level), length);
+			destination += length;
+		}
+	}
+}
+
+// Staged pixels are read from the bound unpack buffer starting at offset,
+// otherwise they come straight out of the images.
+void texture_t::upload(bool_t staged, arch_t offset) {
+	this->resolve();
+	if (!images.empty()) {
+		const arch_t levels = texture_t::get_cooked_levels(images);
 		if (images.size() > 1) {
 			if (this->create(images[0].get_dimensions(), images.size(), format)) {
 				arch_t index = 0;
 				for (auto&& image : images) {
-					glCheck(glTexSubImage3D(
-						GL_TEXTURE_2D_ARRAY, 0, 0, 0,
-						static_cast<uint_t>(index),
-						dimensions.x, dimensions.y, 1,
-						GL_RGBA, GL_UNSIGNED_BYTE, &image[0]
-					));
-					glCheck(glGenerateMipmap(GL_TEXTURE_2D_ARRAY));
+					for (arch_t level = 0; level < levels; ++level) {
+						const glm::ivec2 extent = image.get_level_dimensions(level);
+						const void* pixels = staged ? reinterpret_cast<const void*>(offset) : image.get_level(level);
+						glCheck(glTexSubImage3D(
+							GL_TEXTURE_2D_ARRAY,
+							static_cast<sint_t>(level), 0, 0,
+							static_cast<uint_t>(index),
+							extent.x, extent.y, 1,
+							GL_RGBA, GL_UNSIGNED_BYTE, pixels
+						));
+						offset += static_cast<arch_t>(extent.x) * static_cast<arch_t>(extent.y) * 4;
+					}
+					frame_stats::add_upload_bytes(image.size());
 					++index;
 				}
+				if (levels == 1) {
+					glCheck(glGenerateMipmap(GL_TEXTURE_2D_ARRAY));
+				}
 			}
 			glCheck(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
-		} else if (!images.empty()) {
+		} else {
 			auto& image = images[0];
 			if (this->create(image.get_dimensions(), 1, format)) {
-				glCheck(glTexSubImage2D(
-					GL_TEXTURE_2D, 0, 0, 0,
-					dimensions.x, dimensions.y,
-					GL_RGBA, GL_UNSIGNED_BYTE, &image[0]
-				));
-				glCheck(glGenerateMipmap(GL_TEXTURE_2D));
+				for (arch_t level = 0; level < levels; ++level) {
+					const glm::ivec2 extent = image.get_level_dimensions(level);
+					const void* pixels = staged ? reinterpret_cast<const void*>(offset) : image.get_level(level);
+					glCheck(glTexSubImage2D(
+						GL_TEXTURE_2D,
+						static_cast<sint_t>(level), 0, 0,
+						extent.x, extent.y,
+						GL_RGBA, GL_UNSIGNED_BYTE, pixels
+					));
+					offset += static_cast<arch_t>(extent.x) * static_cast<arch_t>(extent.y) * 4;
+				}
+				if (levels == 1) {
+					glCheck(glGenerateMipmap(GL_TEXTURE_2D));
+				}
+				frame_stats::add_upload_bytes(image.size());
 			}
 			glCheck(glBindTexture(GL_TEXTURE_2D, 0));
 		}
-		ready = true;
 	}
+	images.clear();
+	images.shrink_to_fit();
 }
 
-void texture_t::assure() const {
-	if (!ready) {
-		const_cast<texture_t*>(this)->assure();
+// Cooked mips can only go into immutable storage, which already has room for all of them.
+// Anything short of the full chain gets the driver to generate it instead.
+arch_t texture_t::get_cooked_levels(const std::vector<image_t>& images) {
+	if (!sampler_t::has_immutable_option()) {
+		return 1;
+	}
+	for (auto&& image : images) {
+		if (image.get_levels() != image_t::MaximumLevels) {
+			return 1;
+		}
+	}
+	return image_t::MaximumLevels;
+}
+
+// Only waits for this texture's pixels and reads their dimensions, so any thread may
+// query them. Whichever thread gets there first publishes them, the rest wait for it.
+// Uploading is left to assure(), which has to run where the context is current.
+void texture_t::resolve() const {
+	if (!ready and !resolved.load(std::memory_order_acquire) and counter.valid()) {
+		counter.wait();
+		texture_t* self = const_cast<texture_t*>(this);
+		if (!self->resolving.exchange(true, std::memory_order_acq_rel)) {
+			if (!self->images.empty()) {
+				self->dimensions = self->images[0].get_dimensions();
+				self->layers = self->images.size();
+			}
+			// Published before the counter detaches, so nobody can slip past both checks.
+			self->resolved.store(true, std::memory_order_release);
+			self->counter.reset();
+		} else {
+			while (!resolved.load(std::memory_order_acquire)) {
+				std::this_thread::yield();
+			}
+		}
 	}
 }
 
@@ -195,17 +357,17 @@ bool texture_t::valid() const {
 }
 
 uint_t texture_t::get_layers() const {
-	this->assure();
+	this->resolve();
 	return static_cast<uint_t>(layers);
 }
 
 glm::vec2 texture_t::get_dimensions() const {
-	this->assure();
+	this->resolve();
 	return glm::vec2(dimensions);
 }
 
 glm::vec2 texture_t::get_inverse_dimensions() const {
-	this->assure();
+	this->resolve();
 	if (dimensions.x != 0.0f and dimensions.y != 0.0f) {
 		return 1.0f / glm::vec2(dimensions);
 	}
@@ -213,6 +375,25 @@ glm::vec2 texture_t::get_inverse_dimensions() const {
 }
 
 glm::ivec2 texture_t::get_integral_dimensions() const {
-	this->assure();
+	this->resolve();
 	return dimensions;
 }
+
+// Storage always has a full mip chain, which adds about a third on top of the base level.
+arch_t texture_t::get_footprint() const {
+	if (ready.load(std::memory_order_acquire) or handle != 0) {
+		if (handle == 0) {
+			return 0;
+		}
+		const arch_t base = static_cast<arch_t>(dimensions.x) * static_cast<arch_t>(dimensions.y) * layers * 4;
+		return base + base / 3;
+	}
+	if (resolved.load(std::memory_order_acquire) or (counter.valid() and counter.finished())) {
+		arch_t result = 0;
+		for (auto&& image : images) {
+			result += image.size();
+		}
+		return result;
+	}
+	return 0;
+}
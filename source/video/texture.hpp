@@ -1,19 +1,18 @@
 #ifndef LEVIATHAN_INCLUDED_VIDEO_TEXTURE_HPP
 #define LEVIATHAN_INCLUDED_VIDEO_TEXTURE_HPP
 
-#include <future>
 #include <atomic>
 
 #include "./image.hpp"
 #include "./gfx.hpp"
-
-struct thread_pool_t;
+#include "../utility/job_system.hpp"
 
 struct sampler_t {
 public:
 	sampler_t() = default;
 	~sampler_t() = default;
 public:
+	static bool has_device();
 	static bool has_immutable_option();
 	static bool has_azdo();
 };
@@ -25,22 +24,34 @@ public:
 	texture_t& operator=(texture_t&& that) noexcept;
 	~texture_t();
 public:
-	void load(const std::vector<std::string>& full_paths, pixel_format_t format, thread_pool_t& thread_pool);
+	void load(const std::vector<std::string>& full_paths, pixel_format_t format, job_system_t& job_system);
 	bool create(glm::ivec2 dimensions, arch_t layers, pixel_format_t format);
 	bool color_buffer(glm::ivec2 dimensions, arch_t layers, pixel_format_t format);
 	bool color_buffer_at(glm::ivec2 dimensions, pixel_format_t format, arch_t offset);
-	void assure();
-	void assure() const;
+	bool assure();
+	bool assure() const;
 	void destroy();
 	bool valid() const;
 	uint_t get_layers() const;
 	glm::vec2 get_dimensions() const;
 	glm::vec2 get_inverse_dimensions() const;
 	glm::ivec2 get_integral_dimensions() const;
+	arch_t get_footprint() const;
+private:
+	void resolve() const;
+	arch_t get_staging_size() const;
+	void stage(byte_t* destination) const;
+	void upload(bool_t staged, arch_t offset);
+	static arch_t get_cooked_levels(const std::vector<image_t>& images);
 private:
 	friend struct gfx_t;
-	std::atomic<bool> ready;
-	std::future<std::vector<image_t> > future;
+	friend struct upload_queue_t;
+	friend struct texture_atlas_t;
+	std::atomic<bool> ready, resolved, resolving;
+	job_counter_t counter;
+	std::vector<std::string> paths;
+	std::vector<image_t> images;
+	std::atomic<bool> queued;
 	uint_t handle;
 	glm::ivec2 dimensions;
 	arch_t layers;
@@ -0,0 +1,178 @@
+#include "./texture_atlas.hpp"
+#include "./glcheck.hpp"
+
+#include "../utility/logger.hpp"
+#include "../utility/rect.hpp"
+#include "../utility/setup_file.hpp"
+
+#include <algorithm>
+
+static constexpr sint_t kDefaultPages 	= 4;
+static constexpr sint_t kDefaultLength 	= 1024;
+static constexpr sint_t kPadding 		= 1;
+
+rect_t atlas_entry_t::convert(const rect_t& quad) const {
+	return rect_t(
+		offset + quad.left_top() * scale,
+		quad.dimensions() * scale
+	);
+}
+
+texture_atlas_t::texture_atlas_t() :
+	pages(),
+	shelves(),
+	tops(),
+	pending(),
+	requested(),
+	entries(),
+	length(0)
+{
+
+}
+
+bool texture_atlas_t::init(const setup_file_t& config) {
+	if (pages.valid()) {
+		synao_log("Error! Texture atlas already exists!\n");
+		return false;
+	}
+	sint_t count = kDefaultPages;
+	sint_t request = kDefaultLength;
+	config.get("Video", "AtlasPages", count);
+	config.get("Video", "AtlasSize", request);
+	// Array textures need at least two layers, so anything less turns the atlas off.
+	if (count < 2 or request <= 0 or !texture_atlas_t::has_copy_option()) {
+		return true;
+	}
+	sint_t maximum_length = 0;
+	sint_t maximum_layers = 0;
+	glCheck(glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maximum_length));
+	glCheck(glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maximum_layers));
+	length = glm::min(request, maximum_length);
+	count = glm::min(count, maximum_layers);
+	if (!pages.create(glm::ivec2(length), static_cast<arch_t>(count), pixel_format_t::R8G8B8A8)) {
+		synao_warn(Video, "Couldn't create texture atlas! Sprite sheets will be drawn separately.\n");
+		length = 0;
+		return true;
+	}
+	// Only the base level ever gets written, so sampling must never reach the others.
+	glCheck(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+	glCheck(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0));
+	glCheck(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+	pages.resolved = true;
+	pages.ready = true;
+	tops.resize(static_cast<arch_t>(count), 0);
+	return true;
+}
+
+void texture_atlas_t::destroy() {
+	this->clear();
+	pages.destroy();
+	tops.clear();
+	length = 0;
+}
+
+// Called when the field changes, before the last field's sheets can get evicted.
+void texture_atlas_t::clear() {
+	shelves.clear();
+	std::fill(tops.begin(), tops.end(), 0);
+	pending.clear();
+	requested.clear();
+	entries.clear();
+}
+
+// Sheets that aren't resident yet stay pending, so they're packed on a later frame.
+bool texture_atlas_t::pack() {
+	bool_t packed = false;
+	auto it = pending.begin();
+	while (it != pending.end()) {
+		if (!(*it)->assure()) {
+			++it;
+		} else {
+			packed = this->accept(*it) or packed;
+			it = pending.erase(it);
+		}
+	}
+	return packed;
+}
+
+const atlas_entry_t* texture_atlas_t::find(const texture_t* texture) {
+	if (!pages.valid() or texture == nullptr) {
+		return nullptr;
+	}
+	auto iter = entries.find(texture);
+	if (iter != entries.end()) {
+		return &iter->second;
+	}
+	if (requested.insert(texture).second) {
+		pending.push_back(texture);
+	}
+	return nullptr;
+}
+
+const texture_t* texture_atlas_t::get_texture() const {
+	return &pages;
+}
+
+arch_t texture_atlas_t::get_packed() const {
+	return entries.size();
+}
+
+bool texture_atlas_t::valid() const {
+	return pages.valid();
+}
+
+bool texture_atlas_t::has_copy_option() {
+	return glCopyImageSubData != nullptr;
+}
+
+// Array textures and other formats would need their own pages, so they're left as they are.
+bool texture_atlas_t::accept(const texture_t* texture) {
+	if (texture->handle == 0 or texture->layers != 1 or texture->format != pages.format) {
+		return false;
+	}
+	const glm::ivec2 dimensions = texture->dimensions;
+	glm::ivec2 position = glm::zero<glm::ivec2>();
+	sint_t page = 0;
+	if (!this->place(dimensions, position, page)) {
+		synao_log("Texture atlas is full! Sprite sheet will be drawn separately.\n");
+		return false;
+	}
+	glCheck(glCopyImageSubData(
+		texture->handle, GL_TEXTURE_2D, 0, 0, 0, 0,
+		pages.handle, GL_TEXTURE_2D_ARRAY, 0, position.x, position.y, page,
+		dimensions.x, dimensions.y, 1
+	));
+	const glm::vec2 inverse = 1.0f / glm::vec2(static_cast<real_t>(length));
+	entries[texture] = {
+		glm::vec2(position) * inverse,
+		glm::vec2(dimensions) * inverse,
+		static_cast<real_t>(page)
+	};
+	return true;
+}
+
+// Shelves are filled left to right, and a new one opens below the last when nothing fits.
+bool texture_atlas_t::place(glm::ivec2 dimensions, glm::ivec2& position, sint_t& page) {
+	const glm::ivec2 padded = dimensions + kPadding;
+	if (padded.x > length or padded.y > length) {
+		return false;
+	}
+	for (auto&& shelf : shelves) {
+		if (padded.y <= shelf.height and shelf.width + padded.x <= length) {
+			position = glm::ivec2(shelf.width, shelf.top);
+			page = shelf.page;
+			shelf.width += padded.x;
+			return true;
+		}
+	}
+	for (arch_t it = 0; it < tops.size(); ++it) {
+		if (tops[it] + padded.y <= length) {
+			page = static_cast<sint_t>(it);
+			position = glm::ivec2(0, tops[it]);
+			shelves.push_back({ page, tops[it], padded.y, padded.x });
+			tops[it] += padded.y;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,57 @@
+#ifndef LEVIATHAN_INCLUDED_VIDEO_TEXTURE_ATLAS_HPP
+#define LEVIATHAN_INCLUDED_VIDEO_TEXTURE_ATLAS_HPP
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "./texture.hpp"
+
+struct setup_file_t;
+struct rect_t;
+
+struct atlas_entry_t {
+public:
+	rect_t convert(const rect_t& quad) const;
+public:
+	glm::vec2 offset, scale;
+	real_t layer;
+};
+
+struct atlas_shelf_t {
+	sint_t page, top, height, width;
+};
+
+// Sprite sheets copied into the pages of one array texture, so sprites sharing a layer
+// and blend mode share a display list too. Sheets get requested while rendering and
+// packed after the frame is flushed, then stay put until the atlas is cleared again.
+struct texture_atlas_t : public not_copyable_t {
+public:
+	texture_atlas_t();
+	texture_atlas_t(texture_atlas_t&&) = delete;
+	texture_atlas_t& operator=(texture_atlas_t&&) = delete;
+	~texture_atlas_t() = default;
+public:
+	bool init(const setup_file_t& config);
+	void destroy();
+	void clear();
+	bool pack();
+	const atlas_entry_t* find(const texture_t* texture);
+	const texture_t* get_texture() const;
+	arch_t get_packed() const;
+	bool valid() const;
+	static bool has_copy_option();
+private:
+	bool accept(const texture_t* texture);
+	bool place(glm::ivec2 dimensions, glm::ivec2& position, sint_t& page);
+private:
+	texture_t pages;
+	std::vector<atlas_shelf_t> shelves;
+	std::vector<sint_t> tops;
+	std::vector<const texture_t*> pending;
+	std::unordered_set<const texture_t*> requested;
+	std::unordered_map<const texture_t*, atlas_entry_t> entries;
+	sint_t length;
+};
+
+#endif // LEVIATHAN_INCLUDED_VIDEO_TEXTURE_ATLAS_HPP
@@ -0,0 +1,360 @@
+#include "./upload_queue.hpp"
+#include "./glcheck.hpp"
+#include "./texture.hpp"
+#include "./palette.hpp"
+
+#include "../utility/logger.hpp"
+#include "../utility/profiler.hpp"
+#include "../utility/setup_file.hpp"
+
+#include <mutex>
+#include <algorithm>
+
+static constexpr arch_t kMegabyte 		= 1 << 20;
+static constexpr arch_t kKilobyte 		= 1 << 10;
+static constexpr arch_t kDefaultStaging = 16;
+static constexpr arch_t kDefaultBudget 	= 2048;
+static constexpr arch_t kSpanAlignment 	= 256;
+
+// Loader threads stage into the queue while the context thread drains it,
+// so the device pointer and everything it owns share one lock.
+static std::mutex upload_mutex;
+static upload_queue_t* device = nullptr;
+
+upload_queue_t::upload_queue_t() :
+	pending(),
+	fences(),
+	spans(),
+	handle(0),
+	mapping(nullptr),
+	capacity(0),
+	budget(0)
+{
+
+}
+
+upload_queue_t::~upload_queue_t() {
+	this->destroy();
+}
+
+bool upload_queue_t::init(const setup_file_t& config) {
+	std::lock_guard<std::mutex> lock{ upload_mutex };
+	if (device != nullptr) {
+		synao_log("Error! Another upload queue already exists!\n");
+		return false;
+	}
+	arch_t staging = kDefaultStaging;
+	arch_t kilobytes = kDefaultBudget;
+	config.get("Memory", "Staging", staging);
+	config.get("Video", "UploadBudget", kilobytes);
+	budget = kilobytes * kKilobyte;
+	if (upload_queue_t::has_persistent_option() and staging > 0) {
+		capacity = staging * kMegabyte;
+		const uint_t flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glCheck(glGenBuffers(1, &handle));
+		glCheck(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, handle));
+		glCheck(glBufferStorage(GL_PIXEL_UNPACK_BUFFER, capacity, nullptr, flags));
+		optr_t pointer = nullptr;
+		glCheck(pointer = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, capacity, flags));
+		glCheck(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+		mapping = static_cast<byte_t*>(pointer);
+		if (mapping == nullptr) {
+			synao_warn(Video, "Couldn't map staging buffer! Uploading from client memory instead.\n");
+			glCheck(glDeleteBuffers(1, &handle));
+			handle = 0;
+			capacity = 0;
+		}
+	}
+	device = this;
+	return true;
+}
+
+void upload_queue_t::destroy() {
+	std::lock_guard<std::mutex> lock{ upload_mutex };
+	if (device == this) {
+		device = nullptr;
+	}
+	for (auto&& fence : fences) {
+		glCheck(glDeleteSync(static_cast<GLsync>(fence.sync)));
+	}
+	fences.clear();
+	pending.clear();
+	spans.clear();
+	if (handle != 0) {
+		glCheck(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, handle));
+		glCheck(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+		glCheck(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+		glCheck(glDeleteBuffers(1, &handle));
+		handle = 0;
+	}
+	mapping = nullptr;
+	capacity = 0;
+	budget = 0;
+}
+
+// Always lets one request through, so nothing bigger than the budget waits forever.
+// Requests the staging buffer had no room for when submitted are claimed here,
+// and copied outside the lock like a loader would.
+void upload_queue_t::process() {
+	synao_zone("upload_queue_t::process");
+	std::vector<upload_request_t> claimed;
+	{
+		std::lock_guard<std::mutex> lock{ upload_mutex };
+		this->retire();
+		if (mapping != nullptr) {
+			for (auto&& request : pending) {
+				if (!request.staged and !request.copying) {
+					if (!this->claim(request)) {
+						break;
+					}
+					claimed.push_back(request);
+				}
+			}
+		}
+	}
+	for (auto&& request : claimed) {
+		upload_queue_t::stage(mapping, request);
+	}
+	std::vector<upload_request_t> batch;
+	{
+		std::lock_guard<std::mutex> lock{ upload_mutex };
+		for (auto&& request : claimed) {
+			this->publish(request);
+		}
+		arch_t spent = 0;
+		while (!pending.empty()) {
+			upload_request_t& request = pending.front();
+			// Still being copied by its loader, or waiting on a fence for room.
+			if (request.copying or (!request.staged and mapping != nullptr and !fences.empty())) {
+				break;
+			}
+			if (!batch.empty() and spent + request.length > budget) {
+				break;
+			}
+			spent += request.length;
+			batch.push_back(request);
+			pending.pop_front();
+		}
+	}
+	if (batch.empty()) {
+		return;
+	}
+	bool_t bound = false;
+	for (auto&& request : batch) {
+		if (bound != request.staged) {
+			bound = request.staged;
+			glCheck(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, bound ? handle : 0));
+		}
+		if (request.texture != nullptr) {
+			request.texture->upload(request.staged, request.offset);
+		} else if (request.palette != nullptr) {
+			request.palette->upload(request.staged, request.offset);
+		}
+	}
+	if (bound) {
+		glCheck(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+	}
+	if (mapping != nullptr) {
+		GLsync sync = nullptr;
+		glCheck(sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+		std::lock_guard<std::mutex> lock{ upload_mutex };
+		fences.push_back({ sync, std::move(batch) });
+	} else {
+		for (auto&& request : batch) {
+			if (request.texture != nullptr) {
+				request.texture->ready = true;
+			} else if (request.palette != nullptr) {
+				request.palette->ready = true;
+			}
+		}
+	}
+}
+
+bool upload_queue_t::submit(texture_t* texture) {
+	return upload_queue_t::submit(upload_request_t(texture, nullptr, texture->get_staging_size()));
+}
+
+bool upload_queue_t::submit(palette_t* palette) {
+	return upload_queue_t::submit(upload_request_t(nullptr, palette, palette->get_staging_size()));
+}
+
+// The span is claimed under the lock, but filled after letting go of it,
+// so the context thread never waits behind a whole texture being copied.
+bool upload_queue_t::submit(upload_request_t request) {
+	byte_t* mapping = nullptr;
+	{
+		std::lock_guard<std::mutex> lock{ upload_mutex };
+		if (device == nullptr or request.length == 0) {
+			return false;
+		}
+		if (device->mapping != nullptr and device->claim(request)) {
+			mapping = device->mapping;
+		}
+		device->push(request);
+	}
+	if (mapping != nullptr) {
+		upload_queue_t::stage(mapping, request);
+		std::lock_guard<std::mutex> lock{ upload_mutex };
+		if (device != nullptr) {
+			device->publish(request);
+		}
+	}
+	return true;
+}
+
+// In-flight requests keep their span until the fence retires, since the driver may still read it.
+void upload_queue_t::cancel(const texture_t* texture) {
+	std::lock_guard<std::mutex> lock{ upload_mutex };
+	if (device == nullptr) {
+		return;
+	}
+	auto it = device->pending.begin();
+	while (it != device->pending.end()) {
+		if (it->texture == texture) {
+			if (it->staged) {
+				device->release(it->offset);
+			}
+			it = device->pending.erase(it);
+		} else {
+			++it;
+		}
+	}
+	for (auto&& fence : device->fences) {
+		for (auto&& request : fence.requests) {
+			if (request.texture == texture) {
+				request.texture = nullptr;
+			}
+		}
+	}
+}
+
+void upload_queue_t::cancel(const palette_t* palette) {
+	std::lock_guard<std::mutex> lock{ upload_mutex };
+	if (device == nullptr) {
+		return;
+	}
+	auto it = device->pending.begin();
+	while (it != device->pending.end()) {
+		if (it->palette == palette) {
+			if (it->staged) {
+				device->release(it->offset);
+			}
+			it = device->pending.erase(it);
+		} else {
+			++it;
+		}
+	}
+	for (auto&& fence : device->fences) {
+		for (auto&& request : fence.requests) {
+			if (request.palette == palette) {
+				request.palette = nullptr;
+			}
+		}
+	}
+}
+
+bool upload_queue_t::has_persistent_option() {
+	return glBufferStorage != nullptr and glFenceSync != nullptr;
+}
+
+bool upload_queue_t::push(upload_request_t request) {
+	if (request.length == 0) {
+		return false;
+	}
+	pending.push_back(request);
+	return true;
+}
+
+// Spans are handed out in order around the ring, so the free space is either
+// both ends of the buffer or the gap between the newest and oldest spans.
+bool upload_queue_t::allocate(arch_t length, arch_t& offset) {
+	length = (length + kSpanAlignment - 1) & ~(kSpanAlignment - 1);
+	if (length > capacity) {
+		return false;
+	}
+	if (spans.empty()) {
+		offset = 0;
+	} else {
+		const arch_t head = spans.back().offset + spans.back().length;
+		const arch_t tail = spans.front().offset;
+		if (head > tail) {
+			if (capacity - head >= length) {
+				offset = head;
+			} else if (tail >= length) {
+				offset = 0;
+			} else {
+				return false;
+			}
+		} else if (tail - head >= length) {
+			offset = head;
+		} else {
+			return false;
+		}
+	}
+	spans.push_back({ offset, length, false });
+	return true;
+}
+
+void upload_queue_t::release(arch_t offset) {
+	for (auto&& span : spans) {
+		if (span.offset == offset and !span.released) {
+			span.released = true;
+			break;
+		}
+	}
+	while (!spans.empty() and spans.front().released) {
+		spans.pop_front();
+	}
+}
+
+// Marks the request as being copied, so process() leaves it alone until it's published.
+bool upload_queue_t::claim(upload_request_t& request) {
+	if (!this->allocate(request.length, request.offset)) {
+		return false;
+	}
+	request.copying = true;
+	return true;
+}
+
+// Requests cancelled while their copy was running are gone, so only their span is left to free.
+void upload_queue_t::publish(const upload_request_t& request) {
+	for (auto&& pended : pending) {
+		if (pended.copying and pended.offset == request.offset and pended.texture == request.texture and pended.palette == request.palette) {
+			pended.copying = false;
+			pended.staged = true;
+			return;
+		}
+	}
+	this->release(request.offset);
+}
+
+void upload_queue_t::stage(byte_t* mapping, const upload_request_t& request) {
+	if (request.texture != nullptr) {
+		request.texture->stage(mapping + request.offset);
+	} else if (request.palette != nullptr) {
+		request.palette->stage(mapping + request.offset);
+	}
+}
+
+void upload_queue_t::retire() {
+	while (!fences.empty()) {
+		upload_fence_t& fence = fences.front();
+		GLenum status = GL_WAIT_FAILED;
+		glCheck(status = glClientWaitSync(static_cast<GLsync>(fence.sync), 0, 0));
+		if (status == GL_TIMEOUT_EXPIRED) {
+			break;
+		}
+		glCheck(glDeleteSync(static_cast<GLsync>(fence.sync)));
+		for (auto&& request : fence.requests) {
+			if (request.texture != nullptr) {
+				request.texture->ready = true;
+			} else if (request.palette != nullptr) {
+				request.palette->ready = true;
+			}
+			if (request.staged) {
+				this->release(request.offset);
+			}
+		}
+		fences.pop_front();
+	}
+}
@@ -0,0 +1,82 @@
+#ifndef LEVIATHAN_INCLUDED_VIDEO_UPLOAD_QUEUE_HPP
+#define LEVIATHAN_INCLUDED_VIDEO_UPLOAD_QUEUE_HPP
+
+#include <deque>
+#include <vector>
+
+#include "../types.hpp"
+
+struct setup_file_t;
+struct texture_t;
+struct palette_t;
+
+struct upload_request_t {
+public:
+	upload_request_t(texture_t* texture, palette_t* palette, arch_t length) :
+		texture(texture),
+		palette(palette),
+		offset(0),
+		length(length),
+		staged(false),
+		copying(false) {}
+	upload_request_t(const upload_request_t&) = default;
+	upload_request_t& operator=(const upload_request_t&) = default;
+	upload_request_t(upload_request_t&&) noexcept = default;
+	upload_request_t& operator=(upload_request_t&&) noexcept = default;
+	~upload_request_t() = default;
+public:
+	texture_t* texture;
+	palette_t* palette;
+	arch_t offset, length;
+	bool_t staged, copying;
+};
+
+struct upload_span_t {
+	arch_t offset, length;
+	bool_t released;
+};
+
+struct upload_fence_t {
+	optr_t sync;
+	std::vector<upload_request_t> requests;
+};
+
+// Decoded pixels get copied into a persistently mapped unpack buffer by whichever
+// loader thread decoded them. The context thread then uploads a budgeted amount
+// out of it every frame, and fences tell it when textures are resident and when
+// their space in the buffer can be reused. Textures stay unready until then.
+// Only claiming and publishing spans takes the lock, never the copies themselves.
+struct upload_queue_t : public not_copyable_t {
+public:
+	upload_queue_t();
+	upload_queue_t(upload_queue_t&&) = delete;
+	upload_queue_t& operator=(upload_queue_t&&) = delete;
+	~upload_queue_t();
+public:
+	bool init(const setup_file_t& config);
+	void destroy();
+	void process();
+	static bool submit(texture_t* texture);
+	static bool submit(palette_t* palette);
+	static void cancel(const texture_t* texture);
+	static void cancel(const palette_t* palette);
+	static bool has_persistent_option();
+private:
+	bool push(upload_request_t request);
+	bool allocate(arch_t length, arch_t& offset);
+	void release(arch_t offset);
+	bool claim(upload_request_t& request);
+	void publish(const upload_request_t& request);
+	void retire();
+	static bool submit(upload_request_t request);
+	static void stage(byte_t* mapping, const upload_request_t& request);
+private:
+	std::deque<upload_request_t> pending;
+	std::deque<upload_fence_t> fences;
+	std::deque<upload_span_t> spans;
+	uint_t handle;
+	byte_t* mapping;
+	arch_t capacity, budget;
+};
+
+#endif // LEVIATHAN_INCLUDED_VIDEO_UPLOAD_QUEUE_HPP
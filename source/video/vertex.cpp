@@ -8,7 +8,8 @@
 
 vertex_spec_t::vertex_spec_t() :
 	detail(nullptr),
-	length(0)
+	length(0),
+	instanced(false)
 {
 
 }
@@ -17,6 +18,7 @@ vertex_spec_t::vertex_spec_t(const vertex_spec_t& that) : vertex_spec_t() {
 	if (this != &that) {
 		detail = that.detail;
 		length = that.length;
+		instanced = that.instanced;
 	}
 }
 
@@ -24,6 +26,7 @@ vertex_spec_t::vertex_spec_t(vertex_spec_t&& that) noexcept : vertex_spec_t() {
 	if (this != &that) {
 		std::swap(detail, that.detail);
 		std::swap(length, that.length);
+		std::swap(instanced, that.instanced);
 	}
 }
 
@@ -31,6 +34,7 @@ vertex_spec_t& vertex_spec_t::operator=(const vertex_spec_t& that) {
 	if (this != &that) {
 		detail = that.detail;
 		length = that.length;
+		instanced = that.instanced;
 	}
 	return *this;
 }
@@ -39,6 +43,7 @@ vertex_spec_t& vertex_spec_t::operator=(vertex_spec_t&& that) noexcept {
 	if (this != &that) {
 		std::swap(detail, that.detail);
 		std::swap(length, that.length);
+		std::swap(instanced, that.instanced);
 	}
 	return *this;
 }
@@ -61,6 +66,7 @@ vertex_spec_t vertex_spec_t::from(const uint_t* list) {
 	static const uint_t kMinor[] = { GL_FLOAT_VEC2, 0 };
 	static const uint_t kBlank[] = { GL_FLOAT_VEC2, GL_FLOAT_VEC4, 0 };
 	static const uint_t kMajor[] = { GL_FLOAT_VEC2, GL_FLOAT_VEC3, GL_FLOAT, 0 };
+	static const uint_t kSprite[] = { GL_FLOAT_VEC2, GL_FLOAT_VEC2, GL_FLOAT_VEC4, GL_FLOAT_VEC2, GL_FLOAT_VEC2, GL_FLOAT_VEC3, 0 };
 	vertex_spec_t result;
 	if (vertex_spec_t::compare(list, kMinor)) {
 		result = vertex_spec_t::from(typeid(vtx_minor_t));
@@ -68,6 +74,8 @@ vertex_spec_t vertex_spec_t::from(const uint_t* list) {
 		result = vertex_spec_t::from(typeid(vtx_blank_t));
 	} else if (vertex_spec_t::compare(list, kMajor)) {
 		result = vertex_spec_t::from(typeid(vtx_major_t));
+	} else if (vertex_spec_t::compare(list, kSprite)) {
+		result = vertex_spec_t::from(typeid(vtx_sprite_t));
 	}
 	return result;
 }
@@ -126,6 +134,59 @@ vertex_spec_t vertex_spec_t::from(const std::type_info& info) {
 				(const optr_t)offsetof(vtx_major_t, alpha)
 			));
 		};
+	} else if (info == typeid(vtx_sprite_t)) {
+		result.length = sizeof(vtx_sprite_t);
+		result.instanced = true;
+		result.detail = [] {
+			glCheck(glEnableVertexAttribArray(0));
+			glCheck(glVertexAttribPointer(
+				0, glm::vec2::length(),
+				GL_FLOAT, GL_FALSE,
+				sizeof(vtx_sprite_t),
+				(const optr_t)offsetof(vtx_sprite_t, position)
+			));
+			glCheck(glVertexAttribDivisor(0, 1));
+			glCheck(glEnableVertexAttribArray(1));
+			glCheck(glVertexAttribPointer(
+				1, glm::vec2::length(),
+				GL_FLOAT, GL_FALSE,
+				sizeof(vtx_sprite_t),
+				(const optr_t)offsetof(vtx_sprite_t, dimensions)
+			));
+			glCheck(glVertexAttribDivisor(1, 1));
+			glCheck(glEnableVertexAttribArray(2));
+			glCheck(glVertexAttribPointer(
+				2, glm::vec4::length(),
+				GL_FLOAT, GL_FALSE,
+				sizeof(vtx_sprite_t),
+				(const optr_t)offsetof(vtx_sprite_t, uvcoords)
+			));
+			glCheck(glVertexAttribDivisor(2, 1));
+			glCheck(glEnableVertexAttribArray(3));
+			glCheck(glVertexAttribPointer(
+				3, glm::vec2::length(),
+				GL_FLOAT, GL_FALSE,
+				sizeof(vtx_sprite_t),
+				(const optr_t)offsetof(vtx_sprite_t, scale)
+			));
+			glCheck(glVertexAttribDivisor(3, 1));
+			glCheck(glEnableVertexAttribArray(4));
+			glCheck(glVertexAttribPointer(
+				4, glm::vec2::length(),
+				GL_FLOAT, GL_FALSE,
+				sizeof(vtx_sprite_t),
+				(const optr_t)offsetof(vtx_sprite_t, axis)
+			));
+			glCheck(glVertexAttribDivisor(4, 1));
+			glCheck(glEnableVertexAttribArray(5));
+			glCheck(glVertexAttribPointer(
+				5, glm::vec3::length(),
+				GL_FLOAT, GL_FALSE,
+				sizeof(vtx_sprite_t),
+				(const optr_t)offsetof(vtx_sprite_t, rotation)
+			));
+			glCheck(glVertexAttribDivisor(5, 1));
+		};
 	}
 	if (result.length == 0) {
 		synao_log("Warning! vertex_spec_t result has a length of zero!\n");
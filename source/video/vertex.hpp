@@ -37,10 +37,29 @@ public:
 		alpha(0.0f) {}
 };
 
+// One per sprite instead of one per corner, expanded into a quad by the vertex shader.
+struct vtx_sprite_t : public vertex_t {
+	glm::vec2 position, dimensions;
+	glm::vec4 uvcoords;
+	glm::vec2 scale, axis;
+	real_t rotation, table, alpha;
+public:
+	vtx_sprite_t() :
+		position(0.0f),
+		dimensions(0.0f),
+		uvcoords(0.0f),
+		scale(1.0f),
+		axis(0.0f),
+		rotation(0.0f),
+		table(0.0f),
+		alpha(0.0f) {}
+};
+
 struct vertex_spec_t {
 public:
 	void(*detail)(void);
 	arch_t length;
+	bool_t instanced;
 public:
 	vertex_spec_t();
 	vertex_spec_t(const vertex_spec_t& that);
@@ -0,0 +1,138 @@
+#include "./vertex_stream.hpp"
+#include "./glcheck.hpp"
+
+#include "../utility/frame_stats.hpp"
+#include "../utility/logger.hpp"
+#include "../utility/profiler.hpp"
+#include "../utility/setup_file.hpp"
+
+#include <cstring>
+
+static constexpr arch_t kMegabyte 		= 1 << 20;
+static constexpr arch_t kDefaultStream 	= 6;
+static constexpr uint64_t kWaitPeriod 	= 1000000;
+
+vertex_stream_t::vertex_stream_t() :
+	fences(),
+	handle(0),
+	mapping(nullptr),
+	capacity(0),
+	region(0),
+	head(0)
+{
+	fences.fill(nullptr);
+}
+
+vertex_stream_t::~vertex_stream_t() {
+	this->destroy();
+}
+
+bool vertex_stream_t::init(const setup_file_t& config) {
+	if (handle != 0) {
+		synao_log("Error! Vertex stream already exists!\n");
+		return false;
+	}
+	arch_t megabytes = kDefaultStream;
+	config.get("Memory", "Stream", megabytes);
+	if (!vertex_stream_t::has_persistent_option() or megabytes == 0) {
+		return true;
+	}
+	capacity = (megabytes * kMegabyte) / Regions;
+	const uint_t flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glCheck(glGenBuffers(1, &handle));
+	glCheck(glBindBuffer(GL_ARRAY_BUFFER, handle));
+	glCheck(glBufferStorage(GL_ARRAY_BUFFER, capacity * Regions, nullptr, flags));
+	optr_t pointer = nullptr;
+	glCheck(pointer = glMapBufferRange(GL_ARRAY_BUFFER, 0, capacity * Regions, flags));
+	glCheck(glBindBuffer(GL_ARRAY_BUFFER, 0));
+	mapping = static_cast<byte_t*>(pointer);
+	if (mapping == nullptr) {
+		synao_warn(Video, "Couldn't map vertex stream! Display lists will use their own buffers.\n");
+		glCheck(glDeleteBuffers(1, &handle));
+		handle = 0;
+		capacity = 0;
+	}
+	return true;
+}
+
+void vertex_stream_t::destroy() {
+	for (auto&& fence : fences) {
+		if (fence != nullptr) {
+			glCheck(glDeleteSync(static_cast<GLsync>(fence)));
+			fence = nullptr;
+		}
+	}
+	if (handle != 0) {
+		glCheck(glBindBuffer(GL_ARRAY_BUFFER, handle));
+		glCheck(glUnmapBuffer(GL_ARRAY_BUFFER));
+		glCheck(glBindBuffer(GL_ARRAY_BUFFER, 0));
+		glCheck(glDeleteBuffers(1, &handle));
+		handle = 0;
+	}
+	mapping = nullptr;
+	capacity = 0;
+	region = 0;
+	head = 0;
+}
+
+// The fence was placed Regions frames ago, so this rarely waits at all.
+void vertex_stream_t::begin() {
+	if (mapping == nullptr) {
+		return;
+	}
+	synao_zone("vertex_stream_t::begin");
+	region = (region + 1) % Regions;
+	head = 0;
+	GLsync fence = static_cast<GLsync>(fences[region]);
+	if (fence != nullptr) {
+		GLenum status = GL_WAIT_FAILED;
+		do {
+			glCheck(status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kWaitPeriod));
+		} while (status == GL_TIMEOUT_EXPIRED);
+		glCheck(glDeleteSync(fence));
+		fences[region] = nullptr;
+	}
+}
+
+void vertex_stream_t::end() {
+	if (mapping != nullptr and fences[region] == nullptr) {
+		GLsync fence = nullptr;
+		glCheck(fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+		fences[region] = fence;
+	}
+}
+
+// Slices start on a multiple of the stride, so the base vertex lands exactly on them.
+bool vertex_stream_t::write(const vertex_t* vertices, arch_t count, arch_t stride, sint_t& base) {
+	if (mapping == nullptr or vertices == nullptr or count == 0 or stride == 0) {
+		return false;
+	}
+	const arch_t bytes = count * stride;
+	const arch_t start = region * capacity;
+	const arch_t offset = ((start + head + stride - 1) / stride) * stride;
+	if (offset + bytes > start + capacity) {
+		return false;
+	}
+	std::memcpy(mapping + offset, vertices, bytes);
+	head = offset + bytes - start;
+	base = static_cast<sint_t>(offset / stride);
+	frame_stats::add_stream_bytes(bytes);
+	return true;
+}
+
+void vertex_stream_t::bind(bool_t value) const {
+	if (handle != 0) {
+		glCheck(glBindBuffer(GL_ARRAY_BUFFER, value ? handle : 0));
+	}
+}
+
+bool vertex_stream_t::valid() const {
+	return mapping != nullptr;
+}
+
+bool vertex_stream_t::has_persistent_option() {
+	return
+		glBufferStorage != nullptr and
+		glFenceSync != nullptr and
+		glDrawElementsBaseVertex != nullptr;
+}
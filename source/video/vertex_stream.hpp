@@ -0,0 +1,39 @@
+#ifndef LEVIATHAN_INCLUDED_VIDEO_VERTEX_STREAM_HPP
+#define LEVIATHAN_INCLUDED_VIDEO_VERTEX_STREAM_HPP
+
+#include <array>
+
+#include "../types.hpp"
+
+struct setup_file_t;
+struct vertex_t;
+
+// One persistently mapped vertex buffer split into a region per frame in flight.
+// Display lists copy their vertices straight into the current region when they're
+// flushed, and each region gets fenced once the frame is done with it, so it can
+// only be written again after the GPU has finished reading it.
+struct vertex_stream_t : public not_copyable_t {
+public:
+	vertex_stream_t();
+	vertex_stream_t(vertex_stream_t&&) = delete;
+	vertex_stream_t& operator=(vertex_stream_t&&) = delete;
+	~vertex_stream_t();
+public:
+	bool init(const setup_file_t& config);
+	void destroy();
+	void begin();
+	void end();
+	bool write(const vertex_t* vertices, arch_t count, arch_t stride, sint_t& base);
+	void bind(bool_t value) const;
+	bool valid() const;
+	static bool has_persistent_option();
+public:
+	static constexpr arch_t Regions = 3;
+private:
+	std::array<optr_t, Regions> fences;
+	uint_t handle;
+	byte_t* mapping;
+	arch_t capacity, region, head;
+};
+
+#endif // LEVIATHAN_INCLUDED_VIDEO_VERTEX_STREAM_HPP